@@ -0,0 +1,92 @@
+#ifndef ATOM_SPAN_H
+#define ATOM_SPAN_H
+
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+// Первые четыре момента (определения - как у DiscreteRandomVariable)
+template <typename R>
+struct BasicDistributionMoments {
+    R expectation;
+    R variance;
+    R skewness;
+    R kurtosis; // эксцесс
+};
+
+using DistributionMoments = BasicDistributionMoments<double>;
+
+// Моменты по среднему и центральным суммам m2 = sum(d^2 p), m3, m4
+// (общая часть AtomSpan::moments и пакетных ядер RandomVariableBatch)
+template <typename R>
+BasicDistributionMoments<R> momentsFromCentralSums(R mean, R m2, R m3, R m4) {
+    BasicDistributionMoments<R> result = {mean, m2, 0.0, 0.0};
+    if (m2 > 0) {
+        result.skewness = m3 / (m2 * std::sqrt(m2));
+        result.kurtosis = m4 / (m2 * m2) - 3.0;
+    }
+    return result;
+}
+
+// Тип, в котором считаются статистики: не менее double и не менее точности
+// значений и вероятностей (для long double - long double)
+template <typename V, typename P>
+using StatisticType = typename std::common_type<V, P, double>::type;
+
+// Невладеющее представление массива атомов (значение - вероятность),
+// отсортированного по возрастанию значений. Общие вычислительные ядра
+// для DiscreteRandomVariable и DistributionView. Если владелец хранит префиксные
+// суммы вероятностей, cdf и quantile выполняются двоичным поиском за O(log n),
+// иначе - одним проходом по атомам.
+template <typename V, typename P>
+class BasicAtomSpan {
+public:
+    using value_type = V;
+    using probability_type = P;
+    using real_type = StatisticType<V, P>;
+    using Atom = std::pair<V, P>;
+
+private:
+    const Atom* atoms;
+    std::size_t count;
+    const P* prefix; // префиксные суммы вероятностей или nullptr
+
+public:
+    BasicAtomSpan();
+    BasicAtomSpan(const Atom* data, std::size_t size, const P* cumulative = nullptr);
+    BasicAtomSpan(const std::vector<Atom>& dist);
+
+    // Доступ к атомам
+    const Atom* data() const { return atoms; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Atom* begin() const { return atoms; }
+    const Atom* end() const { return atoms + count; }
+    const Atom& operator[](std::size_t i) const { return atoms[i]; }
+    const P* cumulativeProbabilities() const { return prefix; }
+
+    // Статистические характеристики
+    real_type expectation() const;
+    real_type variance() const;
+    real_type skewness() const;
+    real_type kurtosis() const;
+    real_type standardDeviation() const;
+    BasicDistributionMoments<real_type> moments() const; // все четыре момента за два прохода
+
+    // Функция распределения и квантиль (наименьшее x с F(x) >= p)
+    real_type cdf(real_type x) const;
+    V quantile(real_type p) const;
+    std::vector<std::pair<V, P>> getCDF() const;
+};
+
+using AtomSpan = BasicAtomSpan<double, double>;
+
+// Поэлементное сравнение атомов
+template <typename V, typename P>
+bool operator==(BasicAtomSpan<V, P> a, BasicAtomSpan<V, P> b);
+template <typename V, typename P>
+bool operator!=(BasicAtomSpan<V, P> a, BasicAtomSpan<V, P> b);
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Бинарный формат распределения (все поля little-endian):
+//
+//   0  char[4]  magic        "PTMS"
+//   4  uint16   version      kFormatVersion; сжатые файлы - kCompressedFormatVersion;
+//                            типизированная нагрузка - kTypedFormatVersion
+//   6  uint16   headerSize   размер заголовка в байтах
+//   8  uint32   byteOrder    маркер порядка байт 0x01020304
+//  12  uint32   flags        kFlagCanonical, kFlagCompressed
+//  16  uint64   atomCount    число атомов
+//  24  uint32   crc          CRC-32 полезной нагрузки
+//  28  uint8    valueType    kTypeFloat64 или kTypeInt64 (до версии 3 - всегда 0)
+//  29  uint8    probType     kTypeFloat64 (до версии 3 - всегда 0)
+//  30  uint16   reserved     0
+//  32  payload               atomCount пар {value, probability} указанных типов
+//                            или сжатая нагрузка (см. compressed_format.h)
+struct BinaryHeader {
+    std::uint16_t version;
+    std::uint32_t flags;
+    std::uint64_t atomCount;
+    std::uint32_t crc;
+    std::uint8_t valueType = 0;       // binary_format::kTypeFloat64
+    std::uint8_t probabilityType = 0; // binary_format::kTypeFloat64
+};
+
+namespace binary_format {
+
+const char kMagic[4] = {'P', 'T', 'M', 'S'};
+const std::uint16_t kFormatVersion = 1;
+const std::uint16_t kCompressedFormatVersion = 2;
+const std::uint16_t kTypedFormatVersion = 3;
+const std::size_t kHeaderSize = 32;
+const std::uint32_t kByteOrderMark = 0x01020304u;
+const std::size_t kAtomSize = 2 * sizeof(double);
+
+// Коды типов полей атома
+const std::uint8_t kTypeFloat64 = 0;
+const std::uint8_t kTypeInt64 = 1;
+
+// Атомы упорядочены по возрастанию значений, значения уникальны, вероятности нормированы
+const std::uint32_t kFlagCanonical = 1u << 0;
+// Нагрузка сжата поблочно
+const std::uint32_t kFlagCompressed = 1u << 1;
+
+bool isLittleEndianHost();
+
+// Нагрузка из пар float64 - единственный вид, который читают отображение в память,
+// потоковое чтение и сжатый формат
+bool hasDefaultTypes(const BinaryHeader& header);
+
+// CRC-32 (IEEE 802.3), slicing-by-8; crc - значение для продолжения подсчета
+std::uint32_t crc32(const void* data, std::size_t size, std::uint32_t crc = 0);
+
+// Запись и чтение little-endian целого длиной bytes байт
+void putLE(unsigned char* out, std::uint64_t value, int bytes);
+void appendLE(std::vector<unsigned char>& out, std::uint64_t value, int bytes);
+std::uint64_t getLE(const unsigned char* in, int bytes);
+
+// Число старших и младших нулевых бит; x != 0
+inline int countLeadingZeros(std::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - static_cast<int>(index);
+#else
+    int count = 0;
+    for (std::uint64_t bit = 1ull << 63; !(x & bit); bit >>= 1) ++count;
+    return count;
+#endif
+}
+
+inline int countTrailingZeros(std::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<int>(index);
+#else
+    int count = 0;
+    for (; !(x & 1); x >>= 1) ++count;
+    return count;
+#endif
+}
+
+// Перестановка байт у массива 64-битных слов (для big-endian платформ)
+void byteSwap64(void* data, std::size_t count);
+
+void encodeHeader(const BinaryHeader& header, unsigned char* out);
+// Проверяет magic, версию, маркер порядка байт и коды типов; при ошибке бросает std::runtime_error
+BinaryHeader decodeHeader(const unsigned char* in);
+
+void writeHeader(std::ostream& out, const BinaryHeader& header);
+BinaryHeader readHeader(std::istream& in);
+
+}
+
+#endif
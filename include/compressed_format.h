@@ -0,0 +1,49 @@
+#ifndef COMPRESSED_FORMAT_H
+#define COMPRESSED_FORMAT_H
+
+#include "atom_span.h"
+#include "binary_format.h"
+#include <vector>
+#include <memory_resource>
+#include <istream>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+// Сжатая полезная нагрузка (версия kCompressedFormatVersion, флаг kFlagCompressed):
+//
+//   uint32   blockAtoms           атомов в блоке (последний блок может быть короче)
+//   uint32   blockCount
+//   uint64   blockEnd[blockCount] смещения концов блоков от начала данных блоков
+//   блоки:   uint32 atomCount, uint32 valueBytes, поток значений, поток вероятностей
+//
+// Значения переводятся в упорядоченные 64-битные ключи и кодируются разностями
+// второго порядка (zigzag varint, серии нулей - длиной серии): решетка значений
+// сжимается почти до нуля. Вероятности кодируются XOR с предыдущей (Gorilla).
+// Блоки независимы и декодируются параллельно; CRC в заголовке считается по всей нагрузке.
+namespace compressed_format {
+
+const std::size_t kDefaultBlockAtoms = 1 << 16;
+
+// Кодирование/декодирование одного блока
+void encodeBlock(const std::pair<double, double>* atoms, std::size_t count, std::vector<unsigned char>& out);
+// Возвращает число атомов блока; out должен вмещать blockAtoms атомов
+std::size_t decodeBlock(const unsigned char* data, std::size_t size, std::pair<double, double>* out, std::size_t capacity);
+
+// Оглавление сжатой нагрузки
+struct Directory {
+    std::uint32_t blockAtoms;
+    std::vector<std::uint64_t> blockEnds;
+};
+
+// Читает оглавление, продолжая подсчет crc
+Directory readDirectory(std::istream& in, const BinaryHeader& header, std::uint32_t& crc);
+
+// Полная запись (заголовок + нагрузка) и чтение нагрузки после заголовка
+void write(std::ostream& out, AtomSpan atoms, std::uint32_t flags, std::size_t blockAtoms = kDefaultBlockAtoms);
+std::pmr::vector<std::pair<double, double>> read(std::istream& in, const BinaryHeader& header, std::uint64_t available,
+                                                 std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+}
+
+#endif
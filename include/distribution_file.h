@@ -0,0 +1,11 @@
+#ifndef DISTRIBUTION_FILE_H
+#define DISTRIBUTION_FILE_H
+
+#include "random_variable.h"
+#include <string>
+
+// Чтение распределения из файла по расширению: .csv - text_format::readCSV,
+// остальные - бинарный формат (DiscreteRandomVariable::deserialize)
+DiscreteRandomVariable loadDistributionFile(const std::string& path);
+
+#endif
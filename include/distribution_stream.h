@@ -0,0 +1,86 @@
+#ifndef DISTRIBUTION_STREAM_H
+#define DISTRIBUTION_STREAM_H
+
+#include "atom_span.h"
+#include "binary_format.h"
+#include "compressed_format.h"
+#include "moment_accumulator.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Потоковая обработка распределений, не помещающихся в память.
+// Файл (формат binary_format.h) читается и пишется блоками фиксированного размера,
+// поэтому расход памяти не зависит от числа атомов.
+
+const std::size_t kDefaultChunkAtoms = 1 << 16;
+
+// Последовательное чтение атомов блоками; CRC проверяется по достижении конца файла.
+// Сжатые файлы читаются по одному блоку сжатия
+class DistributionReader {
+private:
+    std::ifstream file;
+    BinaryHeader header;
+    std::vector<std::pair<double, double>> buffer;
+    std::uint64_t remaining;
+    std::uint32_t crc;
+
+    // Только для сжатых файлов
+    compressed_format::Directory directory;
+    std::vector<unsigned char> blockBuffer;
+    std::size_t nextBlock;
+
+    AtomSpan nextCompressed();
+
+public:
+    explicit DistributionReader(const std::string& path, std::size_t chunkAtoms = kDefaultChunkAtoms);
+
+    std::uint64_t size() const { return header.atomCount; }
+    bool isCanonical() const { return (header.flags & binary_format::kFlagCanonical) != 0; }
+
+    // Очередной блок атомов; пустой span - конец файла.
+    // Данные действительны до следующего вызова next() или rewind()
+    AtomSpan next();
+    void rewind();
+};
+
+// Инкрементальная запись в том же формате. Значения должны строго возрастать;
+// заголовок (число атомов, CRC, флаги) дописывается в close()
+class DistributionWriter {
+private:
+    std::ofstream file;
+    std::vector<std::pair<double, double>> buffer;
+    std::size_t chunkAtoms;
+    std::uint64_t count;
+    std::uint32_t crc;
+    double totalProbability;
+    double lastValue;
+    bool closed;
+
+    void flush();
+
+public:
+    explicit DistributionWriter(const std::string& path, std::size_t chunkAtoms = kDefaultChunkAtoms);
+    ~DistributionWriter();
+
+    DistributionWriter(const DistributionWriter&) = delete;
+    DistributionWriter& operator=(const DistributionWriter&) = delete;
+
+    void write(double value, double probability);
+    void write(AtomSpan atoms);
+    void close();
+};
+
+// Потоковые статистики (память - один блок). Файл всегда читается целиком:
+// при несовпадении CRC бросается std::runtime_error
+MomentAccumulator streamMoments(const std::string& path);
+std::vector<double> streamCDF(const std::string& path, const std::vector<double>& points);
+std::vector<double> streamQuantiles(const std::string& path, const std::vector<double>& levels);
+
+// Удаляет атомы с вероятностью меньше minProbability и нормирует остаток;
+// возвращает число оставшихся атомов
+std::uint64_t streamPrune(const std::string& inputPath, const std::string& outputPath, double minProbability);
+
+#endif
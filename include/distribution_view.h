@@ -0,0 +1,63 @@
+#ifndef DISTRIBUTION_VIEW_H
+#define DISTRIBUTION_VIEW_H
+
+#include "atom_span.h"
+#include "random_variable.h"
+#include "mapped_file.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Распределение, отображенное из файла в память только для чтения (mmap).
+// Данные не копируются и не пересортировываются: файл должен быть записан
+// DiscreteRandomVariable::serialize (флаг kFlagCanonical, без сжатия). Все запросы
+// выполняются непосредственно над отображенным массивом атомов. Открытие читает
+// только заголовок; префиксные суммы вероятностей строятся при первом вызове
+// cdf, quantile или getCDF (один проход по файлу и 8 байт на атом), после чего
+// эти запросы читают O(log n) страниц. Моменты и atoms() их не требуют.
+class DistributionView {
+private:
+    struct PrefixIndex;
+
+    MappedFile file;
+    std::uint32_t payloadCrc;
+    AtomSpan span;
+    std::unique_ptr<PrefixIndex> index;
+
+    AtomSpan indexed() const; // span с префиксными суммами
+
+public:
+    explicit DistributionView(const std::string& path);
+
+    DistributionView(const DistributionView&) = delete;
+    DistributionView& operator=(const DistributionView&) = delete;
+    DistributionView(DistributionView&& other) noexcept;
+    DistributionView& operator=(DistributionView&& other) noexcept;
+    ~DistributionView();
+
+    // Доступ к атомам без префиксных сумм (в том числе как входу для DiscreteRandomVariable::sumOf/productOf)
+    AtomSpan atoms() const { return span; }
+    std::size_t size() const { return span.size(); }
+
+    // Статистические характеристики
+    double expectation() const;
+    double variance() const;
+    double skewness() const;
+    double kurtosis() const;
+    double standardDeviation() const;
+
+    // Функция распределения и квантиль
+    double cdf(double x) const;
+    double quantile(double p) const;
+    std::vector<std::pair<double, double>> getCDF() const;
+
+    // Полная проверка контрольной суммы (читает весь файл)
+    bool verify() const;
+
+    // Копия в обычную случайную величину
+    DiscreteRandomVariable toRandomVariable() const;
+};
+
+#endif
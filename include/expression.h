@@ -0,0 +1,86 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include "random_variable.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Язык выражений над независимыми величинами для пакетных заданий:
+//
+//     Z = 2*X + Y*W          # присваивание
+//     report moments(Z), quantile(Z, 0.99)
+//
+// Инструкции разделяются ';' или переводом строки, '#' - комментарий до конца строки.
+// Операции: + - * над величинами и числами, унарный минус, скобки. Каждое вхождение
+// величины в выражение - независимая копия, как у операторов DiscreteRandomVariable
+// (X + X - свертка X с собой, а не 2*X).
+// Запросы report: moments, expectation, variance, stddev, skewness, kurtosis,
+// atoms, cdf(e, x), quantile(e, p).
+namespace expression {
+
+// Результат одного запроса report: запрос в исходном виде и именованные значения
+struct ReportItem {
+    std::string text;
+    std::vector<std::pair<std::string, double>> values;
+};
+
+// Выражения строятся в общий граф с объединением одинаковых подвыражений
+// (X + Y и Y + X - один узел), поэтому каждое считается один раз, а результаты
+// сохраняются между инструкциями и вызовами run(). Скрипт сначала разбирается
+// целиком (ошибки разбора - std::invalid_argument с номером строки и столбца),
+// затем новые узлы вычисляются по уровням: независимые узлы одного уровня
+// и запросы report - параллельно.
+// Один Evaluator не рассчитан на одновременные вызовы из нескольких потоков.
+class Evaluator {
+private:
+    enum class Op {
+        Variable,
+        Point,   // вырожденное распределение в scalar
+        Scale,   // left * scalar
+        Shift,   // left + scalar
+        Sum,
+        Product
+    };
+
+    struct Node {
+        Op op;
+        double scalar;
+        int left;
+        int right;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::shared_ptr<const DiscreteRandomVariable>> results; // по номеру узла
+    std::map<std::tuple<int, double, int, int>, int> index; // для объединения подвыражений
+    std::map<std::string, int> names;
+
+    struct Parser;
+    struct Request;
+
+    int intern(Op op, double scalar, int left, int right);
+    void evaluate(const std::vector<int>& roots);
+    std::shared_ptr<const DiscreteRandomVariable> compute(const Node& node) const;
+
+public:
+    Evaluator();
+
+    // Привязка имени к распределению; прежние выражения с этим именем не меняются
+    void bind(const std::string& name, DiscreteRandomVariable rv);
+
+    // Выполнение скрипта; результаты report в порядке запросов
+    std::vector<ReportItem> run(const std::string& script);
+
+    // Значение переменной (привязанной или присвоенной и уже вычисленной)
+    std::shared_ptr<const DiscreteRandomVariable> variable(const std::string& name) const;
+
+    std::size_t cachedResults() const;
+    void clearCache(); // привязки и присваивания сохраняются, вычисления будут повторены
+};
+
+}
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef FIXED_RANDOM_VARIABLE_H
+#define FIXED_RANDOM_VARIABLE_H
+
+#include <array>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <cstddef>
+#include "atom_span.h"
+#include "random_variable.h"
+
+namespace fixed_detail {
+
+constexpr double absolute(double x) {
+    return x < 0 ? -x : x;
+}
+
+// Квадратный корень методом Ньютона: с начального приближения не меньше корня
+// последовательность монотонно убывает, останавливаемся, когда она перестает убывать
+constexpr double squareRoot(double x) {
+    if (!(x > 0) || x == x + x) {
+        return x; // 0, бесконечность и NaN
+    }
+    double root = x >= 1 ? x : 1.0;
+    for (;;) {
+        double next = 0.5 * (root + x / root);
+        if (next >= root) return root;
+        root = next;
+    }
+}
+
+}
+
+// Распределение с не более чем N атомами, известное на этапе компиляции.
+// Построение, проверка, моменты, линейные преобразования и свертки - constexpr,
+// поэтому для constexpr-объектов все считается компилятором. Определения
+// моментов и порядок суммирования вероятностей - как у DiscreteRandomVariable;
+// ошибки проверки в константном выражении становятся ошибками компиляции.
+template <std::size_t N>
+class FixedDiscreteRandomVariable {
+    static_assert(N > 0, "Distribution cannot be empty");
+
+    template <std::size_t M>
+    friend class FixedDiscreteRandomVariable;
+
+private:
+    std::array<double, N> values{};        // по возрастанию
+    std::array<double, N> probabilities{};
+    std::size_t count = 0;
+
+    constexpr FixedDiscreteRandomVariable() = default;
+
+    // Упорядочивание по значению (вставками) - атомов немного
+    constexpr void sortByValue() {
+        for (std::size_t i = 1; i < count; ++i) {
+            double value = values[i];
+            double probability = probabilities[i];
+            std::size_t j = i;
+            while (j > 0 && values[j - 1] > value) {
+                values[j] = values[j - 1];
+                probabilities[j] = probabilities[j - 1];
+                --j;
+            }
+            values[j] = value;
+            probabilities[j] = probability;
+        }
+    }
+
+    constexpr void validate() {
+        sortByValue();
+        double total = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i > 0 && values[i] == values[i - 1]) {
+                throw std::invalid_argument("All values must be unique");
+            }
+            if (probabilities[i] < 0) {
+                throw std::invalid_argument("Probabilities cannot be negative");
+            }
+            total += probabilities[i];
+        }
+        if (fixed_detail::absolute(total - 1.0) > 1e-10) {
+            for (std::size_t i = 0; i < count; ++i) {
+                probabilities[i] /= total;
+            }
+        }
+    }
+
+    // Вероятности совпадающих значений складываются в порядке появления
+    constexpr void accumulate(double value, double probability) {
+        if (value == 0.0) value = 0.0; // -0.0 и 0.0 - одно значение
+        for (std::size_t i = 0; i < count; ++i) {
+            if (values[i] == value) {
+                probabilities[i] += probability;
+                return;
+            }
+        }
+        values[count] = value;
+        probabilities[count] = probability;
+        ++count;
+    }
+
+    template <std::size_t M, typename Combine>
+    constexpr FixedDiscreteRandomVariable<N * M> combine(const FixedDiscreteRandomVariable<M>& other,
+                                                         Combine op) const {
+        FixedDiscreteRandomVariable<N * M> result;
+        for (std::size_t i = 0; i < count; ++i) {
+            for (std::size_t j = 0; j < other.count; ++j) {
+                result.accumulate(op(values[i], other.values[j]), probabilities[i] * other.probabilities[j]);
+            }
+        }
+        result.sortByValue();
+        return result;
+    }
+
+public:
+    constexpr FixedDiscreteRandomVariable(const std::pair<double, double> (&atoms)[N]) {
+        for (std::size_t i = 0; i < N; ++i) {
+            values[i] = atoms[i].first;
+            probabilities[i] = atoms[i].second;
+        }
+        count = N;
+        validate();
+    }
+
+    // Доступ к атомам (после слияния совпадающих значений их может быть меньше N)
+    static constexpr std::size_t capacity() { return N; }
+    constexpr std::size_t size() const { return count; }
+    constexpr double value(std::size_t i) const { return values[i]; }
+    constexpr double probability(std::size_t i) const { return probabilities[i]; }
+
+    // Линейные преобразования
+    constexpr FixedDiscreteRandomVariable operator*(double scalar) const {
+        FixedDiscreteRandomVariable result;
+        result.count = count;
+        for (std::size_t i = 0; i < count; ++i) {
+            // Отрицательный множитель обращает порядок значений
+            std::size_t k = scalar < 0 ? count - 1 - i : i;
+            result.values[k] = values[i] * scalar;
+            result.probabilities[k] = probabilities[i];
+        }
+        result.validate();
+        return result;
+    }
+
+    constexpr FixedDiscreteRandomVariable operator+(double shift) const {
+        FixedDiscreteRandomVariable result;
+        result.count = count;
+        for (std::size_t i = 0; i < count; ++i) {
+            result.values[i] = values[i] + shift;
+            result.probabilities[i] = probabilities[i];
+        }
+        result.validate();
+        return result;
+    }
+
+    // Сумма и произведение независимых величин: размер результата - N * M
+    template <std::size_t M>
+    constexpr FixedDiscreteRandomVariable<N * M> operator+(const FixedDiscreteRandomVariable<M>& other) const {
+        return combine(other, [](double x, double y) { return x + y; });
+    }
+
+    template <std::size_t M>
+    constexpr FixedDiscreteRandomVariable<N * M> operator*(const FixedDiscreteRandomVariable<M>& other) const {
+        return combine(other, [](double x, double y) { return x * y; });
+    }
+
+    // Статистические характеристики
+    constexpr DistributionMoments moments() const {
+        double mean = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            mean += values[i] * probabilities[i];
+        }
+
+        double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            double d = values[i] - mean;
+            double d2 = d * d;
+            m2 += d2 * probabilities[i];
+            m3 += d2 * d * probabilities[i];
+            m4 += d2 * d2 * probabilities[i];
+        }
+
+        DistributionMoments result = {mean, m2, 0.0, 0.0};
+        if (m2 > 0) {
+            result.skewness = m3 / (m2 * fixed_detail::squareRoot(m2));
+            result.kurtosis = m4 / (m2 * m2) - 3.0;
+        }
+        return result;
+    }
+
+    constexpr double expectation() const { return moments().expectation; }
+    constexpr double variance() const { return moments().variance; }
+    constexpr double skewness() const { return moments().skewness; }
+    constexpr double kurtosis() const { return moments().kurtosis; }
+    constexpr double standardDeviation() const { return fixed_detail::squareRoot(variance()); }
+
+    // Функция распределения и квантиль (наименьшее x с F(x) >= p)
+    constexpr double cdf(double x) const {
+        double cumulative = 0.0;
+        for (std::size_t i = 0; i < count && values[i] <= x; ++i) {
+            cumulative += probabilities[i];
+        }
+        return cumulative < 1.0 ? cumulative : 1.0;
+    }
+
+    constexpr double quantile(double p) const {
+        if (!(p >= 0.0 && p <= 1.0)) {
+            throw std::invalid_argument("Quantile level must be in [0, 1]");
+        }
+        double cumulative = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            cumulative += probabilities[i];
+            if (cumulative >= p) {
+                return values[i];
+            }
+        }
+        return values[count - 1]; // накопленная сумма может не дотянуть до 1
+    }
+
+    // Преобразование в динамическую величину
+    DiscreteRandomVariable toRandomVariable(const DiscreteRandomVariable::allocator_type& alloc = {}) const {
+        std::vector<std::pair<double, double>> dist;
+        dist.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            dist.push_back({values[i], probabilities[i]});
+        }
+        return DiscreteRandomVariable(dist, alloc);
+    }
+};
+
+// FixedDiscreteRandomVariable coin({{0.0, 0.5}, {1.0, 0.5}}) - N выводится из числа атомов
+template <std::size_t N>
+FixedDiscreteRandomVariable(const std::pair<double, double> (&)[N]) -> FixedDiscreteRandomVariable<N>;
+
+#endif
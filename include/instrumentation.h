@@ -0,0 +1,112 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+// Счетчики и гистограммы задержек горячих операций. Включаются при сборке
+// (опция CMake PTMS_ENABLE_INSTRUMENTATION); без нее макрос PTMS_PROBE
+// раскрывается в пустую инструкцию и не вычисляет аргументы.
+// Каждый поток пишет в собственный слот без атомарных read-modify-write;
+// снимок суммирует слоты всех потоков, в том числе завершившихся.
+namespace instrumentation {
+
+enum class Probe {
+    Sum,         // sumOf / operator+: items - пары атомов
+    Product,     // productOf / operator*: items - пары атомов
+    Scale,       // умножение на число: items - атомы
+    Validate,    // проверка и нормировка: items - атомы
+    Moments,     // items - атомы
+    Cdf,         // items - атомы
+    Quantile,    // items - атомы
+    Serialize,   // items - атомы
+    Deserialize, // items - атомы
+    Allocate,    // выделения через memory_resource: items - байты
+    Count
+};
+
+const std::size_t kProbeCount = static_cast<std::size_t>(Probe::Count);
+// Корзина k гистограммы - задержки в [2^(k-1), 2^k) нс, последняя - все большие
+const std::size_t kLatencyBuckets = 40;
+
+struct ProbeStats {
+    std::uint64_t calls;
+    std::uint64_t items;
+    std::uint64_t totalNanoseconds;
+    std::array<std::uint64_t, kLatencyBuckets> latency;
+};
+
+bool enabled();
+const char* probeName(Probe probe);
+
+void record(Probe probe, std::uint64_t items, std::uint64_t nanoseconds);
+
+// Сумма по всем потокам; во время работы других потоков - приблизительная
+std::array<ProbeStats, kProbeCount> snapshot();
+std::string snapshotJSON();
+void reset();
+
+// Замер области видимости; объем работы можно уточнить до выхода из нее
+class ScopedProbe {
+private:
+    Probe probe;
+    std::uint64_t items;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ScopedProbe(Probe probe, std::uint64_t items)
+        : probe(probe), items(items), start(std::chrono::steady_clock::now()) {}
+    void setItems(std::uint64_t count) { items = count; }
+
+    ~ScopedProbe() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        record(probe, items, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    ScopedProbe(const ScopedProbe&) = delete;
+    ScopedProbe& operator=(const ScopedProbe&) = delete;
+};
+
+// Ресурс памяти, который учитывает выделения (Probe::Allocate) и передает их
+// upstream. В сборке с инструментированием им обернут ресурс по умолчанию, поэтому
+// учитываются все выделения величин без явного ресурса: атомы, функция
+// распределения, копии при проверке и временные буферы операторов.
+// Свой ресурс (например, monotonic_buffer_resource) можно обернуть так же.
+class CountingResource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ScopedProbe probe(Probe::Allocate, bytes);
+        return upstream->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        upstream->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+};
+
+}
+
+#ifdef PTMS_ENABLE_INSTRUMENTATION
+#define PTMS_PROBE_CONCAT2(a, b) a##b
+#define PTMS_PROBE_CONCAT(a, b) PTMS_PROBE_CONCAT2(a, b)
+#define PTMS_PROBE(probe, items) \
+    ::instrumentation::ScopedProbe PTMS_PROBE_CONCAT(ptmsProbe, __LINE__)(::instrumentation::Probe::probe, (items))
+// Именованный замер, объем которого известен только в конце (например, при чтении)
+#define PTMS_PROBE_SCOPE(name, probe) ::instrumentation::ScopedProbe name(::instrumentation::Probe::probe, 0)
+#define PTMS_PROBE_ITEMS(name, items) name.setItems(items)
+#else
+#define PTMS_PROBE(probe, items) ((void)0)
+#define PTMS_PROBE_SCOPE(name, probe) ((void)0)
+#define PTMS_PROBE_ITEMS(name, items) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef LANE_MATH_H
+#define LANE_MATH_H
+
+#include <cstdint>
+#include <cstring>
+
+// Элементарные функции для циклов по дорожкам (пакетам точек или атомов).
+// std::exp/std::log/std::cos из libm - вызовы, и без libmvec и -ffast-math цикл
+// с ними не векторизуется; здесь те же функции без ветвлений и вызовов:
+// приведение аргумента, многочлен и сборка порядка в битах. Погрешность 1-2 ulp.
+// Ядра верны только в своем диапазоне и не проверяют аргумент: вызывающий
+// накапливает признак outside() по дорожкам и пересчитывает такие дорожки
+// функциями libm после цикла. Сравнения double с выбором тоже мешают
+// векторизации, поэтому признак считается целыми операциями.
+namespace lane_math {
+
+inline double fromBits(std::uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline std::uint64_t toBits(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+const std::uint64_t kSignBit = std::uint64_t(1) << 63;
+
+// Старший бит - признак !(|a| <= limit), в том числе для NaN
+inline std::uint64_t outside(double a, double limit) {
+    return (toBits(a) & ~kSignBit) + (kSignBit - 1 - toBits(limit));
+}
+
+// Старший бит - a не является положительным нормализованным конечным числом
+// (ноль, денормализованные, отрицательные, бесконечность, NaN)
+inline std::uint64_t notPositiveNormal(double a) {
+    // Знак и порядок: допустимы 1..2046, иначе одна из разностей уходит через ноль
+    std::uint64_t exponent = toBits(a) >> 52;
+    return (exponent - 1) | (2046 - exponent);
+}
+
+// 1.5 * 2^52: прибавление округляет к целому, младшие биты мантиссы - само целое
+const double kRoundShift = 6755399441055744.0;
+
+// e^(hi + lo), |hi| <= kExpLimit: hi = k ln2 + r, |r| <= ln2 / 2, e^r - многочлен
+// Тейлора 13-й степени по схеме Эстрина (короче цепочка зависимостей)
+const double kExpLimit = 708.0;
+
+inline double exp(double hi, double lo = 0.0) {
+    const double kLog2e = 1.44269504088896338700;
+    const double kLn2Hi = 6.93147180369123816490e-01; // k * kLn2Hi точно при |k| < 2^20
+    const double kLn2Lo = 1.90821492927058770002e-10;
+    double shifted = hi * kLog2e + kRoundShift;
+    double k = shifted - kRoundShift;
+    double r = (hi - k * kLn2Hi) - k * kLn2Lo + lo;
+
+    double r2 = r * r;
+    double r4 = r2 * r2;
+    double r8 = r4 * r4;
+    double p01 = 1.0 + r;
+    double p23 = 0.5 + r * (1.0 / 6.0);
+    double p45 = 1.0 / 24.0 + r * (1.0 / 120.0);
+    double p67 = 1.0 / 720.0 + r * (1.0 / 5040.0);
+    double p89 = 1.0 / 40320.0 + r * (1.0 / 362880.0);
+    double p1011 = 1.0 / 3628800.0 + r * (1.0 / 39916800.0);
+    double p1213 = 1.0 / 479001600.0 + r * (1.0 / 6227020800.0);
+    double p03 = p01 + r2 * p23;
+    double p47 = p45 + r2 * p67;
+    double p811 = p89 + r2 * p1011;
+    double p07 = p03 + r4 * p47;
+    double p813 = p811 + r4 * p1213;
+    double poly = p07 + r8 * p813;
+
+    // Младшие 11 бит k + 1023 - поле порядка 2^k
+    return poly * fromBits((toBits(shifted) + 1023) << 52);
+}
+
+// ln x для положительного нормализованного x (см. notPositiveNormal):
+// x = 2^k m, m в [sqrt(2)/2, sqrt(2)), ln m - многочлен fdlibm по s = (m - 1) / (m + 1)
+inline double log(double x) {
+    const double kLn2Hi = 6.93147180369123816490e-01;
+    const double kLn2Lo = 1.90821492927058770002e-10;
+    // Сдвиг на биты sqrt(2)/2 переносит границу мантиссы к sqrt(2)/2
+    const std::uint64_t kOffset = 0x3fe6a09e667f3bcdull;
+    const std::uint64_t kMantissa = (std::uint64_t(1) << 52) - 1;
+    std::uint64_t shiftedBits = toBits(x) - kOffset;
+    // Порядок k + 2048 в 12 битах; в double - через магическое число 2^52
+    std::uint64_t biased = ((shiftedBits >> 52) + 2048) & 0xfff;
+    double k = fromBits(toBits(4503599627370496.0) | biased) - (4503599627370496.0 + 2048.0);
+    double m = fromBits((shiftedBits & kMantissa) + kOffset);
+
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s;
+    double w = z * z;
+    double t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+    double t2 = z * (6.666666666666735130e-01 +
+                     w * (2.857142874366239149e-01 + w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+    double r = t2 + t1;
+    double halfSquare = 0.5 * f * f;
+    return s * (halfSquare + r) + k * kLn2Lo - halfSquare + f + k * kLn2Hi;
+}
+
+// cos и sin при |a| <= kTrigLimit: a = n pi/2 + r, |r| <= pi/4 (pi/2 тремя
+// частями по 33 бита, n * часть точно), многочлены fdlibm, четверть - из битов n
+const double kTrigLimit = 1e5;
+
+inline void sinCos(double a, double& cosine, double& sine) {
+    const double kTwoOverPi = 6.36619772367581382433e-01;
+    const double kPio2First = 1.57079632673412561417e+00;
+    const double kPio2Second = 6.07710050630396597660e-11;
+    const double kPio2Third = 2.02226624871116645580e-21;
+    const double kPio2Tail = 8.47842766036889956997e-32;
+    double shifted = a * kTwoOverPi + kRoundShift;
+    double n = shifted - kRoundShift;
+    double r = (((a - n * kPio2First) - n * kPio2Second) - n * kPio2Third) - n * kPio2Tail;
+
+    double z = r * r;
+    double s = 1.58969099521155010221e-10;
+    s = s * z - 2.50507602534068634195e-08;
+    s = s * z + 2.75573137070700676789e-06;
+    s = s * z - 1.98412698298579493134e-04;
+    s = s * z + 8.33333333332248946124e-03;
+    s = s * z - 1.66666666666666324348e-01;
+    s = r + r * z * s;
+
+    double c = -1.13596475577881948265e-11;
+    c = c * z + 2.08757232129817482790e-09;
+    c = c * z - 2.75573143513906633035e-07;
+    c = c * z + 2.48015872894767294178e-05;
+    c = c * z - 1.38888888888741095749e-03;
+    c = c * z + 4.16666666666666019037e-02;
+    double half = 0.5 * z;
+    double w = 1.0 - half;
+    c = w + (((1.0 - w) - half) + z * z * c);
+
+    // Четверть q: нечетная меняет местами cos и sin, знаки - по таблице поворота
+    std::uint64_t q = toBits(shifted);
+    std::uint64_t swap = 0 - (q & 1);
+    std::uint64_t cosBits = (toBits(c) & ~swap) | (toBits(s) & swap);
+    std::uint64_t sinBits = (toBits(s) & ~swap) | (toBits(c) & swap);
+    cosine = fromBits(cosBits ^ (((q + 1) & 2) << 62));
+    sine = fromBits(sinBits ^ ((q & 2) << 62));
+}
+
+// Произведение a * b в виде суммы hi + lo (разбиение Деккера, без fma)
+inline void exactProduct(double a, double b, double& hi, double& lo) {
+    const double kSplit = 134217729.0; // 2^27 + 1
+    double ca = kSplit * a;
+    double aHigh = ca - (ca - a);
+    double aLow = a - aHigh;
+    double cb = kSplit * b;
+    double bHigh = cb - (cb - b);
+    double bLow = b - bHigh;
+    hi = a * b;
+    lo = ((aHigh * bHigh - hi) + aHigh * bLow + aLow * bHigh) + aLow * bLow;
+}
+
+}
+
+#endif
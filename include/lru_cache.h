@@ -0,0 +1,75 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// Кеш с вытеснением давно не использованных записей. Объем задается в условных
+// единицах стоимости (например, числе атомов): при вставке вытесняются самые
+// старые записи, пока суммарная стоимость больше capacity. Запись дороже всего
+// кеша не сохраняется. Синхронизацию обеспечивает владелец.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class LruCache {
+private:
+    struct Entry {
+        K key;
+        V value;
+        std::size_t cost;
+    };
+
+    std::list<Entry> entries; // от недавних к давним
+    std::unordered_map<K, typename std::list<Entry>::iterator, Hash> positions;
+    std::size_t capacity;
+    std::size_t totalCost = 0;
+
+    void evict(std::size_t limit) {
+        while (totalCost > limit && !entries.empty()) {
+            totalCost -= entries.back().cost;
+            positions.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+
+public:
+    explicit LruCache(std::size_t capacity) : capacity(capacity) {}
+
+    // Поиск с отметкой об использовании; nullptr, если записи нет
+    const V* find(const K& key) {
+        auto it = positions.find(key);
+        if (it == positions.end()) {
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->value;
+    }
+
+    void insert(const K& key, V value, std::size_t cost) {
+        auto it = positions.find(key);
+        if (it != positions.end()) {
+            totalCost -= it->second->cost;
+            entries.erase(it->second);
+            positions.erase(it);
+        }
+        if (cost > capacity) {
+            return;
+        }
+        evict(capacity - cost);
+        entries.push_front({key, std::move(value), cost});
+        positions.emplace(key, entries.begin());
+        totalCost += cost;
+    }
+
+    void clear() {
+        entries.clear();
+        positions.clear();
+        totalCost = 0;
+    }
+
+    std::size_t size() const { return entries.size(); }
+    std::size_t cost() const { return totalCost; }
+};
+
+#endif
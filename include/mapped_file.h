@@ -0,0 +1,29 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+// Файл, отображенный в память только для чтения (mmap / MapViewOfFile)
+class MappedFile {
+private:
+    void* mapping;
+    std::size_t mappingSize;
+
+    void unmap();
+
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const unsigned char* data() const { return static_cast<const unsigned char*>(mapping); }
+    std::size_t size() const { return mappingSize; }
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "random_variable.h"
+#include <vector>
+#include <cstddef>
+
+// Информационные меры и расстояния между распределениями (логарифмы натуральные).
+// Носители обеих величин уже упорядочены, поэтому каждая мера - один проход
+// слиянием за O(n + m); для KS и W1 используются сохраненные функции распределения.
+// Энтропия, KL, JS и TV на участках общей решетки считаются векторизуемыми
+// пакетами; KS и W1 - скалярным слиянием.
+namespace metrics {
+
+// -sum p log p
+double entropy(const DiscreteRandomVariable& rv);
+
+// sum p log(p / q); бесконечность, если p > 0 там, где q = 0
+double klDivergence(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q);
+// Симметричная и конечная (не больше log 2) мера через среднее m = (p + q) / 2
+double jensenShannonDivergence(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q);
+// sup |P(A) - Q(A)| = sum |p - q| / 2
+double totalVariationDistance(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q);
+// sup_x |F(x) - G(x)|
+double kolmogorovSmirnovDistance(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q);
+// Интеграл |F(x) - G(x)| dx
+double wassersteinDistance(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q);
+
+// Расстояния для пакетных запросов
+enum class Metric {
+    TotalVariation,
+    KolmogorovSmirnov,
+    Wasserstein
+};
+
+double distance(Metric metric, const DiscreteRandomVariable& p, const DiscreteRandomVariable& q);
+
+// Матрица расстояний rows.size() x columns.size() по строкам. Считается плитками
+// (пары распределений плитки остаются в кеше), плитки - параллельно.
+std::vector<double> distanceMatrix(Metric metric, const std::vector<DiscreteRandomVariable>& rows,
+                                   const std::vector<DiscreteRandomVariable>& columns);
+// Симметричная матрица N x N: считается только верхний треугольник
+std::vector<double> distanceMatrix(Metric metric, const std::vector<DiscreteRandomVariable>& catalog);
+
+struct Neighbor {
+    std::size_t index;
+    double distance;
+};
+
+// k ближайших элементов каталога для каждого запроса (по возрастанию расстояния,
+// при равенстве - по индексу) без построения матрицы: память O(k) на запрос.
+// Для Wasserstein кандидаты отсекаются по нижней оценке |E[p] - E[q]|.
+std::vector<std::vector<Neighbor>> nearestNeighbors(Metric metric, const std::vector<DiscreteRandomVariable>& queries,
+                                                    const std::vector<DiscreteRandomVariable>& catalog, std::size_t k);
+// Соседи внутри каталога; сам элемент не считается своим соседом
+std::vector<std::vector<Neighbor>> nearestNeighbors(Metric metric, const std::vector<DiscreteRandomVariable>& catalog,
+                                                    std::size_t k);
+
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef MOMENT_ACCUMULATOR_H
+#define MOMENT_ACCUMULATOR_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "atom_span.h"
+
+// Онлайн-накопитель моментов выборки (Welford / Pébay).
+// Выборка не хранится; накопители с разных потоков объединяются через merge().
+// Атомы распределения добавляются как взвешенные наблюдения (вес - вероятность).
+// Определения совпадают с DiscreteRandomVariable: дисперсия делится на суммарный вес,
+// kurtosis() возвращает эксцесс (kurt - 3), при нулевом отклонении асимметрия и эксцесс равны 0.
+class MomentAccumulator {
+private:
+    std::uint64_t n;
+    double weight; // суммарный вес наблюдений
+    double mean;
+    double m2; // суммы центральных степеней отклонений
+    double m3;
+    double m4;
+
+    void addBlock(const double* data, std::size_t count);
+    void addBlock(const std::pair<double, double>* atoms, std::size_t count);
+
+public:
+    MomentAccumulator();
+
+    // Добавление наблюдений
+    void add(double x);
+    void add(const double* data, std::size_t count);
+    void add(const std::vector<double>& data);
+    void add(AtomSpan atoms);
+
+    // Объединение с накопителем другого потока/шарда
+    void merge(const MomentAccumulator& other);
+    void reset();
+
+    // Статистические характеристики выборки
+    std::uint64_t count() const;
+    double totalWeight() const;
+    double expectation() const;
+    double variance() const;
+    double skewness() const;
+    double kurtosis() const;
+    double standardDeviation() const;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef MOMENT_ALGEBRA_H
+#define MOMENT_ALGEBRA_H
+
+#include "atom_span.h"
+#include <vector>
+#include <cstdint>
+
+// Моменты суммы и произведения независимых величин без построения атомов
+// результата: O(n + m) вместо свертки O(n * m).
+// Для суммы складываются кумулянты (k1..k4); для произведения центральные
+// моменты выражаются через центральные моменты и средние сомножителей
+// (без вычитания больших начальных моментов, которое теряет точность).
+// Операнды задаются атомами или уже известными моментами.
+
+DistributionMoments momentsOfSum(AtomSpan a, AtomSpan b);
+DistributionMoments momentsOfSum(const DistributionMoments& a, const DistributionMoments& b);
+DistributionMoments momentsOfSum(const std::vector<AtomSpan>& operands);
+
+// Сумма n независимых копий величины
+DistributionMoments momentsOfSumIid(AtomSpan atoms, std::uint64_t n);
+DistributionMoments momentsOfSumIid(const DistributionMoments& moments, std::uint64_t n);
+
+DistributionMoments momentsOfProduct(AtomSpan a, AtomSpan b);
+DistributionMoments momentsOfProduct(const DistributionMoments& a, const DistributionMoments& b);
+DistributionMoments momentsOfProduct(const std::vector<AtomSpan>& operands);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+// Число потоков, используемых параллельными ядрами; переменная окружения
+// PTMS_THREADS (положительное число) заменяет число процессоров
+unsigned hardwareThreads();
+
+// Делит [0, count) на непрерывные диапазоны не короче minChunk и вызывает
+// body(begin, end) для каждого из них в постоянном пуле потоков (он создается
+// при первом вызове); вызывающий поток тоже разбирает диапазоны, поэтому вызовы
+// можно вкладывать. Малые объемы обрабатываются в вызывающем потоке.
+// Первое исключение пробрасывается вызывающему.
+void parallelFor(std::size_t count, std::size_t minChunk,
+                 const std::function<void(std::size_t begin, std::size_t end)>& body);
+
+#endif
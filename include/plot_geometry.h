@@ -0,0 +1,48 @@
+#ifndef PLOT_GEOMETRY_H
+#define PLOT_GEOMETRY_H
+
+#include "random_variable.h"
+#include <cstddef>
+#include <vector>
+
+// Геометрия трех видов визуализатора в нормированных координатах [0,1] x [0,1]
+// (та же проекция, что задает Visualizer::setupProjection). Не зависит от OpenGL:
+// строится при смене распределения, размера окна или масштаба и затем только рисуется.
+struct PlotVertex {
+    float x;
+    float y;
+};
+
+struct PlotGeometry {
+    std::vector<PlotVertex> stems;  // пары концов вертикальных отрезков закона (GL_LINES)
+    std::vector<PlotVertex> points; // вершины полилайна (GL_POINTS, GL_LINE_STRIP)
+    std::vector<PlotVertex> cdf;    // ступенчатая функция распределения (GL_LINE_STRIP)
+};
+
+// Видимая часть оси значений и ширина области графика в пикселях
+struct PlotViewport {
+    double minValue;
+    double maxValue;
+    std::size_t columns; // 0 - без прореживания
+};
+
+namespace plot_geometry {
+
+// Диапазон значений по оси X с отступом 10% (для вырожденного носителя - ширина 1)
+std::pair<double, double> valueRange(const DiscreteRandomVariable& rv);
+// Диапазон вероятностей по оси Y: [0, 1.1 * max p]
+std::pair<double, double> probabilityRange(const DiscreteRandomVariable& rv);
+
+// Весь носитель, по вершине на атом
+PlotGeometry build(const DiscreteRandomVariable& rv);
+
+// Видимые атомы (поиск границ - двоичный). Если их больше, чем столбцов, носитель
+// сводится к столбцам пикселей: закон - отрезок до max p столбца, полилайн - min и max
+// столбца в порядке следования, функция распределения - ступень на сумму p столбца.
+// Размер геометрии - O(columns) независимо от числа атомов. Ось Y масштабируется
+// по видимым атомам.
+PlotGeometry build(const DiscreteRandomVariable& rv, const PlotViewport& viewport);
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef PLOT_IMAGE_H
+#define PLOT_IMAGE_H
+
+#include "plot_geometry.h"
+#include <ostream>
+#include <vector>
+
+// Изображение RGB, 8 бит на канал, строки сверху вниз
+struct RgbImage {
+    int width;
+    int height;
+    std::vector<unsigned char> pixels; // width * height * 3
+};
+
+// Отрисовка видов визуализатора без окна и OpenGL: PlotGeometry растеризуется
+// на процессоре с теми же цветами, толщиной линий (2) и размером точек (6), что
+// и PlotRenderer. Носитель прореживается до столбцов пикселей, поэтому время
+// кадра определяется размером изображения, а не числом атомов.
+namespace plot_image {
+
+// view: 0 - закон распределения, 1 - полилайн, 2 - функция распределения
+RgbImage render(const PlotGeometry& geometry, int view, int width, int height);
+RgbImage render(const DiscreteRandomVariable& rv, int view, int width, int height);
+
+// Столбцов пикселей в области графика [0.1, 0.9] при проекции [-0.1, 1.1]
+std::size_t plotColumns(int width);
+
+// Двоичный PPM (P6)
+void writePPM(std::ostream& out, const RgbImage& image);
+// PNG без внешних библиотек: фильтр Up по строкам и deflate с фиксированными
+// кодами Хаффмана и повторами на расстоянии 1 - однотонный фон почти не занимает места
+void writePNG(std::ostream& out, const RgbImage& image);
+
+}
+
+#endif
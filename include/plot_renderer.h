@@ -0,0 +1,50 @@
+#ifndef PLOT_RENDERER_H
+#define PLOT_RENDERER_H
+
+#include "plot_geometry.h"
+#include <memory>
+
+// Отрисовка PlotGeometry средствами OpenGL; все методы требуют текущего контекста.
+// Основной путь - по буферу вершин на вид, загружаемому только при смене геометрии,
+// и одному-двум вызовам glDrawArrays. Буферные объекты (OpenGL 1.5) загружаются
+// через переданный загрузчик (glfwGetProcAddress, eglGetProcAddress); без них
+// используются клиентские массивы вершин OpenGL 1.1. Путь glBegin/glEnd оставлен
+// для сравнения в ptms-render-bench.
+class PlotRenderer {
+public:
+    enum class Path {
+        Immediate,
+        VertexArrays
+    };
+
+    using Proc = void (*)();
+    using ProcLoader = Proc (*)(const char*);
+
+private:
+    struct BufferApi;
+
+    PlotGeometry geometry;
+    std::unique_ptr<BufferApi> api; // nullptr - буферные объекты недоступны
+    unsigned int buffers[3];        // закон, полилайн, функция распределения
+
+    void drawImmediate(int view) const;
+    void drawVertexArrays(int view) const;
+
+public:
+    explicit PlotRenderer(ProcLoader loader = nullptr);
+    ~PlotRenderer();
+
+    PlotRenderer(const PlotRenderer&) = delete;
+    PlotRenderer& operator=(const PlotRenderer&) = delete;
+
+    // Забирает геометрию и загружает ее в буферы
+    void setGeometry(PlotGeometry geometry);
+    const PlotGeometry& getGeometry() const { return geometry; }
+
+    // view: 0 - закон распределения, 1 - полилайн, 2 - функция распределения
+    void draw(int view, Path path = Path::VertexArrays) const;
+
+    bool usesBufferObjects() const { return api != nullptr; }
+};
+
+#endif
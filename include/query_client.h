@@ -0,0 +1,50 @@
+#ifndef QUERY_CLIENT_H
+#define QUERY_CLIENT_H
+
+#include "random_variable.h"
+#include "query_protocol.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Клиент демона ptmsd: одно соединение, запросы выполняются последовательно.
+// Ошибка, возвращенная сервером, бросается как std::runtime_error с ее текстом.
+class QueryClient {
+private:
+    int fd;
+
+    query_protocol::MessageWriter request(query_protocol::RequestCode code) const;
+    std::vector<unsigned char> call(const query_protocol::MessageWriter& message);
+
+public:
+    explicit QueryClient(const std::string& socketPath);
+    ~QueryClient();
+
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+    QueryClient(QueryClient&& other) noexcept;
+    QueryClient& operator=(QueryClient&& other) noexcept;
+
+    // Возвращают число атомов сохраненного распределения
+    std::size_t load(const std::string& name, const std::string& path); // путь - на стороне сервера
+    std::size_t put(const std::string& name, const DiscreteRandomVariable& rv);
+    void drop(const std::string& name);
+    DiscreteRandomVariable get(const std::string& name);
+
+    DistributionMoments moments(const std::string& name);
+    std::vector<double> cdf(const std::string& name, const std::vector<double>& points);
+    std::vector<double> quantile(const std::string& name, const std::vector<double>& levels);
+
+    // result = left op right (Sum, Product) или result = left op scalar (Scale, Shift);
+    // cacheHit - результат взят из кеша сервера
+    std::size_t apply(query_protocol::Operation op, const std::string& result, const std::string& left,
+                      const std::string& right, bool* cacheHit = nullptr);
+    std::size_t apply(query_protocol::Operation op, const std::string& result, const std::string& left,
+                      double scalar, bool* cacheHit = nullptr);
+
+    query_protocol::ServerStats stats();
+    std::string instrumentation(); // снимок счетчиков сервера в JSON
+    void shutdown();
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef QUERY_PROTOCOL_H
+#define QUERY_PROTOCOL_H
+
+#include "random_variable.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Двоичный протокол демона ptmsd (см. query_server.h). Сообщение - кадр
+// [u32 длина тела][тело], все числа little-endian. Тело запроса начинается
+// с кода RequestCode, тело ответа - с Status; при ошибке далее идет текст ошибки.
+//
+//   Load      имя, путь к файлу            -> u64 число атомов
+//   Put       имя, атомы                   -> u64 число атомов
+//   Drop      имя                          -> -
+//   Get       имя                          -> атомы
+//   Moments   имя                          -> 4 x f64 (E, D, асимметрия, эксцесс)
+//   Cdf       имя, u32 n, n x f64 точек    -> n x f64
+//   Quantile  имя, u32 n, n x f64 уровней  -> n x f64
+//   Apply     u8 Operation, имя результата, имя левого операнда,
+//             имя правого операнда (Sum, Product) или f64 (Scale, Shift)
+//                                          -> u64 число атомов, u8 1 при попадании в кеш
+//   Stats     -                            -> 4 x u64 (ServerStats)
+//   Shutdown  -                            -> -
+//   Instrumentation -                      -> строка JSON (instrumentation::snapshotJSON)
+//
+// Строка - u32 длина и байты; атомы - u64 число и пары f64 (значение, вероятность).
+namespace query_protocol {
+
+// Предел размера тела кадра
+const std::uint32_t kMaxMessageSize = 1u << 28;
+
+enum class RequestCode : std::uint8_t {
+    Load = 1,
+    Put = 2,
+    Drop = 3,
+    Get = 4,
+    Moments = 5,
+    Cdf = 6,
+    Quantile = 7,
+    Apply = 8,
+    Stats = 9,
+    Shutdown = 10,
+    Instrumentation = 11
+};
+
+enum class Status : std::uint8_t {
+    Ok = 0,
+    Error = 1
+};
+
+enum class Operation : std::uint8_t {
+    Sum = 0,
+    Product = 1,
+    Scale = 2, // левый операнд * число
+    Shift = 3  // левый операнд + число
+};
+
+struct ServerStats {
+    std::uint64_t variables;
+    std::uint64_t cacheEntries;
+    std::uint64_t cacheHits;
+    std::uint64_t cacheMisses;
+};
+
+// Сборка тела сообщения
+class MessageWriter {
+private:
+    std::vector<unsigned char> bytes;
+
+public:
+    void putU8(std::uint8_t value) { bytes.push_back(value); }
+    void putU32(std::uint32_t value);
+    void putU64(std::uint64_t value);
+    void putF64(double value);
+    void putString(const std::string& value);
+    void putAtoms(AtomSpan atoms);
+
+    const std::vector<unsigned char>& data() const { return bytes; }
+};
+
+// Разбор тела сообщения с проверкой границ (std::runtime_error при нехватке данных)
+class MessageReader {
+private:
+    const unsigned char* cursor;
+    const unsigned char* end;
+
+    const unsigned char* take(std::size_t size);
+
+public:
+    MessageReader(const unsigned char* data, std::size_t size) : cursor(data), end(data + size) {}
+
+    std::uint8_t getU8();
+    std::uint32_t getU32();
+    std::uint64_t getU64();
+    double getF64();
+    std::string getString();
+    std::vector<std::pair<double, double>> getAtoms();
+
+    bool atEnd() const { return cursor == end; }
+};
+
+// Обмен кадрами через дескриптор сокета. readFrame возвращает false, если
+// соединение закрыто до начала кадра; прочие сбои - std::runtime_error.
+bool readFrame(int fd, std::vector<unsigned char>& body);
+void writeFrame(int fd, const std::vector<unsigned char>& body);
+
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include "random_variable.h"
+#include "lru_cache.h"
+#include "query_protocol.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Локальный сервер запросов (Unix domain socket, протокол - query_protocol.h).
+// Держит именованные распределения в памяти и отвечает на запросы моментов,
+// функции распределения, квантилей и операций. Результаты операций хранятся
+// в LRU-кеше по идентификаторам операндов: одна и та же операция над теми же
+// распределениями, запрошенная разными клиентами, считается один раз.
+// Поток run() ожидает данные на всех соединениях (poll) и передает полностью
+// принятые кадры пулу из threads потоков, поэтому поток занят только на время
+// запроса, а число простаивающих клиентов не ограничено. Запросы одного
+// соединения выполняются по очереди, ответы приходят в порядке запросов.
+class QueryServer {
+private:
+    // Распределение с уникальным идентификатором содержимого: при новой
+    // привязке имени идентификатор меняется, и старые записи кеша не мешают
+    struct Stored {
+        std::shared_ptr<const DiscreteRandomVariable> rv;
+        std::uint64_t id;
+    };
+
+    struct OperationKey {
+        std::uint8_t op;
+        std::uint64_t left;
+        std::uint64_t right; // идентификатор правого операнда или биты числа
+        bool operator==(const OperationKey& other) const {
+            return op == other.op && left == other.left && right == other.right;
+        }
+    };
+
+    struct OperationKeyHash {
+        std::size_t operator()(const OperationKey& key) const;
+    };
+
+    std::string socketPath;
+    std::string dataDirectory; // корень путей запроса Load; пустой - Load запрещен
+    int listenFd;
+    int wakePipe[2]; // stop() будит цикл приема соединений
+    std::atomic<bool> stopping;
+    std::size_t threadCount;
+
+    std::map<std::string, Stored> variables;
+    mutable std::shared_mutex variablesMutex;
+    std::atomic<std::uint64_t> nextId;
+
+    LruCache<OperationKey, Stored, OperationKeyHash> cache;
+    std::mutex cacheMutex;
+    std::atomic<std::uint64_t> cacheHits;
+    std::atomic<std::uint64_t> cacheMisses;
+
+    // Принятые байты соединения; busy - запрос выполняется в пуле
+    struct Connection {
+        std::vector<unsigned char> input;
+        bool busy = false;
+    };
+
+    struct Job {
+        int fd;
+        std::vector<unsigned char> body;
+    };
+
+    std::map<int, Connection> connections; // только поток run()
+    std::deque<Job> jobs;
+    std::vector<std::pair<int, bool>> finished; // выполненные запросы: соединение, исправно ли оно
+    std::mutex jobsMutex;
+    std::condition_variable jobsReady;
+    std::vector<std::thread> workers;
+
+    Stored lookup(const std::string& name) const;
+    std::uint64_t store(const std::string& name, std::shared_ptr<const DiscreteRandomVariable> rv,
+                        std::uint64_t id = 0);
+    std::pair<Stored, bool> apply(query_protocol::Operation op, const Stored& left, const Stored* right,
+                                  double scalar);
+
+    void workerLoop();
+    // Чтение доступных байтов; false - соединение закрыто или кадр неверен
+    bool receive(int fd, Connection& connection);
+    // Передает пулу первый полностью принятый кадр, если он есть
+    void dispatch(int fd, Connection& connection);
+    void closeConnection(int fd);
+    // Выполняет запрос и пишет ответ; true - запрошена остановка сервера
+    bool handle(query_protocol::MessageReader& request, query_protocol::MessageWriter& response);
+
+public:
+    // cacheAtoms - объем кеша результатов в атомах. Пути запроса Load - относительные
+    // пути внутри dataDirectory (без ".."); пустой dataDirectory запрещает Load.
+    // Сокет доступен только владельцу процесса (0600)
+    QueryServer(const std::string& socketPath, std::size_t threads, std::size_t cacheAtoms,
+                const std::string& dataDirectory = "");
+    ~QueryServer();
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // Привязка распределения до запуска (или из другого потока во время работы)
+    void bind(const std::string& name, DiscreteRandomVariable rv);
+
+    // Прием и обслуживание соединений до stop() или запроса Shutdown
+    void run();
+    // Можно вызывать из обработчика сигнала
+    void stop();
+
+    query_protocol::ServerStats stats();
+};
+
+#endif
@@ -2,52 +2,108 @@
 #define RANDOM_VARIABLE_H
 
 #include <vector>
-#include <map>
+#include <memory_resource>
 #include <string>
 #include <fstream>
 #include <stdexcept>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include "atom_span.h"
+#include "small_vector.h"
+
+// Вся память величины (атомы, функция распределения) и временные буферы
+// операторов берутся из memory_resource, заданного при создании (std::pmr).
+// Результат оператора использует ресурс левого операнда; копия по умолчанию -
+// ресурс по умолчанию, как у контейнеров std::pmr.
+// До kInlineAtoms атомов хранятся внутри объекта и не требуют выделений памяти.
+//
+// V - тип значений (std::int64_t, double, long double), P - тип вероятностей
+// (double, long double); реализации инстанцированы для всех сочетаний. Вероятностей
+// float нет: атом std::pair<V, float> из-за выравнивания занимает столько же, сколько
+// std::pair<V, double>, и экономии памяти не дает.
+// Целые значения складываются и перемножаются точно и сортируются поразрядно.
+// Статистики считаются в real_type - не менее double.
+template <typename V, typename P>
+class BasicDiscreteRandomVariable {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    using value_type = V;
+    using probability_type = P;
+    using real_type = StatisticType<V, P>;
+    using Atom = std::pair<V, P>;
+    using Span = BasicAtomSpan<V, P>;
+    static const std::size_t kInlineAtoms = 16;
 
-class DiscreteRandomVariable {
 private:
-    std::vector<std::pair<double, double>> distribution; // значение - вероятность
-    double totalProbability;
+    using AtomStorage = SmallVector<Atom, kInlineAtoms>;
+
+    AtomStorage distribution; // значение - вероятность, по возрастанию значений
+    SmallVector<P, kInlineAtoms> cumulative; // префиксные суммы вероятностей (функция распределения)
+    real_type totalProbability;
 
     void validateDistribution();
     void normalizeProbabilities();
+    void adoptDistribution(AtomStorage&& dist);
+    // Перевод атомов из файлового представления (значения float64 или int64)
+    template <typename SourceValue, typename SourceProbability>
+    void adoptConverted(const std::pair<SourceValue, SourceProbability>* atoms, std::size_t count);
 
 public:
-    DiscreteRandomVariable();
-    DiscreteRandomVariable(const std::vector<std::pair<double, double>>& dist);
-    
+    BasicDiscreteRandomVariable();
+    explicit BasicDiscreteRandomVariable(const allocator_type& alloc);
+    BasicDiscreteRandomVariable(const std::vector<Atom>& dist, const allocator_type& alloc = {});
+    BasicDiscreteRandomVariable(const BasicDiscreteRandomVariable& other) = default;
+    BasicDiscreteRandomVariable(const BasicDiscreteRandomVariable& other, const allocator_type& alloc);
+    BasicDiscreteRandomVariable(BasicDiscreteRandomVariable&& other) = default;
+    BasicDiscreteRandomVariable(BasicDiscreteRandomVariable&& other, const allocator_type& alloc);
+    BasicDiscreteRandomVariable& operator=(const BasicDiscreteRandomVariable& other) = default;
+    BasicDiscreteRandomVariable& operator=(BasicDiscreteRandomVariable&& other) = default;
+
+    allocator_type get_allocator() const;
+
     // Основные операции
-    void setDistribution(const std::vector<std::pair<double, double>>& dist);
-    const std::vector<std::pair<double, double>>& getDistribution() const;
-    
+    void setDistribution(const std::vector<Atom>& dist);
+    Span getDistribution() const;
+    Span atoms() const;
+    // Функция распределения в атомах: F(x_i), по одному значению на атом
+    const P* cumulativeProbabilities() const { return cumulative.data(); }
+
     // Математические операции
-    DiscreteRandomVariable operator*(double scalar) const;
-    DiscreteRandomVariable operator+(const DiscreteRandomVariable& other) const;
-    DiscreteRandomVariable operator*(const DiscreteRandomVariable& other) const;
-    
+    BasicDiscreteRandomVariable operator*(V scalar) const;
+    BasicDiscreteRandomVariable operator+(const BasicDiscreteRandomVariable& other) const;
+    BasicDiscreteRandomVariable operator*(const BasicDiscreteRandomVariable& other) const;
+
+    // Сумма и произведение независимых величин, заданных произвольными массивами атомов
+    static BasicDiscreteRandomVariable sumOf(Span a, Span b, const allocator_type& alloc = {});
+    static BasicDiscreteRandomVariable productOf(Span a, Span b, const allocator_type& alloc = {});
+
     // Статистические характеристики
-    double expectation() const;
-    double variance() const;
-    double skewness() const;
-    double kurtosis() const;
-    double standardDeviation() const;
-    
-    // Сериализация
+    real_type expectation() const;
+    real_type variance() const;
+    real_type skewness() const;
+    real_type kurtosis() const;
+    real_type standardDeviation() const;
+
+    // Сериализация (версионированный бинарный формат, см. binary_format.h).
+    // Целые значения хранятся как есть, long double - как float64.
     void serialize(std::ofstream& file) const;
+    void serializeCompressed(std::ofstream& file) const; // поблочное сжатие, см. compressed_format.h
     void deserialize(std::ifstream& file);
-    
+
     // Вспомогательные методы для визуализации
-    std::vector<double> getValues() const;
-    std::vector<double> getProbabilities() const;
-    std::vector<std::pair<double, double>> getCDF() const;
-    
+    std::vector<V> getValues() const;
+    std::vector<P> getProbabilities() const;
+    std::vector<Atom> getCDF() const;
+
+    // Функция распределения и квантиль
+    real_type cdf(real_type x) const;
+    V quantile(real_type p) const;
+
     // Информация
     std::string toString() const;
 };
 
-#endif
\ No newline at end of file
+using DiscreteRandomVariable = BasicDiscreteRandomVariable<double, double>;
+
+#endif
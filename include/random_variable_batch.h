@@ -0,0 +1,63 @@
+#ifndef RANDOM_VARIABLE_BATCH_H
+#define RANDOM_VARIABLE_BATCH_H
+
+#include "atom_span.h"
+#include "random_variable.h"
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+// Набор множества небольших распределений в общих массивах (CSR):
+// атомы распределения i занимают [offsets[i], offsets[i + 1]) в массивах
+// values и probabilities. Внутри распределения атомы упорядочены по значению,
+// вероятности нормированы - как у DiscreteRandomVariable.
+// Пакетные статистики (moments, cdf, quantile) считают по 8 распределений сразу:
+// k-е атомы всех распределений группы обрабатываются одной векторной операцией,
+// а каждое распределение суммируется в своем обычном порядке, так что результаты
+// совпадают с DiscreteRandomVariable бит в бит. Группы делятся между потоками
+// (parallelFor). Для этого при первом запросе строится копия атомов, переложенная
+// по группам (объем атомов плюс дополнение коротких распределений); add и clear
+// ее сбрасывают.
+class RandomVariableBatch {
+public:
+    struct LaneLayout;
+
+private:
+    std::vector<double> values;
+    std::vector<double> probabilities;
+    std::vector<std::size_t> offsets;
+    mutable std::shared_ptr<const LaneLayout> layout; // строится laneLayout()
+
+    void validateLast();
+    std::shared_ptr<const LaneLayout> laneLayout() const;
+
+public:
+    RandomVariableBatch();
+
+    void reserve(std::size_t distributions, std::size_t atoms);
+    void clear();
+
+    // Добавление распределения; возвращает его индекс
+    std::size_t add(const DiscreteRandomVariable& rv);
+    std::size_t add(AtomSpan atoms); // с проверкой и нормировкой
+
+    // Доступ
+    std::size_t size() const { return offsets.size() - 1; }
+    std::size_t totalAtoms() const { return values.size(); }
+    std::size_t atomCount(std::size_t i) const { return offsets[i + 1] - offsets[i]; }
+    const double* valuesOf(std::size_t i) const { return values.data() + offsets[i]; }
+    const double* probabilitiesOf(std::size_t i) const { return probabilities.data() + offsets[i]; }
+    DiscreteRandomVariable get(std::size_t i) const;
+
+    // Пакетные статистики (по одному результату на распределение)
+    std::vector<DistributionMoments> moments() const;
+    std::vector<double> cdf(double x) const;
+    std::vector<double> cdf(const std::vector<double>& points) const; // points[i] для распределения i
+    std::vector<double> quantile(double p) const;
+
+    // Попарные суммы независимых величин: результат[i] = this[i] + other[i];
+    // атомы и вероятности (в том числе нормировка) совпадают с operator+
+    RandomVariableBatch pairwiseSum(const RandomVariableBatch& other) const;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "plot_geometry.h"
+#include <cstddef>
+#include <string>
+
+// HTML-отчет по каталогу распределений. Документ собирается по частям: заголовок,
+// независимые разделы (их можно готовить параллельно и сразу выводить по порядку)
+// и окончание, поэтому память не зависит от размера каталога. В разделе - три вида
+// визуализатора встроенным SVG (геометрия прореживается до столбцов пикселей)
+// и статистики, которые визуализатор печатает в drawStatistics.
+namespace report {
+
+// Вид в виде элемента <svg> в пикселях; view: 0 - закон, 1 - полилайн, 2 - функция распределения
+std::string svgPlot(const PlotGeometry& geometry, int view, int width, int height);
+
+std::string htmlHeader(const std::string& title);
+void appendSection(std::string& out, const std::string& name, const DiscreteRandomVariable& rv, int plotWidth,
+                   int plotHeight);
+void appendErrorSection(std::string& out, const std::string& name, const std::string& error);
+std::string htmlFooter(std::size_t entries, std::size_t failures);
+
+}
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <memory_resource>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+
+// Вектор с встроенным буфером на N элементов: пока элементов не больше N,
+// память не выделяется; при росте данные прозрачно переносятся в память
+// из memory_resource. Семантика ресурса - как у std::pmr::vector: копия
+// получает ресурс по умолчанию, присваивание сохраняет ресурс получателя.
+// Предназначен для простых типов (атомы, префиксные суммы).
+template <typename T, std::size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copy_constructible<T>::value && std::is_trivially_destructible<T>::value,
+                  "SmallVector supports only trivially copyable element types");
+
+private:
+    T* ptr;
+    std::size_t count;
+    std::size_t cap;
+    std::pmr::memory_resource* resource;
+    alignas(T) unsigned char inlineStorage[N * sizeof(T)];
+
+    T* inlineData() { return reinterpret_cast<T*>(inlineStorage); }
+    bool isInline() const { return ptr == reinterpret_cast<const T*>(inlineStorage); }
+
+    void release() {
+        if (!isInline()) {
+            resource->deallocate(ptr, cap * sizeof(T), alignof(T));
+        }
+        ptr = inlineData();
+        cap = N;
+    }
+
+    void grow(std::size_t minCapacity) {
+        std::size_t newCapacity = std::max(minCapacity, 2 * cap);
+        T* fresh = static_cast<T*>(resource->allocate(newCapacity * sizeof(T), alignof(T)));
+        std::uninitialized_copy(ptr, ptr + count, fresh);
+        std::size_t keep = count;
+        release();
+        ptr = fresh;
+        cap = newCapacity;
+        count = keep;
+    }
+
+    // Забирает содержимое other; ресурсы должны совпадать
+    void steal(SmallVector& other) {
+        if (other.isInline()) {
+            ptr = inlineData();
+            cap = N;
+            std::uninitialized_copy(other.ptr, other.ptr + other.count, ptr);
+        } else {
+            ptr = other.ptr;
+            cap = other.cap;
+            other.ptr = other.inlineData();
+            other.cap = N;
+        }
+        count = other.count;
+        other.count = 0;
+    }
+
+public:
+    using value_type = T;
+    using allocator_type = std::pmr::polymorphic_allocator<T>;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    explicit SmallVector(const allocator_type& alloc = {})
+        : ptr(inlineData()), count(0), cap(N), resource(alloc.resource()) {}
+
+    SmallVector(const SmallVector& other) : SmallVector(other, allocator_type()) {}
+
+    SmallVector(const SmallVector& other, const allocator_type& alloc) : SmallVector(alloc) {
+        assign(other.begin(), other.end());
+    }
+
+    SmallVector(SmallVector&& other) noexcept : SmallVector(allocator_type(other.resource)) {
+        steal(other);
+    }
+
+    SmallVector(SmallVector&& other, const allocator_type& alloc) : SmallVector(alloc) {
+        if (*resource == *other.resource) {
+            steal(other);
+        } else {
+            assign(other.begin(), other.end());
+        }
+    }
+
+    ~SmallVector() {
+        release();
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) {
+        if (this != &other) {
+            if (*resource == *other.resource) {
+                release();
+                steal(other);
+            } else {
+                assign(other.begin(), other.end());
+            }
+        }
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return allocator_type(resource); }
+
+    // Доступ
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return cap; }
+    bool empty() const { return count == 0; }
+    bool isInlineStorage() const { return isInline(); }
+    T* begin() { return ptr; }
+    T* end() { return ptr + count; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+    T& operator[](std::size_t i) { return ptr[i]; }
+    const T& operator[](std::size_t i) const { return ptr[i]; }
+    T& back() { return ptr[count - 1]; }
+    const T& back() const { return ptr[count - 1]; }
+
+    // Изменение
+    void reserve(std::size_t n) {
+        if (n > cap) grow(n);
+    }
+
+    void resize(std::size_t n) {
+        resize(n, T());
+    }
+
+    void resize(std::size_t n, const T& value) {
+        reserve(n);
+        if (n > count) {
+            std::uninitialized_fill(ptr + count, ptr + n, value);
+        }
+        count = n;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    void push_back(const T& value) {
+        if (count == cap) {
+            T copy = value; // value может ссылаться на собственный элемент
+            grow(count + 1);
+            ptr[count++] = copy;
+            return;
+        }
+        ::new (static_cast<void*>(ptr + count)) T(value);
+        ++count;
+    }
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+        count = 0;
+        reserve(n);
+        std::uninitialized_copy(first, last, ptr);
+        count = n;
+    }
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef TEXT_FORMAT_H
+#define TEXT_FORMAT_H
+
+#include "atom_span.h"
+#include "random_variable.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Текстовый (CSV) формат распределения: строка "значение,вероятность".
+// Пустые строки и строки, начинающиеся с '#', пропускаются; первая строка
+// может быть заголовком. Числа разбираются std::from_chars и выводятся
+// std::to_chars в кратчайшем точном виде, поэтому запись и чтение обратимы.
+namespace text_format {
+
+// Разбор буфера; большие буферы делятся по строкам и разбираются параллельно
+std::vector<std::pair<double, double>> parseCSV(const char* data, std::size_t size, char delimiter = ',');
+// Чтение файла через отображение в память
+DiscreteRandomVariable readCSV(const std::string& path, char delimiter = ',');
+
+// Форматирование
+void appendNumber(std::string& out, double value); // кратчайший точный вид
+void appendCSV(std::string& out, AtomSpan atoms, char delimiter = ',');
+std::string formatCSV(AtomSpan atoms, char delimiter = ',');
+void writeCSV(const std::string& path, AtomSpan atoms, char delimiter = ',');
+
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <cstdint>
+#include <string>
+
+// Трассировка в формате Chrome trace_event (chrome://tracing, Perfetto).
+// Области, отмеченные PTMS_TRACE, записываются как полные события ("ph":"X").
+// Поток пишет события в собственный кольцевой буфер без блокировок; фоновый
+// поток периодически забирает их и дописывает в файл. При переполнении буфера
+// события отбрасываются и учитываются в счетчике. Без вызова start() область
+// стоит одной атомарной загрузки; при сборке без PTMS_ENABLE_TRACING макрос пуст.
+namespace tracing {
+
+// Начало записи в файл; повторный вызов без stop() - ошибка
+void start(const std::string& path);
+// Сброс оставшихся событий и закрытие файла; при выходе из программы без stop()
+// запись завершается автоматически
+void stop();
+bool active();
+// Число событий, потерянных из-за переполнения буферов в текущей записи
+std::uint64_t droppedEvents();
+
+// Имя и категория должны жить до stop() (обычно - строковые литералы)
+class Scope {
+private:
+    const char* name;
+    const char* category;
+    std::uint64_t start;
+
+public:
+    Scope(const char* name, const char* category);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+}
+
+#ifdef PTMS_ENABLE_TRACING
+#define PTMS_TRACE_CONCAT2(a, b) a##b
+#define PTMS_TRACE_CONCAT(a, b) PTMS_TRACE_CONCAT2(a, b)
+#define PTMS_TRACE(name, category) ::tracing::Scope PTMS_TRACE_CONCAT(ptmsTrace, __LINE__)(name, category)
+#else
+#define PTMS_TRACE(name, category) ((void)0)
+#endif
+
+#endif
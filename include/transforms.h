@@ -0,0 +1,33 @@
+#ifndef TRANSFORMS_H
+#define TRANSFORMS_H
+
+#include "atom_span.h"
+#include <complex>
+#include <vector>
+
+// Производящие функции распределения, вычисляемые сразу во множестве точек:
+//   pgf(z)  = E[z^X]          (для нецелых значений - только z > 0)
+//   mgf(t)  = E[e^{tX}]
+//   cf(t)   = E[e^{itX}]
+// Точки и атомы обходятся блоками, чтобы блок атомов оставался в кеше,
+// большие сетки считаются параллельно. Порядок суммирования по атомам
+// фиксирован, поэтому результат не зависит от числа потоков.
+// Точки считаются пакетами по 8 векторизуемыми ядрами exp и sin/cos
+// (погрешность слагаемого 1-2 ulp, не побитово равна libm).
+// Производные порядка order (order = 0 - сама функция) дают моменты:
+// pgfDerivative(.., {1}, k) - факториальные, mgfDerivative(.., {0}, k) - начальные.
+namespace transforms {
+
+std::vector<double> pgf(AtomSpan atoms, const std::vector<double>& points);
+std::vector<double> pgfDerivative(AtomSpan atoms, const std::vector<double>& points, unsigned order);
+
+std::vector<double> mgf(AtomSpan atoms, const std::vector<double>& points);
+std::vector<double> mgfDerivative(AtomSpan atoms, const std::vector<double>& points, unsigned order);
+
+std::vector<std::complex<double>> characteristicFunction(AtomSpan atoms, const std::vector<double>& points);
+std::vector<std::complex<double>> characteristicFunctionDerivative(AtomSpan atoms, const std::vector<double>& points,
+                                                                   unsigned order);
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef VALUE_ACCUMULATOR_H
+#define VALUE_ACCUMULATOR_H
+
+#include <memory_resource>
+#include "small_vector.h"
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Суммирование вероятностей по совпадающим значениям (ядро операторов + и *):
+// хеш-таблица с открытой адресацией, затем сортировка только уникальных значений.
+// Вероятности складываются в порядке поступления, поэтому результат не зависит
+// от способа хранения. Таблица заводится под оценку числа значений и удваивается
+// при заполнении наполовину, поэтому память пропорциональна числу различных
+// значений, а не числу пар атомов. Небольшие таблицы (до kInlineKeys значений)
+// целиком лежат внутри объекта; большие берут память из заданного memory_resource,
+// она переиспользуется между вызовами reset().
+// K - тип значения (целый или с плавающей точкой), S - тип накапливаемой суммы.
+template <typename K, typename S>
+class BasicValueAccumulator {
+public:
+    static const std::size_t kInlineKeys = 32;
+
+private:
+    SmallVector<K, kInlineKeys> keys;
+    SmallVector<S, kInlineKeys> sums;
+    SmallVector<std::uint32_t, kInlineKeys> used;      // занятые ячейки - для быстрой очистки
+    SmallVector<std::uint32_t, 2 * kInlineKeys> slots; // индекс в keys + 1, 0 - пусто
+    SmallVector<std::uint32_t, kInlineKeys> order;
+    int shift;
+
+    // Целые ключи хешируются как есть; у вещественных берутся биты double
+    // (равные long double дают равные double)
+    static std::uint64_t keyBits(K value) {
+        if constexpr (std::is_integral<K>::value) {
+            return static_cast<std::uint64_t>(value);
+        } else {
+            double rounded = static_cast<double>(value);
+            std::uint64_t bits;
+            std::memcpy(&bits, &rounded, sizeof(bits));
+            return bits;
+        }
+    }
+
+    void radixSortOrder();
+    // Удвоение таблицы с перераскладкой уже накопленных значений
+    void grow();
+
+    std::size_t emptySlot(K value) const {
+        std::size_t mask = slots.size() - 1;
+        std::size_t slot = static_cast<std::size_t>((keyBits(value) * 0x9E3779B97F4A7C15ull) >> shift);
+        while (slots[slot] != 0) slot = (slot + 1) & mask;
+        return slot;
+    }
+
+public:
+    explicit BasicValueAccumulator(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Подготовка к приему значений; expected - оценка их числа (таблица растет сама)
+    void reset(std::size_t expected);
+
+    void add(K value, S probability) {
+        if (value == K(0)) value = K(0); // -0.0 и 0.0 - одно значение
+        // Старшие биты произведения: у "круглых" double младшие биты мантиссы нулевые
+        std::size_t mask = slots.size() - 1;
+        std::size_t slot = static_cast<std::size_t>((keyBits(value) * 0x9E3779B97F4A7C15ull) >> shift);
+        while (slots[slot] != 0) {
+            std::uint32_t index = slots[slot] - 1;
+            if (keys[index] == value) {
+                sums[index] += probability;
+                return;
+            }
+            slot = (slot + 1) & mask;
+        }
+        if (2 * (keys.size() + 1) > slots.size()) {
+            grow();
+            slot = emptySlot(value);
+        }
+        keys.push_back(value);
+        sums.push_back(probability);
+        used.push_back(static_cast<std::uint32_t>(slot));
+        slots[slot] = static_cast<std::uint32_t>(keys.size());
+    }
+
+    // Упорядочивает накопленные значения; далее доступ по индексу в порядке возрастания.
+    // Целые ключи сортируются поразрядно.
+    void sortByValue();
+    std::size_t size() const { return keys.size(); }
+    K value(std::size_t k) const { return keys[order[k]]; }
+    S probability(std::size_t k) const { return sums[order[k]]; }
+};
+
+using ValueAccumulator = BasicValueAccumulator<double, double>;
+
+#endif
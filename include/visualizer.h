@@ -2,7 +2,10 @@
 #define VISUALIZER_H
 
 #include "random_variable.h"
+#include "plot_geometry.h"
+#include "plot_renderer.h"
 #include <GLFW/glfw3.h>
+#include <memory>
 #include <string>
 
 class Visualizer {
@@ -10,19 +13,28 @@ private:
     GLFWwindow* window;
     DiscreteRandomVariable rv;
     int currentView; // 0 - закон распределения, 1 - полилайн, 2 - функция распределения
+
+    // Моменты считаются при смене распределения, геометрия - еще и при изменении
+    // размера окна или масштаба; кадр рисуется только при изменении данных, вида или окна
+    DistributionMoments moments;
+    std::unique_ptr<PlotRenderer> renderer; // владеет геометрией и буферами вершин
+    std::pair<double, double> fullRange;    // весь носитель с отступами
+    std::pair<double, double> visibleRange; // видимая часть оси значений
+    bool dataDirty;
+    bool layoutDirty;
+    bool frameDirty;
+    bool statisticsDirty;
     
     // Методы отрисовки
-    void drawDistributionLaw();
-    void drawPolyline();
-    void drawCDF();
     void drawAxes();
     void drawText(const std::string& text, double x, double y);
     void drawStatistics();
     
     // Вспомогательные методы
     void setupProjection();
-    std::pair<double, double> getValueRange() const;
-    std::pair<double, double> getProbabilityRange() const;
+    void drawFrame();
+    void requestRedraw();
+    void zoom(double cursorX, double factor);
 
 public:
     Visualizer();
@@ -38,6 +50,8 @@ public:
     // Callback functions
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
     static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+    static void windowRefreshCallback(GLFWwindow* window);
+    static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "../include/atom_span.h"
+#include "../include/instrumentation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+template <typename V, typename P>
+BasicAtomSpan<V, P>::BasicAtomSpan() : atoms(nullptr), count(0), prefix(nullptr) {}
+
+template <typename V, typename P>
+BasicAtomSpan<V, P>::BasicAtomSpan(const Atom* data, std::size_t size, const P* cumulative)
+    : atoms(data), count(size), prefix(cumulative) {}
+
+template <typename V, typename P>
+BasicAtomSpan<V, P>::BasicAtomSpan(const std::vector<Atom>& dist)
+    : atoms(dist.data()), count(dist.size()), prefix(nullptr) {}
+
+template <typename V, typename P>
+typename BasicAtomSpan<V, P>::real_type BasicAtomSpan<V, P>::expectation() const {
+    real_type mean = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        mean += static_cast<real_type>(atoms[i].first) * atoms[i].second;
+    }
+    return mean;
+}
+
+template <typename V, typename P>
+typename BasicAtomSpan<V, P>::real_type BasicAtomSpan<V, P>::variance() const {
+    real_type mean = expectation();
+    real_type var = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        real_type d = atoms[i].first - mean;
+        var += d * d * atoms[i].second;
+    }
+    return var;
+}
+
+template <typename V, typename P>
+typename BasicAtomSpan<V, P>::real_type BasicAtomSpan<V, P>::standardDeviation() const {
+    return std::sqrt(variance());
+}
+
+template <typename V, typename P>
+typename BasicAtomSpan<V, P>::real_type BasicAtomSpan<V, P>::skewness() const {
+    real_type mean = expectation();
+    real_type stdDev = standardDeviation();
+    if (stdDev == 0) return 0.0;
+
+    real_type skew = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        real_type z = (atoms[i].first - mean) / stdDev;
+        skew += z * z * z * atoms[i].second;
+    }
+    return skew;
+}
+
+template <typename V, typename P>
+typename BasicAtomSpan<V, P>::real_type BasicAtomSpan<V, P>::kurtosis() const {
+    real_type mean = expectation();
+    real_type stdDev = standardDeviation();
+    if (stdDev == 0) return 0.0;
+
+    real_type kurt = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        real_type z = (atoms[i].first - mean) / stdDev;
+        real_type z2 = z * z;
+        kurt += z2 * z2 * atoms[i].second;
+    }
+    return kurt - 3.0; // Excess kurtosis
+}
+
+template <typename V, typename P>
+BasicDistributionMoments<typename BasicAtomSpan<V, P>::real_type> BasicAtomSpan<V, P>::moments() const {
+    PTMS_PROBE(Moments, count);
+    real_type mean = expectation();
+    real_type m2 = 0.0, m3 = 0.0, m4 = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        real_type d = atoms[i].first - mean;
+        real_type d2 = d * d;
+        real_type p = atoms[i].second;
+        m2 += d2 * p;
+        m3 += d2 * d * p;
+        m4 += d2 * d2 * p;
+    }
+    return momentsFromCentralSums(mean, m2, m3, m4);
+}
+
+template <typename V, typename P>
+typename BasicAtomSpan<V, P>::real_type BasicAtomSpan<V, P>::cdf(real_type x) const {
+    const Atom* last = std::upper_bound(begin(), end(), x,
+        [](real_type value, const Atom& atom) { return value < atom.first; });
+    if (last == begin()) return 0.0;
+    if (prefix) {
+        return std::min<real_type>(prefix[last - begin() - 1], 1.0);
+    }
+
+    real_type cumulative = 0.0;
+    for (const Atom* it = begin(); it != last; ++it) {
+        cumulative += it->second;
+    }
+    return std::min<real_type>(cumulative, 1.0);
+}
+
+template <typename V, typename P>
+V BasicAtomSpan<V, P>::quantile(real_type p) const {
+    if (count == 0) {
+        throw std::invalid_argument("Distribution cannot be empty");
+    }
+    if (!(p >= 0.0 && p <= 1.0)) {
+        throw std::invalid_argument("Quantile level must be in [0, 1]");
+    }
+    if (prefix) {
+        const P* it = std::lower_bound(prefix, prefix + count, p);
+        // Накопленная сумма может не дотянуть до 1 из-за округления
+        return it == prefix + count ? atoms[count - 1].first : atoms[it - prefix].first;
+    }
+
+    real_type cumulative = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        cumulative += atoms[i].second;
+        if (cumulative >= p) {
+            return atoms[i].first;
+        }
+    }
+    // Накопленная сумма может не дотянуть до 1 из-за округления
+    return atoms[count - 1].first;
+}
+
+template <typename V, typename P>
+std::vector<std::pair<V, P>> BasicAtomSpan<V, P>::getCDF() const {
+    std::vector<std::pair<V, P>> cdf;
+    cdf.reserve(count);
+    if (prefix) {
+        for (std::size_t i = 0; i < count; ++i) {
+            cdf.push_back({atoms[i].first, prefix[i]});
+        }
+        return cdf;
+    }
+
+    P cumulative = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        cumulative += atoms[i].second;
+        cdf.push_back({atoms[i].first, cumulative});
+    }
+    return cdf;
+}
+
+template <typename V, typename P>
+bool operator==(BasicAtomSpan<V, P> a, BasicAtomSpan<V, P> b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template <typename V, typename P>
+bool operator!=(BasicAtomSpan<V, P> a, BasicAtomSpan<V, P> b) {
+    return !(a == b);
+}
+
+// Поддерживаемые типы значений и вероятностей
+#define PTMS_INSTANTIATE_ATOM_SPAN(V, P) \
+    template class BasicAtomSpan<V, P>; \
+    template bool operator==(BasicAtomSpan<V, P>, BasicAtomSpan<V, P>); \
+    template bool operator!=(BasicAtomSpan<V, P>, BasicAtomSpan<V, P>);
+
+PTMS_INSTANTIATE_ATOM_SPAN(std::int64_t, double)
+PTMS_INSTANTIATE_ATOM_SPAN(std::int64_t, long double)
+PTMS_INSTANTIATE_ATOM_SPAN(double, double)
+PTMS_INSTANTIATE_ATOM_SPAN(double, long double)
+PTMS_INSTANTIATE_ATOM_SPAN(long double, double)
+PTMS_INSTANTIATE_ATOM_SPAN(long double, long double)
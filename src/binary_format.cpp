@@ -0,0 +1,162 @@
+#include "../include/binary_format.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Таблицы для CRC-32 slicing-by-8 (полином 0xEDB88320)
+struct Crc32Tables {
+    std::uint32_t table[8][256];
+
+    Crc32Tables() {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            table[0][i] = c;
+        }
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            for (int t = 1; t < 8; ++t) {
+                table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc32Tables& crcTables() {
+    static const Crc32Tables tables;
+    return tables;
+}
+
+}
+
+namespace binary_format {
+
+void putLE(unsigned char* out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+void appendLE(std::vector<unsigned char>& out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+std::uint64_t getLE(const unsigned char* in, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+bool isLittleEndianHost() {
+    const std::uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+std::uint32_t crc32(const void* data, std::size_t size, std::uint32_t crc) {
+    const auto& t = crcTables().table;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+
+    while (size >= 8) {
+        std::uint32_t lo = static_cast<std::uint32_t>(getLE(p, 4)) ^ crc;
+        std::uint32_t hi = static_cast<std::uint32_t>(getLE(p + 4, 4));
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size--) {
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void byteSwap64(void* data, std::size_t count) {
+    unsigned char* p = static_cast<unsigned char*>(data);
+    for (std::size_t i = 0; i < count; ++i, p += 8) {
+        for (int k = 0; k < 4; ++k) {
+            unsigned char tmp = p[k];
+            p[k] = p[7 - k];
+            p[7 - k] = tmp;
+        }
+    }
+}
+
+bool hasDefaultTypes(const BinaryHeader& header) {
+    return header.valueType == kTypeFloat64 && header.probabilityType == kTypeFloat64;
+}
+
+void encodeHeader(const BinaryHeader& header, unsigned char* out) {
+    std::memset(out, 0, kHeaderSize);
+    std::memcpy(out, kMagic, 4);
+    putLE(out + 4, header.version, 2);
+    putLE(out + 6, kHeaderSize, 2);
+    putLE(out + 8, kByteOrderMark, 4);
+    putLE(out + 12, header.flags, 4);
+    putLE(out + 16, header.atomCount, 8);
+    putLE(out + 24, header.crc, 4);
+    out[28] = header.valueType;
+    out[29] = header.probabilityType;
+}
+
+BinaryHeader decodeHeader(const unsigned char* in) {
+    if (std::memcmp(in, kMagic, 4) != 0) {
+        throw std::runtime_error("Not a PTMS distribution file");
+    }
+    if (getLE(in + 8, 4) != kByteOrderMark) {
+        throw std::runtime_error("Corrupted byte order marker");
+    }
+
+    BinaryHeader header;
+    header.version = static_cast<std::uint16_t>(getLE(in + 4, 2));
+    if (header.version == 0 || header.version > kTypedFormatVersion) {
+        throw std::runtime_error("Unsupported format version " + std::to_string(header.version));
+    }
+    if (getLE(in + 6, 2) != kHeaderSize) {
+        throw std::runtime_error("Unexpected header size");
+    }
+    header.flags = static_cast<std::uint32_t>(getLE(in + 12, 4));
+    if ((header.flags & kFlagCompressed) && header.version < kCompressedFormatVersion) {
+        throw std::runtime_error("Compressed payload requires format version " + std::to_string(kCompressedFormatVersion));
+    }
+    header.atomCount = getLE(in + 16, 8);
+    header.crc = static_cast<std::uint32_t>(getLE(in + 24, 4));
+    header.valueType = in[28];
+    header.probabilityType = in[29];
+    if (header.version < kTypedFormatVersion && !hasDefaultTypes(header)) {
+        throw std::runtime_error("Typed payload requires format version " + std::to_string(kTypedFormatVersion));
+    }
+    if ((header.valueType != kTypeFloat64 && header.valueType != kTypeInt64) ||
+        header.probabilityType != kTypeFloat64) {
+        throw std::runtime_error("Unsupported atom field types");
+    }
+    if ((header.flags & kFlagCompressed) && !hasDefaultTypes(header)) {
+        throw std::runtime_error("Compressed payload must hold float64 atoms");
+    }
+    return header;
+}
+
+void writeHeader(std::ostream& out, const BinaryHeader& header) {
+    unsigned char buffer[kHeaderSize];
+    encodeHeader(header, buffer);
+    out.write(reinterpret_cast<const char*>(buffer), kHeaderSize);
+}
+
+BinaryHeader readHeader(std::istream& in) {
+    unsigned char buffer[kHeaderSize];
+    if (!in.read(reinterpret_cast<char*>(buffer), kHeaderSize)) {
+        throw std::runtime_error("Unexpected end of file while reading header");
+    }
+    return decodeHeader(buffer);
+}
+
+}
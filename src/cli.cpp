@@ -0,0 +1,749 @@
+#include "../include/random_variable.h"
+#include "../include/text_format.h"
+#include "../include/parallel.h"
+#include "../include/expression.h"
+#include "../include/distribution_file.h"
+#include "../include/instrumentation.h"
+#include "../include/tracing.h"
+#include "../include/plot_image.h"
+#include "../include/report.h"
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ptms-cli: пакетная обработка распределений без окна и OpenGL.
+// stats: входы читаются и обрабатываются параллельно окнами по kWindow файлов,
+// результаты выводятся в порядке входов по мере готовности окна.
+// eval: скрипт на языке выражений (см. expression.h) над файлами, привязанными к именам.
+// render: вид визуализатора в PNG или PPM без окна (см. plot_image.h).
+// report: HTML-отчет по каталогу (см. report.h); разделы готовятся параллельно
+// окнами по kReportWindow файлов и выводятся по порядку, память не растет с каталогом.
+
+namespace {
+
+// Файлов в одном окне параллельной обработки
+const std::size_t kWindow = 1024;
+// Раздел отчета - десятки килобайт SVG, поэтому окно меньше
+const std::size_t kReportWindow = 256;
+const std::size_t kMinFilesPerThread = 8;
+
+enum class OutputFormat {
+    Csv,
+    Json,
+    Text,
+    Png,
+    Ppm
+};
+
+struct StatsOptions {
+    OutputFormat format = OutputFormat::Csv;
+    std::vector<double> cdfPoints;
+    std::vector<double> quantileLevels;
+    std::string outputPath;
+    std::string listPath;
+    std::vector<std::string> inputs;
+};
+
+struct EvalOptions {
+    OutputFormat format = OutputFormat::Text;
+    std::vector<std::pair<std::string, std::string>> bindings; // имя - файл
+    std::string script;
+    std::string scriptPath;
+    std::string outputPath;
+};
+
+struct RenderOptions {
+    OutputFormat format = OutputFormat::Png;
+    bool formatGiven = false;
+    int view = 0;
+    int width = 800;
+    int height = 600;
+    std::string outputPath;
+    std::string input;
+};
+
+struct ReportOptions {
+    std::string title = "Distribution report";
+    int plotWidth = 320;
+    int plotHeight = 240;
+    std::string outputPath;
+    std::string listPath;
+    std::vector<std::string> inputs;
+};
+
+void printUsage(std::ostream& out) {
+    out << "Usage: ptms-cli stats [options] [files...]\n"
+           "       ptms-cli eval [options] (-e script | script-file)\n"
+           "       ptms-cli render [options] file\n"
+           "       ptms-cli report [options] [files...]\n"
+           "\n"
+           "Distributions are binary files written by serialize()/serializeCompressed()\n"
+           "or CSV files with a .csv extension.\n"
+           "\n"
+           "stats: prints statistics of each file.\n"
+           "  --format csv|json     output format (default csv; json is one object per line)\n"
+           "  --cdf x1,x2,...       also print F(x) at the given points\n"
+           "  --quantile p1,p2,...  also print quantiles at the given levels\n"
+           "  --list path           read input paths from a file, one per line ('-' for stdin)\n"
+           "  --output path         write results to a file instead of stdout\n"
+           "\n"
+           "eval: runs an expression script over named files, e.g.\n"
+           "      ptms-cli eval --bind X=x.bin --bind Y=y.csv -e 'Z = 2*X + Y; report moments(Z)'\n"
+           "  --bind NAME=path      load a distribution as variable NAME (repeatable)\n"
+           "  -e script             script text; otherwise read from script-file ('-' for stdin)\n"
+           "  --format text|json    output format (default text)\n"
+           "  --output path         write results to a file instead of stdout\n"
+           "\n"
+           "render: draws a plot without a window or OpenGL.\n"
+           "  --view law|polyline|cdf  plot to draw (default law)\n"
+           "  --size WxH            image size in pixels (default 800x600)\n"
+           "  --format png|ppm      image format (default from the output extension, else png)\n"
+           "  --output path         write the image to a file instead of stdout\n"
+           "\n"
+           "report: writes an HTML report with the plots and statistics of each file.\n"
+           "  --title text          report title\n"
+           "  --size WxH            size of each plot in pixels (default 320x240)\n"
+           "  --list path           read input paths from a file, one per line ('-' for stdin)\n"
+           "  --output path         write the report to a file instead of stdout\n"
+           "\n"
+           "Common options:\n"
+           "  --instrumentation path  write operation counters as JSON after the run\n"
+           "                          (needs a build with PTMS_ENABLE_INSTRUMENTATION)\n"
+           "  --trace path            write a Chrome trace-event file of heavy operations\n";
+}
+
+std::vector<double> parseNumberList(const std::string& text) {
+    std::vector<double> numbers;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p != end) {
+        double value;
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc() || (result.ptr != end && *result.ptr != ',')) {
+            throw std::invalid_argument("Invalid number list: " + text);
+        }
+        numbers.push_back(value);
+        p = result.ptr == end ? end : result.ptr + 1;
+    }
+    return numbers;
+}
+
+// Значение опции: следующий аргумент
+std::string optionValue(int argc, char** argv, int& i) {
+    if (i + 1 >= argc) {
+        throw std::invalid_argument(std::string("Missing value for ") + argv[i]);
+    }
+    return argv[++i];
+}
+
+bool isOption(const std::string& arg) {
+    return arg.size() > 1 && arg[0] == '-';
+}
+
+StatsOptions parseStatsOptions(int argc, char** argv) {
+    StatsOptions options;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() { return optionValue(argc, argv, i); };
+
+        if (arg == "--format") {
+            std::string format = value();
+            if (format == "csv") {
+                options.format = OutputFormat::Csv;
+            } else if (format == "json") {
+                options.format = OutputFormat::Json;
+            } else {
+                throw std::invalid_argument("Unknown format: " + format);
+            }
+        } else if (arg == "--cdf") {
+            options.cdfPoints = parseNumberList(value());
+        } else if (arg == "--quantile") {
+            options.quantileLevels = parseNumberList(value());
+            for (double p : options.quantileLevels) {
+                if (!(p >= 0.0 && p <= 1.0)) {
+                    throw std::invalid_argument("Quantile level must be in [0, 1]");
+                }
+            }
+        } else if (arg == "--list") {
+            options.listPath = value();
+        } else if (arg == "--output") {
+            options.outputPath = value();
+        } else if (isOption(arg)) {
+            throw std::invalid_argument("Unknown option: " + arg);
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    return options;
+}
+
+EvalOptions parseEvalOptions(int argc, char** argv) {
+    EvalOptions options;
+    bool hasScript = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() { return optionValue(argc, argv, i); };
+
+        if (arg == "--format") {
+            std::string format = value();
+            if (format == "text") {
+                options.format = OutputFormat::Text;
+            } else if (format == "json") {
+                options.format = OutputFormat::Json;
+            } else {
+                throw std::invalid_argument("Unknown format: " + format);
+            }
+        } else if (arg == "--bind") {
+            std::string binding = value();
+            std::size_t eq = binding.find('=');
+            if (eq == std::string::npos || eq == 0 || eq + 1 == binding.size()) {
+                throw std::invalid_argument("Expected NAME=path: " + binding);
+            }
+            options.bindings.push_back({binding.substr(0, eq), binding.substr(eq + 1)});
+        } else if (arg == "-e") {
+            options.script = value();
+            hasScript = true;
+        } else if (arg == "--output") {
+            options.outputPath = value();
+        } else if (isOption(arg) || hasScript) {
+            throw std::invalid_argument("Unexpected argument: " + arg);
+        } else {
+            options.scriptPath = arg;
+            hasScript = true;
+        }
+    }
+    if (!hasScript) {
+        throw std::invalid_argument("Expected a script");
+    }
+    return options;
+}
+
+int parseDimension(const char* first, const char* last, const std::string& text) {
+    int value = 0;
+    auto result = std::from_chars(first, last, value);
+    if (result.ec != std::errc() || result.ptr != last || value <= 0 || value > 16384) {
+        throw std::invalid_argument("Invalid image size: " + text);
+    }
+    return value;
+}
+
+// WxH
+void parseSize(const std::string& size, int& width, int& height) {
+    std::size_t x = size.find('x');
+    if (x == std::string::npos) {
+        throw std::invalid_argument("Invalid image size: " + size);
+    }
+    width = parseDimension(size.data(), size.data() + x, size);
+    height = parseDimension(size.data() + x + 1, size.data() + size.size(), size);
+}
+
+RenderOptions parseRenderOptions(int argc, char** argv) {
+    RenderOptions options;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() { return optionValue(argc, argv, i); };
+
+        if (arg == "--view") {
+            std::string view = value();
+            if (view == "law") {
+                options.view = 0;
+            } else if (view == "polyline") {
+                options.view = 1;
+            } else if (view == "cdf") {
+                options.view = 2;
+            } else {
+                throw std::invalid_argument("Unknown view: " + view);
+            }
+        } else if (arg == "--size") {
+            parseSize(value(), options.width, options.height);
+        } else if (arg == "--format") {
+            std::string format = value();
+            if (format == "png") {
+                options.format = OutputFormat::Png;
+            } else if (format == "ppm") {
+                options.format = OutputFormat::Ppm;
+            } else {
+                throw std::invalid_argument("Unknown format: " + format);
+            }
+            options.formatGiven = true;
+        } else if (arg == "--output") {
+            options.outputPath = value();
+        } else if (isOption(arg) || !options.input.empty()) {
+            throw std::invalid_argument("Unexpected argument: " + arg);
+        } else {
+            options.input = arg;
+        }
+    }
+    if (options.input.empty()) {
+        throw std::invalid_argument("Expected an input file");
+    }
+    const std::string& path = options.outputPath;
+    if (!options.formatGiven && path.size() > 4 && path.compare(path.size() - 4, 4, ".ppm") == 0) {
+        options.format = OutputFormat::Ppm;
+    }
+    return options;
+}
+
+ReportOptions parseReportOptions(int argc, char** argv) {
+    ReportOptions options;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() { return optionValue(argc, argv, i); };
+
+        if (arg == "--title") {
+            options.title = value();
+        } else if (arg == "--size") {
+            parseSize(value(), options.plotWidth, options.plotHeight);
+        } else if (arg == "--list") {
+            options.listPath = value();
+        } else if (arg == "--output") {
+            options.outputPath = value();
+        } else if (isOption(arg)) {
+            throw std::invalid_argument("Unknown option: " + arg);
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    return options;
+}
+
+// Числа: кратчайший точный вид; в JSON нечисловые значения - null
+void appendValue(std::string& out, double value, OutputFormat format) {
+    if (format == OutputFormat::Json && !std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    text_format::appendNumber(out, value);
+}
+
+void appendJsonString(std::string& out, const std::string& text) {
+    out.push_back('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            static const char hex[] = "0123456789abcdef";
+            out += "\\u00";
+            out.push_back(hex[(c >> 4) & 0xF]);
+            out.push_back(hex[c & 0xF]);
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+void appendCsvField(std::string& out, const std::string& text) {
+    if (text.find_first_of(",\"\n\r") == std::string::npos) {
+        out += text;
+        return;
+    }
+    out.push_back('"');
+    for (char c : text) {
+        if (c == '"') out.push_back('"');
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+std::string csvHeader(const StatsOptions& options) {
+    std::string header = "path,atoms,expectation,variance,skewness,kurtosis";
+    for (double x : options.cdfPoints) {
+        header += ",cdf(";
+        text_format::appendNumber(header, x);
+        header += ')';
+    }
+    for (double p : options.quantileLevels) {
+        header += ",quantile(";
+        text_format::appendNumber(header, p);
+        header += ')';
+    }
+    header += ",error\n";
+    return header;
+}
+
+// Одна строка результата; ошибка загрузки попадает в поле error
+void formatRecord(std::string& out, const std::string& path, const StatsOptions& options) {
+    std::size_t columns = 5 + options.cdfPoints.size() + options.quantileLevels.size();
+    try {
+        DiscreteRandomVariable rv = loadDistributionFile(path);
+        DistributionMoments moments = rv.atoms().moments();
+        double fields[] = {moments.expectation, moments.variance, moments.skewness, moments.kurtosis};
+
+        if (options.format == OutputFormat::Csv) {
+            appendCsvField(out, path);
+            out.push_back(',');
+            out += std::to_string(rv.atoms().size());
+            for (double field : fields) {
+                out.push_back(',');
+                appendValue(out, field, options.format);
+            }
+            for (double x : options.cdfPoints) {
+                out.push_back(',');
+                appendValue(out, rv.cdf(x), options.format);
+            }
+            for (double p : options.quantileLevels) {
+                out.push_back(',');
+                appendValue(out, rv.quantile(p), options.format);
+            }
+            out += ",\n";
+        } else {
+            static const char* names[] = {"expectation", "variance", "skewness", "kurtosis"};
+            out += "{\"path\":";
+            appendJsonString(out, path);
+            out += ",\"atoms\":";
+            out += std::to_string(rv.atoms().size());
+            for (int k = 0; k < 4; ++k) {
+                out += ",\"";
+                out += names[k];
+                out += "\":";
+                appendValue(out, fields[k], options.format);
+            }
+            if (!options.cdfPoints.empty()) {
+                out += ",\"cdf\":[";
+                for (std::size_t k = 0; k < options.cdfPoints.size(); ++k) {
+                    if (k) out.push_back(',');
+                    appendValue(out, rv.cdf(options.cdfPoints[k]), options.format);
+                }
+                out.push_back(']');
+            }
+            if (!options.quantileLevels.empty()) {
+                out += ",\"quantile\":[";
+                for (std::size_t k = 0; k < options.quantileLevels.size(); ++k) {
+                    if (k) out.push_back(',');
+                    appendValue(out, rv.quantile(options.quantileLevels[k]), options.format);
+                }
+                out.push_back(']');
+            }
+            out += "}\n";
+        }
+    } catch (const std::exception& e) {
+        if (options.format == OutputFormat::Csv) {
+            appendCsvField(out, path);
+            out.append(columns, ',');
+            out.push_back(',');
+            appendCsvField(out, e.what());
+            out.push_back('\n');
+        } else {
+            out += "{\"path\":";
+            appendJsonString(out, path);
+            out += ",\"error\":";
+            appendJsonString(out, e.what());
+            out += "}\n";
+        }
+        throw;
+    }
+}
+
+// Вывод в файл или stdout
+std::ostream& openOutput(const std::string& path, std::ofstream& file) {
+    if (path.empty()) {
+        return std::cout;
+    }
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+    return file;
+}
+
+void finishOutput(std::ostream& out) {
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Failed to write results");
+    }
+}
+
+// Пути берутся сначала из аргументов, затем из списка - окнами, без чтения всего списка
+class InputPaths {
+private:
+    const std::vector<std::string>& inputs;
+    std::size_t nextInput = 0;
+    std::ifstream listFile;
+    std::istream* list = nullptr;
+
+public:
+    InputPaths(const std::vector<std::string>& inputs, const std::string& listPath) : inputs(inputs) {
+        if (listPath.empty()) return;
+        if (listPath == "-") {
+            list = &std::cin;
+        } else {
+            listFile.open(listPath);
+            if (!listFile.is_open()) {
+                throw std::runtime_error("Cannot open file: " + listPath);
+            }
+            list = &listFile;
+        }
+    }
+
+    // Следующие не более window путей; false - пути закончились
+    bool next(std::vector<std::string>& paths, std::size_t window) {
+        paths.clear();
+        while (paths.size() < window && nextInput < inputs.size()) {
+            paths.push_back(inputs[nextInput++]);
+        }
+        std::string line;
+        while (list && paths.size() < window && std::getline(*list, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) paths.push_back(line);
+        }
+        return !paths.empty();
+    }
+};
+
+int runStats(const StatsOptions& options) {
+    std::ofstream file;
+    std::ostream* out = &openOutput(options.outputPath, file);
+    InputPaths input(options.inputs, options.listPath);
+
+    if (options.format == OutputFormat::Csv) {
+        *out << csvHeader(options);
+    }
+
+    std::size_t failures = 0;
+    std::vector<std::string> paths;
+    std::vector<std::string> records;
+    std::vector<char> failed;
+    while (input.next(paths, kWindow)) {
+        records.assign(paths.size(), std::string());
+        failed.assign(paths.size(), 0);
+        parallelFor(paths.size(), kMinFilesPerThread, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                try {
+                    formatRecord(records[i], paths[i], options);
+                } catch (const std::exception&) {
+                    failed[i] = 1;
+                }
+            }
+        });
+
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            out->write(records[i].data(), static_cast<std::streamsize>(records[i].size()));
+            failures += failed[i];
+        }
+    }
+
+    finishOutput(*out);
+    return failures == 0 ? 0 : 1;
+}
+
+std::string readScript(const EvalOptions& options) {
+    if (options.scriptPath.empty()) {
+        return options.script;
+    }
+    if (options.scriptPath == "-") {
+        return std::string(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
+    std::ifstream file(options.scriptPath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + options.scriptPath);
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+int runEval(const EvalOptions& options) {
+    std::string script = readScript(options);
+
+    // Файлы привязок читаются параллельно
+    std::vector<DiscreteRandomVariable> loaded(options.bindings.size());
+    parallelFor(loaded.size(), 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            loaded[i] = loadDistributionFile(options.bindings[i].second);
+        }
+    });
+
+    expression::Evaluator evaluator;
+    for (std::size_t i = 0; i < loaded.size(); ++i) {
+        evaluator.bind(options.bindings[i].first, std::move(loaded[i]));
+    }
+    std::vector<expression::ReportItem> report = evaluator.run(script);
+
+    std::ofstream file;
+    std::ostream& out = openOutput(options.outputPath, file);
+    std::string line;
+    for (const auto& item : report) {
+        line.clear();
+        if (options.format == OutputFormat::Text) {
+            line += item.text;
+            line += ':';
+            for (const auto& value : item.values) {
+                line += ' ';
+                line += value.first;
+                line += '=';
+                appendValue(line, value.second, options.format);
+            }
+        } else {
+            line += "{\"report\":";
+            appendJsonString(line, item.text);
+            for (const auto& value : item.values) {
+                line += ",\"";
+                line += value.first;
+                line += "\":";
+                appendValue(line, value.second, options.format);
+            }
+            line += '}';
+        }
+        line += '\n';
+        out << line;
+    }
+    finishOutput(out);
+    return 0;
+}
+
+int runRender(const RenderOptions& options) {
+    DiscreteRandomVariable rv;
+    try {
+        rv = loadDistributionFile(options.input);
+    } catch (const std::exception& e) {
+        std::cerr << "ptms-cli: " << options.input << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    RgbImage image = plot_image::render(rv, options.view, options.width, options.height);
+    std::ofstream file;
+    std::ostream& out = openOutput(options.outputPath, file);
+    if (options.format == OutputFormat::Ppm) {
+        plot_image::writePPM(out, image);
+    } else {
+        plot_image::writePNG(out, image);
+    }
+    finishOutput(out);
+    return 0;
+}
+
+int runReport(const ReportOptions& options) {
+    std::ofstream file;
+    std::ostream& out = openOutput(options.outputPath, file);
+    InputPaths input(options.inputs, options.listPath);
+    out << report::htmlHeader(options.title);
+
+    std::size_t entries = 0;
+    std::size_t failures = 0;
+    std::vector<std::string> paths;
+    std::vector<std::string> sections;
+    std::vector<char> failed;
+    while (input.next(paths, kReportWindow)) {
+        sections.assign(paths.size(), std::string());
+        failed.assign(paths.size(), 0);
+        parallelFor(paths.size(), 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                try {
+                    DiscreteRandomVariable rv = loadDistributionFile(paths[i]);
+                    report::appendSection(sections[i], paths[i], rv, options.plotWidth, options.plotHeight);
+                } catch (const std::exception& e) {
+                    sections[i].clear();
+                    report::appendErrorSection(sections[i], paths[i], e.what());
+                    failed[i] = 1;
+                }
+            }
+        });
+
+        for (std::size_t i = 0; i < sections.size(); ++i) {
+            out.write(sections[i].data(), static_cast<std::streamsize>(sections[i].size()));
+            failures += failed[i];
+        }
+        entries += paths.size();
+    }
+
+    out << report::htmlFooter(entries, failures);
+    finishOutput(out);
+    return failures == 0 ? 0 : 1;
+}
+
+void writeInstrumentation(const std::string& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << instrumentation::snapshotJSON() << '\n';
+    if (!file) {
+        throw std::runtime_error("Cannot write file: " + path);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::ios::sync_with_stdio(false);
+
+    // Общие опции убираются из аргументов до разбора команды
+    std::string instrumentationPath;
+    std::string tracePath;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        if (std::string(argv[i]) == "--instrumentation" && i + 1 < argc) {
+            instrumentationPath = argv[++i];
+        } else if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    std::string command = argc >= 2 ? argv[1] : "";
+    StatsOptions statsOptions;
+    EvalOptions evalOptions;
+    RenderOptions renderOptions;
+    ReportOptions reportOptions;
+    try {
+        if (command == "stats") {
+            statsOptions = parseStatsOptions(argc, argv);
+        } else if (command == "eval") {
+            evalOptions = parseEvalOptions(argc, argv);
+        } else if (command == "render") {
+            renderOptions = parseRenderOptions(argc, argv);
+        } else if (command == "report") {
+            reportOptions = parseReportOptions(argc, argv);
+        } else {
+            throw std::invalid_argument("Expected a command");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ptms-cli: " << e.what() << "\n\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    int status;
+    try {
+        if (!tracePath.empty()) {
+            tracing::start(tracePath);
+        }
+        if (command == "stats") {
+            status = runStats(statsOptions);
+        } else if (command == "eval") {
+            status = runEval(evalOptions);
+        } else if (command == "render") {
+            status = runRender(renderOptions);
+        } else {
+            status = runReport(reportOptions);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ptms-cli: " << e.what() << "\n";
+        status = 2;
+    }
+    try {
+        tracing::stop();
+    } catch (const std::exception& e) {
+        std::cerr << "ptms-cli: " << e.what() << "\n";
+        status = 2;
+    }
+
+    if (!instrumentationPath.empty()) {
+        try {
+            writeInstrumentation(instrumentationPath);
+        } catch (const std::exception& e) {
+            std::cerr << "ptms-cli: " << e.what() << "\n";
+            status = 2;
+        }
+    }
+    return status;
+}
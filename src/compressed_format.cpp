@@ -0,0 +1,390 @@
+#include "../include/compressed_format.h"
+#include "../include/parallel.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+std::uint64_t lowMask(int bits) {
+    return bits >= 64 ? ~0ull : ((1ull << bits) - 1);
+}
+
+// Побитовая запись/чтение, старшие биты первыми
+class BitWriter {
+private:
+    std::vector<unsigned char>& out;
+    std::uint64_t acc;
+    int fill;
+
+public:
+    explicit BitWriter(std::vector<unsigned char>& output) : out(output), acc(0), fill(0) {}
+
+    void write(std::uint64_t value, int count) {
+        if (count > 32) {
+            write(value >> 32, count - 32);
+            value &= 0xFFFFFFFFull;
+            count = 32;
+        }
+        acc = (acc << count) | (value & lowMask(count));
+        fill += count;
+        while (fill >= 8) {
+            fill -= 8;
+            out.push_back(static_cast<unsigned char>(acc >> fill));
+        }
+        acc &= lowMask(fill);
+    }
+
+    void finish() {
+        if (fill > 0) {
+            out.push_back(static_cast<unsigned char>(acc << (8 - fill)));
+        }
+        acc = 0;
+        fill = 0;
+    }
+};
+
+class BitReader {
+private:
+    const unsigned char* p;
+    const unsigned char* end;
+    std::uint64_t acc;
+    int fill;
+
+public:
+    BitReader(const unsigned char* data, std::size_t size) : p(data), end(data + size), acc(0), fill(0) {}
+
+    std::uint64_t read(int count) {
+        if (count > 32) {
+            std::uint64_t high = read(count - 32);
+            return (high << 32) | read(32);
+        }
+        while (fill < count) {
+            if (p == end) {
+                throw std::runtime_error("Corrupted compressed block");
+            }
+            acc = (acc << 8) | *p++;
+            fill += 8;
+        }
+        fill -= count;
+        std::uint64_t value = (acc >> fill) & lowMask(count);
+        acc &= lowMask(fill);
+        return value;
+    }
+};
+
+void putVarint(std::vector<unsigned char>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+std::uint64_t getVarint(const unsigned char*& p, const unsigned char* end) {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) break;
+        unsigned char byte = *p++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw std::runtime_error("Corrupted compressed block");
+}
+
+std::uint64_t doubleBits(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsToDouble(std::uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Монотонное отображение double -> uint64: порядок ключей совпадает с порядком значений
+std::uint64_t orderKey(double value) {
+    std::uint64_t bits = doubleBits(value);
+    return (bits >> 63) ? ~bits : (bits | (1ull << 63));
+}
+
+double fromOrderKey(std::uint64_t key) {
+    return bitsToDouble((key >> 63) ? (key & ~(1ull << 63)) : ~key);
+}
+
+std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+void encodeValues(const std::pair<double, double>* atoms, std::size_t count, std::vector<unsigned char>& out) {
+    std::uint64_t prevKey = orderKey(atoms[0].first);
+    binary_format::appendLE(out, prevKey, 8);
+
+    std::uint64_t prevDelta = 0;
+    std::uint64_t zeros = 0;
+    for (std::size_t i = 1; i < count; ++i) {
+        std::uint64_t key = orderKey(atoms[i].first);
+        std::uint64_t delta = key - prevKey;
+        std::int64_t dod = static_cast<std::int64_t>(delta - prevDelta);
+        if (dod == 0) {
+            ++zeros;
+        } else {
+            if (zeros > 0) {
+                putVarint(out, 0);
+                putVarint(out, zeros - 1);
+                zeros = 0;
+            }
+            putVarint(out, zigzag(dod));
+        }
+        prevDelta = delta;
+        prevKey = key;
+    }
+    if (zeros > 0) {
+        putVarint(out, 0);
+        putVarint(out, zeros - 1);
+    }
+}
+
+void decodeValues(const unsigned char* p, const unsigned char* end, std::pair<double, double>* out, std::size_t count) {
+    if (end - p < 8) {
+        throw std::runtime_error("Corrupted compressed block");
+    }
+    std::uint64_t key = binary_format::getLE(p, 8);
+    p += 8;
+    out[0].first = fromOrderKey(key);
+
+    std::uint64_t delta = 0;
+    std::size_t i = 1;
+    while (i < count) {
+        std::uint64_t token = getVarint(p, end);
+        std::uint64_t run = 1;
+        std::int64_t dod = 0;
+        if (token == 0) {
+            run = getVarint(p, end) + 1;
+            if (run > count - i) {
+                throw std::runtime_error("Corrupted compressed block");
+            }
+        } else {
+            dod = unzigzag(token);
+        }
+        delta += static_cast<std::uint64_t>(dod);
+        for (std::uint64_t r = 0; r < run; ++r, ++i) {
+            key += delta;
+            out[i].first = fromOrderKey(key);
+        }
+    }
+}
+
+void encodeProbabilities(const std::pair<double, double>* atoms, std::size_t count, std::vector<unsigned char>& out) {
+    std::uint64_t prev = doubleBits(atoms[0].second);
+    binary_format::appendLE(out, prev, 8);
+
+    BitWriter writer(out);
+    int prevLeading = -1;
+    int prevTrailing = 0;
+    for (std::size_t i = 1; i < count; ++i) {
+        std::uint64_t bits = doubleBits(atoms[i].second);
+        std::uint64_t x = bits ^ prev;
+        prev = bits;
+
+        if (x == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+        int leading = std::min(binary_format::countLeadingZeros(x), 31);
+        int trailing = binary_format::countTrailingZeros(x);
+        if (prevLeading >= 0 && leading >= prevLeading && trailing >= prevTrailing) {
+            // Значащие биты помещаются в окно предыдущего значения
+            writer.write(0x2, 2);
+            writer.write(x >> prevTrailing, 64 - prevLeading - prevTrailing);
+        } else {
+            int significant = 64 - leading - trailing;
+            writer.write(0x3, 2);
+            writer.write(static_cast<std::uint64_t>(leading), 5);
+            writer.write(static_cast<std::uint64_t>(significant & 63), 6);
+            writer.write(x >> trailing, significant);
+            prevLeading = leading;
+            prevTrailing = trailing;
+        }
+    }
+    writer.finish();
+}
+
+void decodeProbabilities(const unsigned char* p, const unsigned char* end, std::pair<double, double>* out, std::size_t count) {
+    if (end - p < 8) {
+        throw std::runtime_error("Corrupted compressed block");
+    }
+    std::uint64_t bits = binary_format::getLE(p, 8);
+    out[0].second = bitsToDouble(bits);
+
+    BitReader reader(p + 8, static_cast<std::size_t>(end - p - 8));
+    int leading = 0;
+    int trailing = 0;
+    for (std::size_t i = 1; i < count; ++i) {
+        if (reader.read(1) != 0) {
+            if (reader.read(1) != 0) {
+                leading = static_cast<int>(reader.read(5));
+                int significant = static_cast<int>(reader.read(6));
+                if (significant == 0) significant = 64;
+                trailing = 64 - leading - significant;
+                if (trailing < 0) {
+                    throw std::runtime_error("Corrupted compressed block");
+                }
+            }
+            bits ^= reader.read(64 - leading - trailing) << trailing;
+        }
+        out[i].second = bitsToDouble(bits);
+    }
+}
+
+}
+
+namespace compressed_format {
+
+void encodeBlock(const std::pair<double, double>* atoms, std::size_t count, std::vector<unsigned char>& out) {
+    out.clear();
+    binary_format::appendLE(out, count, 4);
+    binary_format::appendLE(out, 0, 4); // valueBytes, заполняется ниже
+    if (count == 0) return;
+
+    encodeValues(atoms, count, out);
+    std::uint64_t valueBytes = out.size() - 8;
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<unsigned char>(valueBytes >> (8 * i));
+    }
+    encodeProbabilities(atoms, count, out);
+}
+
+std::size_t decodeBlock(const unsigned char* data, std::size_t size, std::pair<double, double>* out, std::size_t capacity) {
+    if (size < 8) {
+        throw std::runtime_error("Corrupted compressed block");
+    }
+    std::size_t count = static_cast<std::size_t>(binary_format::getLE(data, 4));
+    std::size_t valueBytes = static_cast<std::size_t>(binary_format::getLE(data + 4, 4));
+    if (count > capacity || valueBytes > size - 8) {
+        throw std::runtime_error("Corrupted compressed block");
+    }
+    if (count == 0) return 0;
+
+    const unsigned char* values = data + 8;
+    decodeValues(values, values + valueBytes, out, count);
+    decodeProbabilities(values + valueBytes, data + size, out, count);
+    return count;
+}
+
+Directory readDirectory(std::istream& in, const BinaryHeader& header, std::uint32_t& crc) {
+    unsigned char prefix[8];
+    if (!in.read(reinterpret_cast<char*>(prefix), sizeof(prefix))) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+    crc = binary_format::crc32(prefix, sizeof(prefix), crc);
+
+    Directory directory;
+    directory.blockAtoms = static_cast<std::uint32_t>(binary_format::getLE(prefix, 4));
+    std::uint64_t blockCount = binary_format::getLE(prefix + 4, 4);
+    if (directory.blockAtoms == 0 ||
+        blockCount != (header.atomCount + directory.blockAtoms - 1) / directory.blockAtoms) {
+        throw std::runtime_error("Corrupted compressed directory");
+    }
+
+    std::vector<unsigned char> raw(static_cast<std::size_t>(blockCount) * 8);
+    if (!in.read(reinterpret_cast<char*>(raw.data()), raw.size())) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+    crc = binary_format::crc32(raw.data(), raw.size(), crc);
+
+    directory.blockEnds.resize(static_cast<std::size_t>(blockCount));
+    std::uint64_t previous = 0;
+    for (std::size_t i = 0; i < directory.blockEnds.size(); ++i) {
+        directory.blockEnds[i] = binary_format::getLE(raw.data() + 8 * i, 8);
+        if (directory.blockEnds[i] < previous) {
+            throw std::runtime_error("Corrupted compressed directory");
+        }
+        previous = directory.blockEnds[i];
+    }
+    return directory;
+}
+
+void write(std::ostream& out, AtomSpan atoms, std::uint32_t flags, std::size_t blockAtoms) {
+    std::size_t blockCount = (atoms.size() + blockAtoms - 1) / blockAtoms;
+    std::vector<std::vector<unsigned char>> blocks(blockCount);
+    parallelFor(blockCount, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+            std::size_t first = b * blockAtoms;
+            encodeBlock(atoms.data() + first, std::min(blockAtoms, atoms.size() - first), blocks[b]);
+        }
+    });
+
+    std::vector<unsigned char> directory;
+    directory.reserve(8 + 8 * blockCount);
+    binary_format::appendLE(directory, blockAtoms, 4);
+    binary_format::appendLE(directory, blockCount, 4);
+    std::uint64_t offset = 0;
+    for (const auto& block : blocks) {
+        offset += block.size();
+        binary_format::appendLE(directory, offset, 8);
+    }
+
+    std::uint32_t crc = binary_format::crc32(directory.data(), directory.size());
+    for (const auto& block : blocks) {
+        crc = binary_format::crc32(block.data(), block.size(), crc);
+    }
+
+    BinaryHeader header;
+    header.version = binary_format::kCompressedFormatVersion;
+    header.flags = flags | binary_format::kFlagCompressed;
+    header.atomCount = atoms.size();
+    header.crc = crc;
+    binary_format::writeHeader(out, header);
+
+    out.write(reinterpret_cast<const char*>(directory.data()), directory.size());
+    for (const auto& block : blocks) {
+        out.write(reinterpret_cast<const char*>(block.data()), block.size());
+    }
+    if (!out) {
+        throw std::runtime_error("Failed to write distribution");
+    }
+}
+
+std::pmr::vector<std::pair<double, double>> read(std::istream& in, const BinaryHeader& header, std::uint64_t available,
+                                                 std::pmr::memory_resource* resource) {
+    std::uint32_t crc = 0;
+    Directory directory = readDirectory(in, header, crc);
+
+    std::uint64_t directoryBytes = 8 + 8 * directory.blockEnds.size();
+    std::uint64_t dataBytes = directory.blockEnds.empty() ? 0 : directory.blockEnds.back();
+    if (directoryBytes + dataBytes > available) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+
+    std::pmr::vector<unsigned char> data(static_cast<std::size_t>(dataBytes), resource);
+    if (!in.read(reinterpret_cast<char*>(data.data()), data.size())) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+    if (binary_format::crc32(data.data(), data.size(), crc) != header.crc) {
+        throw std::runtime_error("Distribution checksum mismatch");
+    }
+
+    std::pmr::vector<std::pair<double, double>> atoms(static_cast<std::size_t>(header.atomCount), resource);
+    parallelFor(directory.blockEnds.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+            std::uint64_t start = b == 0 ? 0 : directory.blockEnds[b - 1];
+            std::size_t first = b * directory.blockAtoms;
+            std::size_t expected = std::min<std::size_t>(directory.blockAtoms, atoms.size() - first);
+            std::size_t decoded = decodeBlock(data.data() + start, static_cast<std::size_t>(directory.blockEnds[b] - start),
+                                              atoms.data() + first, expected);
+            if (decoded != expected) {
+                throw std::runtime_error("Corrupted compressed block");
+            }
+        }
+    });
+    return atoms;
+}
+
+}
@@ -0,0 +1,19 @@
+#include "../include/distribution_file.h"
+#include "../include/text_format.h"
+#include <fstream>
+#include <stdexcept>
+
+DiscreteRandomVariable loadDistributionFile(const std::string& path) {
+    const std::string extension = ".csv";
+    if (path.size() >= extension.size() &&
+        path.compare(path.size() - extension.size(), extension.size(), extension) == 0) {
+        return text_format::readCSV(path);
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    DiscreteRandomVariable rv;
+    rv.deserialize(file);
+    return rv;
+}
@@ -0,0 +1,308 @@
+#include "../include/distribution_stream.h"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <stdexcept>
+
+DistributionReader::DistributionReader(const std::string& path, std::size_t chunkAtoms)
+    : remaining(0), crc(0), nextBlock(0) {
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    header = binary_format::readHeader(file);
+    if (!binary_format::hasDefaultTypes(header)) {
+        throw std::runtime_error("Only float64 distribution files can be streamed; load them with deserialize()");
+    }
+
+    file.seekg(0, std::ios::end);
+    std::uint64_t available = static_cast<std::uint64_t>(file.tellg()) - binary_format::kHeaderSize;
+
+    if (header.flags & binary_format::kFlagCompressed) {
+        file.seekg(binary_format::kHeaderSize);
+        std::uint32_t directoryCrc = 0;
+        directory = compressed_format::readDirectory(file, header, directoryCrc);
+        std::uint64_t dataBytes = directory.blockEnds.empty() ? 0 : directory.blockEnds.back();
+        if (8 + 8 * directory.blockEnds.size() + dataBytes > available) {
+            throw std::runtime_error("Unexpected end of file");
+        }
+        buffer.resize(directory.blockAtoms);
+    } else {
+        if (header.atomCount > available / binary_format::kAtomSize) {
+            throw std::runtime_error("Unexpected end of file");
+        }
+        buffer.resize(std::max<std::size_t>(chunkAtoms, 1));
+    }
+    rewind();
+}
+
+AtomSpan DistributionReader::next() {
+    if (remaining == 0) {
+        return AtomSpan();
+    }
+    if (header.flags & binary_format::kFlagCompressed) {
+        return nextCompressed();
+    }
+
+    std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), remaining));
+    std::size_t bytes = n * binary_format::kAtomSize;
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), bytes)) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+    crc = binary_format::crc32(buffer.data(), bytes, crc);
+    remaining -= n;
+    if (remaining == 0 && crc != header.crc) {
+        throw std::runtime_error("Distribution checksum mismatch");
+    }
+
+    if (!binary_format::isLittleEndianHost()) {
+        binary_format::byteSwap64(buffer.data(), n * 2);
+    }
+    return AtomSpan(buffer.data(), n);
+}
+
+AtomSpan DistributionReader::nextCompressed() {
+    std::uint64_t start = nextBlock == 0 ? 0 : directory.blockEnds[nextBlock - 1];
+    std::size_t bytes = static_cast<std::size_t>(directory.blockEnds[nextBlock] - start);
+    blockBuffer.resize(bytes);
+    if (!file.read(reinterpret_cast<char*>(blockBuffer.data()), bytes)) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+    crc = binary_format::crc32(blockBuffer.data(), bytes, crc);
+
+    std::size_t expected = static_cast<std::size_t>(std::min<std::uint64_t>(directory.blockAtoms, remaining));
+    std::size_t n = compressed_format::decodeBlock(blockBuffer.data(), bytes, buffer.data(), expected);
+    if (n != expected) {
+        throw std::runtime_error("Corrupted compressed block");
+    }
+    ++nextBlock;
+    remaining -= n;
+    if (remaining == 0 && crc != header.crc) {
+        throw std::runtime_error("Distribution checksum mismatch");
+    }
+    return AtomSpan(buffer.data(), n);
+}
+
+void DistributionReader::rewind() {
+    file.clear();
+    remaining = header.atomCount;
+    crc = 0;
+    nextBlock = 0;
+
+    if (header.flags & binary_format::kFlagCompressed) {
+        // Пропускаем оглавление, учитывая его в CRC
+        file.seekg(binary_format::kHeaderSize);
+        compressed_format::readDirectory(file, header, crc);
+    } else {
+        file.seekg(binary_format::kHeaderSize);
+    }
+}
+
+DistributionWriter::DistributionWriter(const std::string& path, std::size_t chunkAtoms)
+    : chunkAtoms(std::max<std::size_t>(chunkAtoms, 1)), count(0), crc(0),
+      totalProbability(0.0), lastValue(0.0), closed(false) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+
+    // Заголовок-заполнитель, перезаписывается в close()
+    BinaryHeader header = {binary_format::kFormatVersion, 0, 0, 0};
+    binary_format::writeHeader(file, header);
+    buffer.reserve(this->chunkAtoms);
+}
+
+DistributionWriter::~DistributionWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void DistributionWriter::write(double value, double probability) {
+    if (closed) {
+        throw std::runtime_error("Writer is closed");
+    }
+    if (probability < 0) {
+        throw std::invalid_argument("Probabilities cannot be negative");
+    }
+    if (count > 0 && !(value > lastValue)) {
+        throw std::invalid_argument("Values must be written in strictly increasing order");
+    }
+
+    buffer.push_back({value, probability});
+    totalProbability += probability;
+    lastValue = value;
+    ++count;
+
+    if (buffer.size() == chunkAtoms) {
+        flush();
+    }
+}
+
+void DistributionWriter::write(AtomSpan atoms) {
+    for (const auto& atom : atoms) {
+        write(atom.first, atom.second);
+    }
+}
+
+void DistributionWriter::flush() {
+    if (buffer.empty()) return;
+
+    if (!binary_format::isLittleEndianHost()) {
+        binary_format::byteSwap64(buffer.data(), buffer.size() * 2);
+    }
+    std::size_t bytes = buffer.size() * binary_format::kAtomSize;
+    crc = binary_format::crc32(buffer.data(), bytes, crc);
+    file.write(reinterpret_cast<const char*>(buffer.data()), bytes);
+    buffer.clear();
+
+    if (!file) {
+        throw std::runtime_error("Failed to write distribution");
+    }
+}
+
+void DistributionWriter::close() {
+    if (closed) return;
+    closed = true;
+    flush();
+
+    BinaryHeader header;
+    header.version = binary_format::kFormatVersion;
+    header.flags = (count > 0 && std::abs(totalProbability - 1.0) <= 1e-10) ? binary_format::kFlagCanonical : 0;
+    header.atomCount = count;
+    header.crc = crc;
+
+    file.seekp(0);
+    binary_format::writeHeader(file, header);
+    file.close();
+    if (file.fail()) {
+        throw std::runtime_error("Failed to write distribution");
+    }
+}
+
+MomentAccumulator streamMoments(const std::string& path) {
+    DistributionReader reader(path);
+    MomentAccumulator accumulator;
+    for (AtomSpan chunk = reader.next(); !chunk.empty(); chunk = reader.next()) {
+        accumulator.add(chunk);
+    }
+    return accumulator;
+}
+
+std::vector<double> streamCDF(const std::string& path, const std::vector<double>& points) {
+    // Массу каждого атома относим к первой точке запроса >= значения атома,
+    // затем накапливаем; порядок атомов в файле не важен
+    std::vector<double> sortedPoints(points);
+    std::sort(sortedPoints.begin(), sortedPoints.end());
+    std::vector<double> mass(sortedPoints.size() + 1, 0.0);
+
+    DistributionReader reader(path);
+    double total = 0.0;
+    for (AtomSpan chunk = reader.next(); !chunk.empty(); chunk = reader.next()) {
+        for (const auto& atom : chunk) {
+            auto bucket = std::lower_bound(sortedPoints.begin(), sortedPoints.end(), atom.first) - sortedPoints.begin();
+            mass[bucket] += atom.second;
+            total += atom.second;
+        }
+    }
+    if (total <= 0.0) {
+        throw std::invalid_argument("Distribution cannot be empty");
+    }
+
+    std::partial_sum(mass.begin(), mass.end(), mass.begin());
+    std::vector<double> result;
+    result.reserve(points.size());
+    for (double x : points) {
+        auto index = std::lower_bound(sortedPoints.begin(), sortedPoints.end(), x) - sortedPoints.begin();
+        result.push_back(std::min(mass[index] / total, 1.0));
+    }
+    return result;
+}
+
+std::vector<double> streamQuantiles(const std::string& path, const std::vector<double>& levels) {
+    for (double p : levels) {
+        if (!(p >= 0.0 && p <= 1.0)) {
+            throw std::invalid_argument("Quantile level must be in [0, 1]");
+        }
+    }
+
+    std::vector<std::size_t> order(levels.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return levels[a] < levels[b]; });
+
+    DistributionReader reader(path);
+    if (reader.size() == 0) {
+        throw std::invalid_argument("Distribution cannot be empty");
+    }
+
+    // Для ненормированного файла нужен дополнительный проход за полной массой
+    double total = 1.0;
+    if (!reader.isCanonical()) {
+        total = 0.0;
+        for (AtomSpan chunk = reader.next(); !chunk.empty(); chunk = reader.next()) {
+            for (const auto& atom : chunk) {
+                total += atom.second;
+            }
+        }
+        reader.rewind();
+    }
+
+    std::vector<double> result(levels.size());
+    std::size_t next = 0;
+    double cumulative = 0.0;
+    double lastValue = 0.0;
+    bool first = true;
+    for (AtomSpan chunk = reader.next(); !chunk.empty() && next < order.size(); chunk = reader.next()) {
+        for (const auto& atom : chunk) {
+            if (!first && !(atom.first > lastValue)) {
+                throw std::runtime_error("Quantiles require atoms sorted by value");
+            }
+            first = false;
+            lastValue = atom.first;
+            cumulative += atom.second;
+            while (next < order.size() && cumulative >= levels[order[next]] * total) {
+                result[order[next++]] = atom.first;
+            }
+        }
+    }
+    // Все уровни найдены раньше конца файла: дочитываем остаток, иначе испорченный
+    // хвост не заметен (CRC проверяется на последнем блоке)
+    while (!reader.next().empty()) {
+    }
+    // Накопленная сумма может не дотянуть до 1 из-за округления
+    for (; next < order.size(); ++next) {
+        result[order[next]] = lastValue;
+    }
+    return result;
+}
+
+std::uint64_t streamPrune(const std::string& inputPath, const std::string& outputPath, double minProbability) {
+    DistributionReader reader(inputPath);
+
+    double kept = 0.0;
+    for (AtomSpan chunk = reader.next(); !chunk.empty(); chunk = reader.next()) {
+        for (const auto& atom : chunk) {
+            if (atom.second >= minProbability) {
+                kept += atom.second;
+            }
+        }
+    }
+    if (kept <= 0.0) {
+        throw std::invalid_argument("Pruning would remove every atom");
+    }
+
+    reader.rewind();
+    DistributionWriter writer(outputPath);
+    std::uint64_t count = 0;
+    for (AtomSpan chunk = reader.next(); !chunk.empty(); chunk = reader.next()) {
+        for (const auto& atom : chunk) {
+            if (atom.second >= minProbability) {
+                writer.write(atom.first, atom.second / kept);
+                ++count;
+            }
+        }
+    }
+    writer.close();
+    return count;
+}
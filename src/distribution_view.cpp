@@ -0,0 +1,115 @@
+#include "../include/distribution_view.h"
+#include "../include/binary_format.h"
+#include <mutex>
+#include <stdexcept>
+
+// Строится один раз, в том числе при одновременных запросах из нескольких потоков
+struct DistributionView::PrefixIndex {
+    std::once_flag built;
+    std::vector<double> cumulative;
+};
+
+DistributionView::DistributionView(const std::string& path) : payloadCrc(0) {
+    if (!binary_format::isLittleEndianHost()) {
+        throw std::runtime_error("Zero-copy loading requires a little-endian host");
+    }
+
+    file = MappedFile(path);
+    if (file.size() < binary_format::kHeaderSize) {
+        throw std::runtime_error("Unexpected end of file while reading header");
+    }
+    BinaryHeader header = binary_format::decodeHeader(file.data());
+
+    if (header.flags & binary_format::kFlagCompressed) {
+        throw std::runtime_error("Compressed distribution files cannot be mapped; load them with deserialize()");
+    }
+    if (!binary_format::hasDefaultTypes(header)) {
+        throw std::runtime_error("Only float64 distribution files can be mapped; load them with deserialize()");
+    }
+    if (!(header.flags & binary_format::kFlagCanonical)) {
+        throw std::runtime_error("Distribution file is not in canonical order; re-save it with serialize()");
+    }
+    std::size_t available = file.size() - binary_format::kHeaderSize;
+    if (header.atomCount == 0 || header.atomCount > available / binary_format::kAtomSize) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+
+    payloadCrc = header.crc;
+    auto atoms = reinterpret_cast<const std::pair<double, double>*>(file.data() + binary_format::kHeaderSize);
+    span = AtomSpan(atoms, static_cast<std::size_t>(header.atomCount));
+    index = std::make_unique<PrefixIndex>();
+}
+
+DistributionView::DistributionView(DistributionView&& other) noexcept
+    : file(std::move(other.file)), payloadCrc(other.payloadCrc), span(other.span), index(std::move(other.index)) {
+    other.span = AtomSpan();
+}
+
+DistributionView& DistributionView::operator=(DistributionView&& other) noexcept {
+    if (this != &other) {
+        file = std::move(other.file);
+        payloadCrc = other.payloadCrc;
+        span = other.span;
+        index = std::move(other.index);
+        other.span = AtomSpan();
+    }
+    return *this;
+}
+
+DistributionView::~DistributionView() = default;
+
+AtomSpan DistributionView::indexed() const {
+    if (!index) {
+        return span; // перемещенный объект
+    }
+    std::call_once(index->built, [this]() {
+        // Как в DiscreteRandomVariable: сумма копится в double и сохраняется по атомам
+        index->cumulative.resize(span.size());
+        double sum = 0.0;
+        for (std::size_t i = 0; i < span.size(); ++i) {
+            sum += span[i].second;
+            index->cumulative[i] = sum;
+        }
+    });
+    return AtomSpan(span.data(), span.size(), index->cumulative.data());
+}
+
+double DistributionView::expectation() const {
+    return span.expectation();
+}
+
+double DistributionView::variance() const {
+    return span.variance();
+}
+
+double DistributionView::skewness() const {
+    return span.skewness();
+}
+
+double DistributionView::kurtosis() const {
+    return span.kurtosis();
+}
+
+double DistributionView::standardDeviation() const {
+    return span.standardDeviation();
+}
+
+double DistributionView::cdf(double x) const {
+    return indexed().cdf(x);
+}
+
+double DistributionView::quantile(double p) const {
+    return indexed().quantile(p);
+}
+
+std::vector<std::pair<double, double>> DistributionView::getCDF() const {
+    return indexed().getCDF();
+}
+
+bool DistributionView::verify() const {
+    return binary_format::crc32(span.data(), span.size() * binary_format::kAtomSize) == payloadCrc;
+}
+
+DiscreteRandomVariable DistributionView::toRandomVariable() const {
+    return DiscreteRandomVariable(std::vector<std::pair<double, double>>(span.begin(), span.end()));
+}
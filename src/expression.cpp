@@ -0,0 +1,528 @@
+#include "../include/expression.h"
+#include "../include/parallel.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+enum class TokenKind {
+    Number,
+    Identifier,
+    Symbol,    // + - * ( ) , =
+    Separator, // ';' или перевод строки вне скобок
+    End
+};
+
+struct Token {
+    TokenKind kind;
+    char symbol;
+    double number;
+    std::size_t begin; // смещение в тексте скрипта
+    std::size_t end;
+    std::size_t line;
+    std::size_t column;
+};
+
+std::string location(const Token& token) {
+    return " at line " + std::to_string(token.line) + ", column " + std::to_string(token.column);
+}
+
+bool isIdentifierStart(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+std::vector<Token> tokenize(const std::string& text) {
+    std::vector<Token> tokens;
+    std::size_t line = 1;
+    std::size_t lineStart = 0;
+    int depth = 0;
+    std::size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        Token token = {TokenKind::Symbol, c, 0.0, i, i + 1, line, i - lineStart + 1};
+
+        if (c == '\n') {
+            if (depth == 0) {
+                token.kind = TokenKind::Separator;
+                tokens.push_back(token);
+            }
+            ++line;
+            lineStart = ++i;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r') {
+            ++i;
+            continue;
+        }
+        if (c == '#') {
+            while (i < text.size() && text[i] != '\n') ++i;
+            continue;
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            auto result = std::from_chars(text.data() + i, text.data() + text.size(), token.number);
+            if (result.ec != std::errc() || !std::isfinite(token.number)) {
+                throw std::invalid_argument("Invalid number" + location(token));
+            }
+            token.kind = TokenKind::Number;
+            i = result.ptr - text.data();
+        } else if (isIdentifierStart(c)) {
+            token.kind = TokenKind::Identifier;
+            while (i < text.size() && isIdentifierChar(text[i])) ++i;
+        } else if (c == ';') {
+            token.kind = TokenKind::Separator;
+            ++i;
+        } else if (c == '+' || c == '-' || c == '*' || c == ',' || c == '=' || c == '(' || c == ')') {
+            depth += c == '(' ? 1 : c == ')' ? -1 : 0;
+            depth = std::max(depth, 0); // лишняя ')' - ошибка разбора, а не токенизации
+            ++i;
+        } else {
+            throw std::invalid_argument(std::string("Unexpected character '") + c + "'" + location(token));
+        }
+        token.end = i;
+        tokens.push_back(token);
+    }
+    tokens.push_back({TokenKind::End, 0, 0.0, text.size(), text.size(), line, text.size() - lineStart + 1});
+    return tokens;
+}
+
+enum class RequestKind {
+    Moments,
+    Expectation,
+    Variance,
+    StandardDeviation,
+    Skewness,
+    Kurtosis,
+    Atoms,
+    Cdf,
+    Quantile
+};
+
+struct RequestFunction {
+    const char* name;
+    RequestKind kind;
+    bool hasArgument; // второй числовой аргумент: точка для cdf, уровень для quantile
+};
+
+const RequestFunction kRequestFunctions[] = {
+    {"moments", RequestKind::Moments, false},
+    {"expectation", RequestKind::Expectation, false},
+    {"mean", RequestKind::Expectation, false},
+    {"variance", RequestKind::Variance, false},
+    {"stddev", RequestKind::StandardDeviation, false},
+    {"skewness", RequestKind::Skewness, false},
+    {"kurtosis", RequestKind::Kurtosis, false},
+    {"atoms", RequestKind::Atoms, false},
+    {"cdf", RequestKind::Cdf, true},
+    {"quantile", RequestKind::Quantile, true},
+};
+
+bool isValidName(const std::string& name) {
+    if (name.empty() || !isIdentifierStart(name[0]) || name == "report") {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), isIdentifierChar);
+}
+
+}
+
+namespace expression {
+
+struct Evaluator::Request {
+    std::string text;
+    RequestKind kind;
+    int node;
+    double argument;
+};
+
+// Рекурсивный спуск:
+//   statement := 'report' item (',' item)* | name '=' expr
+//   item      := function '(' expr [',' expr] ')'
+//   expr      := term (('+' | '-') term)*
+//   term      := unary ('*' unary)*
+//   unary     := '-' unary | number | name | '(' expr ')'
+// Числа сворачиваются при разборе; выражения над величинами становятся узлами графа.
+struct Evaluator::Parser {
+    // Операнд: число или узел графа
+    struct Value {
+        bool isScalar;
+        double scalar;
+        int node;
+    };
+
+    Evaluator& owner;
+    const std::string& text;
+    std::vector<Token> tokens;
+    std::size_t position = 0;
+    std::map<std::string, int> names; // копия: применяется только после успешного разбора
+    std::vector<Request> requests;
+    std::vector<int> roots;
+
+    Parser(Evaluator& owner, const std::string& text)
+        : owner(owner), text(text), tokens(tokenize(text)), names(owner.names) {}
+
+    const Token& peek() const { return tokens[position]; }
+    const Token& next() { return tokens[position++]; }
+
+    bool acceptSymbol(char symbol) {
+        if (peek().kind == TokenKind::Symbol && peek().symbol == symbol) {
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    void expectSymbol(char symbol) {
+        if (!acceptSymbol(symbol)) {
+            throw std::invalid_argument(std::string("Expected '") + symbol + "'" + location(peek()));
+        }
+    }
+
+    std::string identifier(const Token& token) const {
+        return text.substr(token.begin, token.end - token.begin);
+    }
+
+    double checked(double value, const Token& token) const {
+        if (!std::isfinite(value)) {
+            throw std::invalid_argument("Constant is not finite" + location(token));
+        }
+        return value;
+    }
+
+    // Свертка с числом и объединение масштабов/сдвигов: 2*(3*X) = 6*X.
+    // Свернутые числа проверяются, как и результат операции над числами:
+    // 1e200*(1e200*X) - ошибка разбора, а не масштаб inf
+    int scale(int node, double factor, const Token& token) {
+        Node n = owner.nodes[node]; // копия: intern может перераспределить nodes
+        if (factor == 1.0) return node;
+        if (factor == 0.0) return owner.intern(Op::Point, 0.0, -1, -1);
+        if (n.op == Op::Point) return owner.intern(Op::Point, checked(n.scalar * factor, token), -1, -1);
+        if (n.op == Op::Scale) return scale(n.left, checked(n.scalar * factor, token), token);
+        return owner.intern(Op::Scale, factor, node, -1);
+    }
+
+    int shift(int node, double offset, const Token& token) {
+        Node n = owner.nodes[node]; // копия: intern может перераспределить nodes
+        if (offset == 0.0) return node;
+        if (n.op == Op::Point) return owner.intern(Op::Point, checked(n.scalar + offset, token), -1, -1);
+        if (n.op == Op::Shift) return shift(n.left, checked(n.scalar + offset, token), token);
+        return owner.intern(Op::Shift, offset, node, -1);
+    }
+
+    int toNode(const Value& value) {
+        return value.isScalar ? owner.intern(Op::Point, value.scalar, -1, -1) : value.node;
+    }
+
+    Value add(const Value& a, const Value& b, const Token& token) {
+        if (a.isScalar && b.isScalar) return {true, checked(a.scalar + b.scalar, token), -1};
+        if (a.isScalar) return {false, 0.0, shift(b.node, a.scalar, token)};
+        if (b.isScalar) return {false, 0.0, shift(a.node, b.scalar, token)};
+        // Сумма коммутативна: порядок операндов не влияет на узел
+        return {false, 0.0, owner.intern(Op::Sum, 0.0, std::min(a.node, b.node), std::max(a.node, b.node))};
+    }
+
+    Value multiply(const Value& a, const Value& b, const Token& token) {
+        if (a.isScalar && b.isScalar) return {true, checked(a.scalar * b.scalar, token), -1};
+        if (a.isScalar) return {false, 0.0, scale(b.node, a.scalar, token)};
+        if (b.isScalar) return {false, 0.0, scale(a.node, b.scalar, token)};
+        return {false, 0.0, owner.intern(Op::Product, 0.0, std::min(a.node, b.node), std::max(a.node, b.node))};
+    }
+
+    Value negate(const Value& a, const Token& token) {
+        if (a.isScalar) return {true, -a.scalar, -1};
+        return {false, 0.0, scale(a.node, -1.0, token)};
+    }
+
+    Value unary() {
+        const Token& token = next();
+        if (token.kind == TokenKind::Symbol && token.symbol == '-') {
+            return negate(unary(), token);
+        }
+        if (token.kind == TokenKind::Number) {
+            return {true, token.number, -1};
+        }
+        if (token.kind == TokenKind::Identifier) {
+            std::string name = identifier(token);
+            auto it = names.find(name);
+            if (it == names.end()) {
+                throw std::invalid_argument("Unknown variable '" + name + "'" + location(token));
+            }
+            return {false, 0.0, it->second};
+        }
+        if (token.kind == TokenKind::Symbol && token.symbol == '(') {
+            Value value = expr();
+            expectSymbol(')');
+            return value;
+        }
+        throw std::invalid_argument("Expected expression" + location(token));
+    }
+
+    Value term() {
+        Value value = unary();
+        while (peek().kind == TokenKind::Symbol && peek().symbol == '*') {
+            const Token& token = next();
+            value = multiply(value, unary(), token);
+        }
+        return value;
+    }
+
+    Value expr() {
+        Value value = term();
+        while (peek().kind == TokenKind::Symbol && (peek().symbol == '+' || peek().symbol == '-')) {
+            const Token& token = next();
+            Value right = term();
+            value = add(value, token.symbol == '+' ? right : negate(right, token), token);
+        }
+        return value;
+    }
+
+    double scalarArgument() {
+        const Token& token = peek();
+        Value value = expr();
+        if (!value.isScalar) {
+            throw std::invalid_argument("Expected a number" + location(token));
+        }
+        return value.scalar;
+    }
+
+    void reportItem() {
+        const Token& token = next();
+        std::string name = token.kind == TokenKind::Identifier ? identifier(token) : std::string();
+        const RequestFunction* function = nullptr;
+        for (const auto& candidate : kRequestFunctions) {
+            if (name == candidate.name) function = &candidate;
+        }
+        if (!function) {
+            throw std::invalid_argument("Expected report function" + location(token));
+        }
+
+        expectSymbol('(');
+        Request request = {std::string(), function->kind, toNode(expr()), 0.0};
+        if (function->hasArgument) {
+            expectSymbol(',');
+            const Token& argumentToken = peek();
+            request.argument = scalarArgument();
+            if (function->kind == RequestKind::Quantile && !(request.argument >= 0.0 && request.argument <= 1.0)) {
+                throw std::invalid_argument("Quantile level must be in [0, 1]" + location(argumentToken));
+            }
+        }
+        expectSymbol(')');
+
+        request.text = text.substr(token.begin, tokens[position - 1].end - token.begin);
+        roots.push_back(request.node);
+        requests.push_back(std::move(request));
+    }
+
+    void statement() {
+        const Token& token = peek();
+        if (token.kind == TokenKind::Separator || token.kind == TokenKind::End) {
+            return;
+        }
+        if (token.kind != TokenKind::Identifier) {
+            throw std::invalid_argument("Expected statement" + location(token));
+        }
+
+        std::string name = identifier(token);
+        ++position;
+        if (name == "report") {
+            do {
+                reportItem();
+            } while (acceptSymbol(','));
+            return;
+        }
+
+        expectSymbol('=');
+        int node = toNode(expr());
+        names[name] = node;
+        roots.push_back(node);
+    }
+
+    void parse() {
+        for (;;) {
+            statement();
+            const Token& token = next();
+            if (token.kind == TokenKind::End) break;
+            if (token.kind != TokenKind::Separator) {
+                throw std::invalid_argument("Unexpected token" + location(token));
+            }
+        }
+    }
+};
+
+Evaluator::Evaluator() {}
+
+int Evaluator::intern(Op op, double scalar, int left, int right) {
+    scalar += 0.0; // -0 и 0 - один ключ
+    auto key = std::make_tuple(static_cast<int>(op), scalar, left, right);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        return it->second;
+    }
+    int id = static_cast<int>(nodes.size());
+    nodes.push_back({op, scalar, left, right});
+    index.emplace(key, id);
+    return id;
+}
+
+void Evaluator::bind(const std::string& name, DiscreteRandomVariable rv) {
+    if (!isValidName(name)) {
+        throw std::invalid_argument("Invalid variable name: " + name);
+    }
+    // Каждая привязка - новый лист графа, поэтому кеш старых выражений остается верным
+    int id = static_cast<int>(nodes.size());
+    nodes.push_back({Op::Variable, 0.0, -1, -1});
+    results.resize(nodes.size());
+    results[id] = std::make_shared<const DiscreteRandomVariable>(std::move(rv));
+    names[name] = id;
+}
+
+std::shared_ptr<const DiscreteRandomVariable> Evaluator::compute(const Node& node) const {
+    auto left = [&]() -> const DiscreteRandomVariable& { return *results[node.left]; };
+    switch (node.op) {
+        case Op::Point:
+            return std::make_shared<const DiscreteRandomVariable>(
+                std::vector<std::pair<double, double>>{{node.scalar, 1.0}});
+        case Op::Scale:
+            return std::make_shared<const DiscreteRandomVariable>(left() * node.scalar);
+        case Op::Shift: {
+            DiscreteRandomVariable point({{node.scalar, 1.0}});
+            return std::make_shared<const DiscreteRandomVariable>(left() + point);
+        }
+        case Op::Sum:
+            return std::make_shared<const DiscreteRandomVariable>(left() + *results[node.right]);
+        case Op::Product:
+            return std::make_shared<const DiscreteRandomVariable>(left() * *results[node.right]);
+        case Op::Variable:
+            break;
+    }
+    throw std::logic_error("Variable without a value");
+}
+
+void Evaluator::evaluate(const std::vector<int>& roots) {
+    results.resize(nodes.size());
+
+    // Невычисленные узлы, нужные корням
+    std::vector<char> needed(nodes.size(), 0);
+    std::vector<int> stack;
+    for (int root : roots) {
+        if (!results[root] && !needed[root]) {
+            needed[root] = 1;
+            stack.push_back(root);
+        }
+    }
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        for (int child : {node.left, node.right}) {
+            if (child >= 0 && !results[child] && !needed[child]) {
+                needed[child] = 1;
+                stack.push_back(child);
+            }
+        }
+    }
+
+    // Уровень узла - на единицу больше уровней его невычисленных операндов.
+    // Операнды создаются раньше узла, поэтому один проход по номерам.
+    std::vector<int> level(nodes.size(), 0);
+    std::vector<std::vector<int>> levels;
+    for (std::size_t id = 0; id < nodes.size(); ++id) {
+        if (!needed[id]) continue;
+        int depth = 0;
+        for (int child : {nodes[id].left, nodes[id].right}) {
+            if (child >= 0 && needed[child]) depth = std::max(depth, level[child] + 1);
+        }
+        level[id] = depth;
+        if (levels.size() <= static_cast<std::size_t>(depth)) levels.resize(depth + 1);
+        levels[depth].push_back(static_cast<int>(id));
+    }
+
+    for (const auto& ids : levels) {
+        parallelFor(ids.size(), 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t k = first; k < last; ++k) {
+                results[ids[k]] = compute(nodes[ids[k]]);
+            }
+        });
+    }
+}
+
+std::vector<ReportItem> Evaluator::run(const std::string& script) {
+    Parser parser(*this, script);
+    parser.parse();
+    names = std::move(parser.names);
+
+    evaluate(parser.roots);
+
+    const std::vector<Request>& requests = parser.requests;
+    std::vector<ReportItem> report(requests.size());
+    parallelFor(requests.size(), 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            const Request& request = requests[k];
+            const DiscreteRandomVariable& rv = *results[request.node];
+            ReportItem& item = report[k];
+            item.text = request.text;
+            switch (request.kind) {
+                case RequestKind::Moments: {
+                    DistributionMoments moments = rv.atoms().moments();
+                    item.values = {{"expectation", moments.expectation},
+                                   {"variance", moments.variance},
+                                   {"skewness", moments.skewness},
+                                   {"kurtosis", moments.kurtosis}};
+                    break;
+                }
+                case RequestKind::Expectation:
+                    item.values = {{"expectation", rv.expectation()}};
+                    break;
+                case RequestKind::Variance:
+                    item.values = {{"variance", rv.variance()}};
+                    break;
+                case RequestKind::StandardDeviation:
+                    item.values = {{"stddev", rv.standardDeviation()}};
+                    break;
+                case RequestKind::Skewness:
+                    item.values = {{"skewness", rv.skewness()}};
+                    break;
+                case RequestKind::Kurtosis:
+                    item.values = {{"kurtosis", rv.kurtosis()}};
+                    break;
+                case RequestKind::Atoms:
+                    item.values = {{"atoms", static_cast<double>(rv.atoms().size())}};
+                    break;
+                case RequestKind::Cdf:
+                    item.values = {{"cdf", rv.cdf(request.argument)}};
+                    break;
+                case RequestKind::Quantile:
+                    item.values = {{"quantile", rv.quantile(request.argument)}};
+                    break;
+            }
+        }
+    });
+    return report;
+}
+
+std::shared_ptr<const DiscreteRandomVariable> Evaluator::variable(const std::string& name) const {
+    auto it = names.find(name);
+    if (it == names.end() || static_cast<std::size_t>(it->second) >= results.size()) {
+        return nullptr;
+    }
+    return results[it->second];
+}
+
+std::size_t Evaluator::cachedResults() const {
+    return static_cast<std::size_t>(std::count_if(results.begin(), results.end(),
+                                                  [](const auto& result) { return result != nullptr; }));
+}
+
+void Evaluator::clearCache() {
+    for (std::size_t id = 0; id < results.size(); ++id) {
+        if (nodes[id].op != Op::Variable) results[id].reset();
+    }
+}
+
+}
@@ -0,0 +1,177 @@
+#include "../include/instrumentation.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Слот потока: пишет только владелец (load + store без блокировок),
+// читают снимки из других потоков
+struct ProbeSlot {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> items{0};
+    std::atomic<std::uint64_t> totalNanoseconds{0};
+    std::atomic<std::uint64_t> latency[instrumentation::kLatencyBuckets] = {};
+};
+
+struct ThreadSlot {
+    ProbeSlot probes[instrumentation::kProbeCount];
+};
+
+void bump(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// Слоты не удаляются: счетчики завершившихся потоков остаются в сумме,
+// а освободившийся слот получает следующий поток (число слотов ограничено
+// числом одновременных потоков)
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadSlot>> slots;
+    std::vector<ThreadSlot*> free;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+struct SlotHandle {
+    ThreadSlot* slot;
+
+    SlotHandle() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.free.empty()) {
+            slot = r.free.back();
+            r.free.pop_back();
+        } else {
+            r.slots.push_back(std::make_unique<ThreadSlot>());
+            slot = r.slots.back().get();
+        }
+    }
+
+    ~SlotHandle() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.free.push_back(slot);
+    }
+};
+
+std::size_t latencyBucket(std::uint64_t nanoseconds) {
+    std::size_t bucket = 0;
+    while (nanoseconds != 0 && bucket + 1 < instrumentation::kLatencyBuckets) {
+        nanoseconds >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+const char* const kProbeNames[instrumentation::kProbeCount] = {
+    "sum", "product", "scale", "validate", "moments", "cdf", "quantile", "serialize", "deserialize", "allocate"
+};
+
+#ifdef PTMS_ENABLE_INSTRUMENTATION
+// Учет выделений ресурса по умолчанию с момента загрузки программы. Ресурс
+// не разрушается: величины в статических объектах освобождают память позже.
+// Реестр создается первым, чтобы пережить выделения при завершении программы
+struct DefaultResourceCounter {
+    DefaultResourceCounter() {
+        registry();
+        static auto* counter = new instrumentation::CountingResource(std::pmr::get_default_resource());
+        std::pmr::set_default_resource(counter);
+    }
+};
+
+DefaultResourceCounter defaultResourceCounter;
+#endif
+
+}
+
+namespace instrumentation {
+
+bool enabled() {
+#ifdef PTMS_ENABLE_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* probeName(Probe probe) {
+    return kProbeNames[static_cast<std::size_t>(probe)];
+}
+
+void record(Probe probe, std::uint64_t items, std::uint64_t nanoseconds) {
+    // Реестр создается раньше первого слота и переживает все потоки
+    registry();
+    thread_local SlotHandle handle;
+    ProbeSlot& slot = handle.slot->probes[static_cast<std::size_t>(probe)];
+    bump(slot.calls, 1);
+    bump(slot.items, items);
+    bump(slot.totalNanoseconds, nanoseconds);
+    bump(slot.latency[latencyBucket(nanoseconds)], 1);
+}
+
+std::array<ProbeStats, kProbeCount> snapshot() {
+    std::array<ProbeStats, kProbeCount> result = {};
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& thread : r.slots) {
+        for (std::size_t p = 0; p < kProbeCount; ++p) {
+            const ProbeSlot& slot = thread->probes[p];
+            result[p].calls += slot.calls.load(std::memory_order_relaxed);
+            result[p].items += slot.items.load(std::memory_order_relaxed);
+            result[p].totalNanoseconds += slot.totalNanoseconds.load(std::memory_order_relaxed);
+            for (std::size_t b = 0; b < kLatencyBuckets; ++b) {
+                result[p].latency[b] += slot.latency[b].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return result;
+}
+
+std::string snapshotJSON() {
+    std::array<ProbeStats, kProbeCount> stats = snapshot();
+    std::string out = "{\"enabled\":";
+    out += enabled() ? "true" : "false";
+    out += ",\"probes\":{";
+    for (std::size_t p = 0; p < kProbeCount; ++p) {
+        if (p) out += ',';
+        out += '"';
+        out += kProbeNames[p];
+        out += "\":{\"calls\":" + std::to_string(stats[p].calls);
+        out += ",\"items\":" + std::to_string(stats[p].items);
+        out += ",\"totalNanoseconds\":" + std::to_string(stats[p].totalNanoseconds);
+        // Только непустые корзины: верхняя граница в наносекундах и число вызовов
+        out += ",\"latency\":[";
+        bool first = true;
+        for (std::size_t b = 0; b < kLatencyBuckets; ++b) {
+            if (stats[p].latency[b] == 0) continue;
+            if (!first) out += ',';
+            first = false;
+            out += "{\"lessThanNanoseconds\":";
+            out += b + 1 < kLatencyBuckets ? std::to_string(std::uint64_t(1) << b) : std::string("null");
+            out += ",\"count\":" + std::to_string(stats[p].latency[b]) + '}';
+        }
+        out += "]}";
+    }
+    out += "}}";
+    return out;
+}
+
+void reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& thread : r.slots) {
+        for (auto& slot : thread->probes) {
+            slot.calls.store(0, std::memory_order_relaxed);
+            slot.items.store(0, std::memory_order_relaxed);
+            slot.totalNanoseconds.store(0, std::memory_order_relaxed);
+            for (auto& bucket : slot.latency) bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+}
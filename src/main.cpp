@@ -1,8 +1,19 @@
 #include "visualizer.h"
 #include "random_variable.h"
+#include "tracing.h"
+#include <cstdlib>
 #include <iostream>
 
 int main() {
+    // Трассировка кадров: PTMS_TRACE=путь к файлу trace_event
+    if (const char* tracePath = std::getenv("PTMS_TRACE")) {
+        try {
+            tracing::start(tracePath);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
     Visualizer visualizer;
     
     if (!visualizer.initialize(800, 600, "Discrete Random Variable Visualizer")) {
@@ -37,9 +48,15 @@ int main() {
     
     std::cout << "\nControls:" << std::endl;
     std::cout << "SPACE - Change view mode" << std::endl;
+    std::cout << "Mouse wheel - Zoom" << std::endl;
     std::cout << "ESC - Exit" << std::endl;
     
     visualizer.run();
-    
+
+    try {
+        tracing::stop();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
     return 0;
 }
\ No newline at end of file
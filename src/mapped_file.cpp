@@ -0,0 +1,110 @@
+#include "../include/mapped_file.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Отображает файл целиком; возвращает nullptr для пустого файла
+void* mapFile(const std::string& path, std::size_t& size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+    if (size == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mappingHandle) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mappingHandle);
+    if (!data) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    return data;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // отображение остается действительным после закрытия дескриптора
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    return data;
+#endif
+}
+
+void unmapFile(void* data, std::size_t size) {
+    if (!data) return;
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+}
+
+MappedFile::MappedFile() : mapping(nullptr), mappingSize(0) {}
+
+MappedFile::MappedFile(const std::string& path) : mapping(nullptr), mappingSize(0) {
+    mapping = mapFile(path, mappingSize);
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : mapping(other.mapping), mappingSize(other.mappingSize) {
+    other.mapping = nullptr;
+    other.mappingSize = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        mapping = other.mapping;
+        mappingSize = other.mappingSize;
+        other.mapping = nullptr;
+        other.mappingSize = 0;
+    }
+    return *this;
+}
+
+void MappedFile::unmap() {
+    unmapFile(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+}
@@ -0,0 +1,363 @@
+#include "../include/metrics.h"
+#include "../include/lane_math.h"
+#include "../include/parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Обход объединения носителей по возрастанию: visit(value, p, q, F, G), где p и q -
+// вероятности значения (0, если его нет в носителе), F и G - функции распределения
+// в этой точке, взятые из сохраненных префиксных сумм
+template <typename Visit>
+void mergeSupports(const DiscreteRandomVariable& a, const DiscreteRandomVariable& b, Visit visit) {
+    AtomSpan left = a.atoms();
+    AtomSpan right = b.atoms();
+    const double* leftCdf = a.cumulativeProbabilities();
+    const double* rightCdf = b.cumulativeProbabilities();
+
+    std::size_t i = 0, j = 0;
+    double leftF = 0.0, rightF = 0.0;
+    while (i < left.size() || j < right.size()) {
+        double value, p = 0.0, q = 0.0;
+        if (j == right.size() || (i < left.size() && left[i].first < right[j].first)) {
+            value = left[i].first;
+            p = left[i].second;
+            leftF = leftCdf[i++];
+        } else if (i == left.size() || right[j].first < left[i].first) {
+            value = right[j].first;
+            q = right[j].second;
+            rightF = rightCdf[j++];
+        } else {
+            value = left[i].first;
+            p = left[i].second;
+            q = right[j].second;
+            leftF = leftCdf[i++];
+            rightF = rightCdf[j++];
+        }
+        visit(value, p, q, leftF, rightF);
+    }
+}
+
+// Мера по вероятностям (энтропия, KL, JS, TV) - сумма слагаемых term(p, q).
+// На участках, где значения обоих носителей совпадают подряд (общая решетка),
+// слагаемые считаются пакетами по kLanes в kLanes независимых суммах: цикл без
+// ветвлений с логарифмом lane_math векторизуется. Слагаемые, для которых ядро
+// неприменимо (нулевые вероятности, q = 0 в KL), пересчитываются exact(p, q).
+// Точки только одного носителя и хвосты участков складываются по одной.
+// KS и W1 остаются скалярными: они идут по функциям распределения слиянием,
+// а максимум с NaN-семантикой std::max компилятор без -ffast-math не векторизует.
+const std::size_t kLanes = 8;
+
+using Atom = AtomSpan::Atom;
+
+struct LaneSums {
+    double lanes[kLanes] = {};
+    double rest = 0.0;
+
+    double total() const {
+        double result = rest;
+        for (double lane : lanes) result += lane;
+        return result;
+    }
+};
+
+// kernel(p, q, slow) - быстрое слагаемое; старший бит slow - пересчитать через exact
+template <typename Kernel, typename Exact>
+void accumulateRun(const Atom* left, const Atom* right, std::size_t count, LaneSums& sums, Kernel kernel,
+                   Exact exact) {
+    std::size_t k = 0;
+    for (; k + kLanes <= count; k += kLanes) {
+        // Вероятности из пар (значение, вероятность) - в плотные массивы пакета
+        double p[kLanes], q[kLanes];
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            p[l] = left[k + l].second;
+            q[l] = right[k + l].second;
+        }
+        double term[kLanes];
+        std::uint64_t slow[kLanes];
+        std::uint64_t anySlow = 0;
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            term[l] = kernel(p[l], q[l], slow[l]);
+            anySlow |= slow[l];
+        }
+        if (anySlow >> 63) {
+            for (std::size_t l = 0; l < kLanes; ++l) {
+                if (slow[l] >> 63) term[l] = exact(p[l], q[l]);
+            }
+        }
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            sums.lanes[l] += term[l];
+        }
+    }
+    for (; k < count; ++k) {
+        sums.rest += exact(left[k].second, right[k].second);
+    }
+}
+
+// Сумма term(p, q) по объединению носителей (p или q = 0 вне своего носителя)
+template <typename Kernel, typename Exact>
+double sumOverSupports(const DiscreteRandomVariable& a, const DiscreteRandomVariable& b, Kernel kernel, Exact exact) {
+    AtomSpan left = a.atoms();
+    AtomSpan right = b.atoms();
+    LaneSums sums;
+    std::size_t i = 0, j = 0;
+    while (i < left.size() || j < right.size()) {
+        if (j == right.size() || (i < left.size() && left[i].first < right[j].first)) {
+            sums.rest += exact(left[i++].second, 0.0);
+        } else if (i == left.size() || right[j].first < left[i].first) {
+            sums.rest += exact(0.0, right[j++].second);
+        } else {
+            std::size_t length = 1;
+            while (i + length < left.size() && j + length < right.size() &&
+                   left[i + length].first == right[j + length].first) {
+                ++length;
+            }
+            if (length < kLanes) {
+                for (std::size_t end = i + length; i < end; ++i, ++j) {
+                    sums.rest += exact(left[i].second, right[j].second);
+                }
+                continue;
+            }
+            accumulateRun(left.data() + i, right.data() + j, length, sums, kernel, exact);
+            i += length;
+            j += length;
+        }
+    }
+    return sums.total();
+}
+
+// Сторона плитки: 64 x 64 пары распределений обрабатываются, пока обе группы в кеше
+const std::size_t kTile = 64;
+// Относительный запас нижней оценки при отсечении кандидатов
+const double kBoundSlack = 1e-9;
+
+bool closer(const metrics::Neighbor& a, const metrics::Neighbor& b) {
+    return a.distance < b.distance || (a.distance == b.distance && a.index < b.index);
+}
+
+std::vector<std::vector<metrics::Neighbor>> topK(metrics::Metric metric,
+                                                 const std::vector<DiscreteRandomVariable>& queries,
+                                                 const std::vector<DiscreteRandomVariable>& catalog,
+                                                 std::size_t k, bool excludeSelf) {
+    std::vector<std::vector<metrics::Neighbor>> result(queries.size());
+    if (k == 0 || catalog.empty()) {
+        return result;
+    }
+
+    // W1 >= |E[p] - E[q]|: дешевая нижняя оценка, позволяющая пропускать кандидатов
+    bool useBound = metric == metrics::Metric::Wasserstein;
+    std::vector<double> queryMeans, catalogMeans;
+    if (useBound) {
+        queryMeans.reserve(queries.size());
+        for (const auto& rv : queries) queryMeans.push_back(rv.expectation());
+        catalogMeans.reserve(catalog.size());
+        for (const auto& rv : catalog) catalogMeans.push_back(rv.expectation());
+    }
+
+    std::size_t tiles = (queries.size() + kTile - 1) / kTile;
+    parallelFor(tiles, 1, [&](std::size_t firstTile, std::size_t lastTile) {
+        for (std::size_t tile = firstTile; tile < lastTile; ++tile) {
+            std::size_t queryBegin = tile * kTile;
+            std::size_t queryEnd = std::min(queryBegin + kTile, queries.size());
+
+            for (std::size_t candidateBegin = 0; candidateBegin < catalog.size(); candidateBegin += kTile) {
+                std::size_t candidateEnd = std::min(candidateBegin + kTile, catalog.size());
+                for (std::size_t q = queryBegin; q < queryEnd; ++q) {
+                    // Куча с худшим из найденных соседей на вершине
+                    std::vector<metrics::Neighbor>& heap = result[q];
+                    for (std::size_t c = candidateBegin; c < candidateEnd; ++c) {
+                        if (excludeSelf && c == q) continue;
+                        bool full = heap.size() == k;
+                        if (full && useBound) {
+                            // Запас на округление: посчитанное W1 может оказаться чуть меньше оценки
+                            double bound = std::abs(queryMeans[q] - catalogMeans[c]);
+                            if (bound - heap.front().distance > kBoundSlack * (bound + heap.front().distance)) {
+                                continue;
+                            }
+                        }
+
+                        metrics::Neighbor candidate = {c, metrics::distance(metric, queries[q], catalog[c])};
+                        if (!full) {
+                            heap.push_back(candidate);
+                            std::push_heap(heap.begin(), heap.end(), closer);
+                        } else if (closer(candidate, heap.front())) {
+                            std::pop_heap(heap.begin(), heap.end(), closer);
+                            heap.back() = candidate;
+                            std::push_heap(heap.begin(), heap.end(), closer);
+                        }
+                    }
+                }
+            }
+
+            for (std::size_t q = queryBegin; q < queryEnd; ++q) {
+                std::sort_heap(result[q].begin(), result[q].end(), closer);
+            }
+        }
+    });
+    return result;
+}
+
+// p log(p / q) с соглашением 0 log 0 = 0
+double relativeTerm(double p, double q) {
+    if (p == 0.0) return 0.0;
+    return p * std::log(p / q);
+}
+
+}
+
+namespace metrics {
+
+double entropy(const DiscreteRandomVariable& rv) {
+    // Участок величины с самой собой; q не используется
+    AtomSpan atoms = rv.atoms();
+    LaneSums sums;
+    accumulateRun(atoms.data(), atoms.data(), atoms.size(), sums,
+        [](double p, double, std::uint64_t& slow) {
+            slow = lane_math::notPositiveNormal(p);
+            return -p * lane_math::log(p);
+        },
+        [](double p, double) { return p > 0.0 ? -p * std::log(p) : 0.0; });
+    return sums.total();
+}
+
+double klDivergence(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q) {
+    return sumOverSupports(p, q,
+        [](double pv, double qv, std::uint64_t& slow) {
+            double ratio = pv / qv;
+            slow = lane_math::notPositiveNormal(ratio);
+            return pv * lane_math::log(ratio);
+        },
+        [](double pv, double qv) {
+            // p > 0 там, где q = 0: бесконечность поглощает остальные слагаемые
+            if (pv > 0.0 && qv == 0.0) return std::numeric_limits<double>::infinity();
+            return relativeTerm(pv, qv);
+        });
+}
+
+double jensenShannonDivergence(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q) {
+    return sumOverSupports(p, q,
+        [](double pv, double qv, std::uint64_t& slow) {
+            double m = 0.5 * (pv + qv);
+            double left = pv / m;
+            double right = qv / m;
+            slow = lane_math::notPositiveNormal(left) | lane_math::notPositiveNormal(right);
+            return 0.5 * (pv * lane_math::log(left) + qv * lane_math::log(right));
+        },
+        [](double pv, double qv) {
+            double m = 0.5 * (pv + qv);
+            return 0.5 * (relativeTerm(pv, m) + relativeTerm(qv, m));
+        });
+}
+
+double totalVariationDistance(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q) {
+    double result = sumOverSupports(p, q,
+        [](double pv, double qv, std::uint64_t& slow) {
+            slow = 0;
+            return std::abs(pv - qv);
+        },
+        [](double pv, double qv) { return std::abs(pv - qv); });
+    return 0.5 * result;
+}
+
+double kolmogorovSmirnovDistance(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q) {
+    // Разность функций распределения постоянна между точками носителя
+    double result = 0.0;
+    mergeSupports(p, q, [&](double, double, double, double f, double g) {
+        result = std::max(result, std::abs(f - g));
+    });
+    return result;
+}
+
+double wassersteinDistance(const DiscreteRandomVariable& p, const DiscreteRandomVariable& q) {
+    double result = 0.0;
+    double previousValue = 0.0;
+    double previousGap = 0.0; // |F - G| на интервале до текущей точки
+    mergeSupports(p, q, [&](double value, double, double, double f, double g) {
+        result += previousGap * (value - previousValue);
+        previousValue = value;
+        previousGap = std::abs(f - g);
+    });
+    return result;
+}
+
+double distance(Metric metric, const DiscreteRandomVariable& p, const DiscreteRandomVariable& q) {
+    switch (metric) {
+        case Metric::TotalVariation: return totalVariationDistance(p, q);
+        case Metric::KolmogorovSmirnov: return kolmogorovSmirnovDistance(p, q);
+        case Metric::Wasserstein: return wassersteinDistance(p, q);
+    }
+    throw std::invalid_argument("Unknown metric");
+}
+
+std::vector<double> distanceMatrix(Metric metric, const std::vector<DiscreteRandomVariable>& rows,
+                                   const std::vector<DiscreteRandomVariable>& columns) {
+    std::size_t n = rows.size();
+    std::size_t m = columns.size();
+    std::vector<double> result(n * m);
+
+    std::size_t rowTiles = (n + kTile - 1) / kTile;
+    parallelFor(rowTiles, 1, [&](std::size_t firstTile, std::size_t lastTile) {
+        for (std::size_t tile = firstTile; tile < lastTile; ++tile) {
+            std::size_t rowEnd = std::min((tile + 1) * kTile, n);
+            for (std::size_t columnBegin = 0; columnBegin < m; columnBegin += kTile) {
+                std::size_t columnEnd = std::min(columnBegin + kTile, m);
+                for (std::size_t i = tile * kTile; i < rowEnd; ++i) {
+                    for (std::size_t j = columnBegin; j < columnEnd; ++j) {
+                        result[i * m + j] = distance(metric, rows[i], columns[j]);
+                    }
+                }
+            }
+        }
+    });
+    return result;
+}
+
+std::vector<double> distanceMatrix(Metric metric, const std::vector<DiscreteRandomVariable>& catalog) {
+    std::size_t n = catalog.size();
+    std::vector<double> result(n * n, 0.0);
+
+    // Пары плиток верхнего треугольника; их стоимость почти одинакова,
+    // поэтому непрерывные диапазоны пар равномерно делятся между потоками
+    std::size_t tiles = (n + kTile - 1) / kTile;
+    std::vector<std::pair<std::size_t, std::size_t>> tilePairs;
+    tilePairs.reserve(tiles * (tiles + 1) / 2);
+    for (std::size_t a = 0; a < tiles; ++a) {
+        for (std::size_t b = a; b < tiles; ++b) {
+            tilePairs.push_back({a, b});
+        }
+    }
+
+    parallelFor(tilePairs.size(), 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            std::size_t rowBegin = tilePairs[k].first * kTile;
+            std::size_t rowEnd = std::min(rowBegin + kTile, n);
+            std::size_t columnBegin = tilePairs[k].second * kTile;
+            std::size_t columnEnd = std::min(columnBegin + kTile, n);
+            for (std::size_t i = rowBegin; i < rowEnd; ++i) {
+                for (std::size_t j = std::max(columnBegin, i + 1); j < columnEnd; ++j) {
+                    double d = distance(metric, catalog[i], catalog[j]);
+                    result[i * n + j] = d;
+                    result[j * n + i] = d;
+                }
+            }
+        }
+    });
+    return result;
+}
+
+std::vector<std::vector<Neighbor>> nearestNeighbors(Metric metric, const std::vector<DiscreteRandomVariable>& queries,
+                                                    const std::vector<DiscreteRandomVariable>& catalog, std::size_t k) {
+    return topK(metric, queries, catalog, k, false);
+}
+
+std::vector<std::vector<Neighbor>> nearestNeighbors(Metric metric, const std::vector<DiscreteRandomVariable>& catalog,
+                                                    std::size_t k) {
+    return topK(metric, catalog, catalog, k, true);
+}
+
+}
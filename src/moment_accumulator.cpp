@@ -0,0 +1,177 @@
+#include "../include/moment_accumulator.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// Размер блока: блок целиком лежит в L1, поэтому два прохода по нему почти бесплатны
+const std::size_t kBlockSize = 1024;
+
+}
+
+MomentAccumulator::MomentAccumulator() : n(0), weight(0.0), mean(0.0), m2(0.0), m3(0.0), m4(0.0) {}
+
+void MomentAccumulator::add(double x) {
+    double w1 = weight;
+    n += 1;
+    weight += 1.0;
+    double delta = x - mean;
+    double deltaN = delta / weight;
+    double deltaN2 = deltaN * deltaN;
+    double term1 = delta * deltaN * w1;
+
+    mean += deltaN;
+    m4 += term1 * deltaN2 * (weight * weight - 3.0 * weight + 3.0)
+        + 6.0 * deltaN2 * m2 - 4.0 * deltaN * m3;
+    m3 += term1 * deltaN * (weight - 2.0) - 3.0 * deltaN * m2;
+    m2 += term1;
+}
+
+void MomentAccumulator::addBlock(const double* data, std::size_t count) {
+    // Первый проход: среднее блока (четыре независимых аккумулятора для векторизации)
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        s0 += data[i];
+        s1 += data[i + 1];
+        s2 += data[i + 2];
+        s3 += data[i + 3];
+    }
+    for (; i < count; ++i) {
+        s0 += data[i];
+    }
+    double blockMean = (s0 + s1 + s2 + s3) / static_cast<double>(count);
+
+    // Второй проход: центральные суммы блока
+    double c2 = 0.0, c3 = 0.0, c4 = 0.0;
+    for (i = 0; i < count; ++i) {
+        double d = data[i] - blockMean;
+        double d2 = d * d;
+        c2 += d2;
+        c3 += d2 * d;
+        c4 += d2 * d2;
+    }
+
+    MomentAccumulator block;
+    block.n = count;
+    block.weight = static_cast<double>(count);
+    block.mean = blockMean;
+    block.m2 = c2;
+    block.m3 = c3;
+    block.m4 = c4;
+    merge(block);
+}
+
+void MomentAccumulator::addBlock(const std::pair<double, double>* atoms, std::size_t count) {
+    double blockWeight = 0.0;
+    double weightedSum = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        blockWeight += atoms[i].second;
+        weightedSum += atoms[i].first * atoms[i].second;
+    }
+    if (blockWeight <= 0.0) return;
+    double blockMean = weightedSum / blockWeight;
+
+    double c2 = 0.0, c3 = 0.0, c4 = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        double d = atoms[i].first - blockMean;
+        double d2 = d * d;
+        double p = atoms[i].second;
+        c2 += p * d2;
+        c3 += p * d2 * d;
+        c4 += p * d2 * d2;
+    }
+
+    MomentAccumulator block;
+    block.n = count;
+    block.weight = blockWeight;
+    block.mean = blockMean;
+    block.m2 = c2;
+    block.m3 = c3;
+    block.m4 = c4;
+    merge(block);
+}
+
+void MomentAccumulator::add(const double* data, std::size_t count) {
+    for (std::size_t offset = 0; offset < count; offset += kBlockSize) {
+        addBlock(data + offset, std::min(kBlockSize, count - offset));
+    }
+}
+
+void MomentAccumulator::add(const std::vector<double>& data) {
+    add(data.data(), data.size());
+}
+
+void MomentAccumulator::add(AtomSpan atoms) {
+    for (std::size_t offset = 0; offset < atoms.size(); offset += kBlockSize) {
+        addBlock(atoms.data() + offset, std::min(kBlockSize, atoms.size() - offset));
+    }
+}
+
+void MomentAccumulator::merge(const MomentAccumulator& other) {
+    if (other.weight == 0.0) return;
+    if (weight == 0.0) {
+        *this = other;
+        return;
+    }
+
+    double na = weight;
+    double nb = other.weight;
+    double total = na + nb;
+    double delta = other.mean - mean;
+    double delta2 = delta * delta;
+
+    // Формулы Пебая для попарного объединения центральных моментов
+    double newM2 = m2 + other.m2 + delta2 * na * nb / total;
+    double newM3 = m3 + other.m3
+        + delta2 * delta * na * nb * (na - nb) / (total * total)
+        + 3.0 * delta * (na * other.m2 - nb * m2) / total;
+    double newM4 = m4 + other.m4
+        + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (total * total * total)
+        + 6.0 * delta2 * (na * na * other.m2 + nb * nb * m2) / (total * total)
+        + 4.0 * delta * (na * other.m3 - nb * m3) / total;
+
+    n += other.n;
+    weight = total;
+    mean += delta * nb / total;
+    m2 = newM2;
+    m3 = newM3;
+    m4 = newM4;
+}
+
+void MomentAccumulator::reset() {
+    *this = MomentAccumulator();
+}
+
+std::uint64_t MomentAccumulator::count() const {
+    return n;
+}
+
+double MomentAccumulator::totalWeight() const {
+    return weight;
+}
+
+double MomentAccumulator::expectation() const {
+    return mean;
+}
+
+double MomentAccumulator::variance() const {
+    if (weight == 0.0) return 0.0;
+    return m2 / weight;
+}
+
+double MomentAccumulator::standardDeviation() const {
+    return std::sqrt(variance());
+}
+
+double MomentAccumulator::skewness() const {
+    double stdDev = standardDeviation();
+    if (stdDev == 0) return 0.0;
+    return (m3 / weight) / (stdDev * stdDev * stdDev);
+}
+
+double MomentAccumulator::kurtosis() const {
+    double var = variance();
+    if (var == 0) return 0.0;
+    return (m4 / weight) / (var * var) - 3.0; // Excess kurtosis
+}
@@ -0,0 +1,138 @@
+#include "../include/moment_algebra.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Среднее и центральные моменты c[k] = E[(X - mean)^k], c[0] = 1, c[1] = 0
+struct CentralMoments {
+    double mean;
+    double c[5];
+};
+
+CentralMoments fromAtoms(AtomSpan atoms) {
+    if (atoms.empty()) {
+        throw std::invalid_argument("Distribution cannot be empty");
+    }
+    double mean = atoms.expectation();
+    double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+    for (const auto& atom : atoms) {
+        double d = atom.first - mean;
+        double d2 = d * d;
+        m2 += d2 * atom.second;
+        m3 += d2 * d * atom.second;
+        m4 += d2 * d2 * atom.second;
+    }
+    return {mean, {1.0, 0.0, m2, m3, m4}};
+}
+
+CentralMoments fromMoments(const DistributionMoments& moments) {
+    double var = moments.variance;
+    double c3 = moments.skewness * var * std::sqrt(var);
+    double c4 = (moments.kurtosis + 3.0) * var * var;
+    if (var == 0.0) {
+        c3 = 0.0;
+        c4 = 0.0;
+    }
+    return {moments.expectation, {1.0, 0.0, var, c3, c4}};
+}
+
+DistributionMoments toMoments(const CentralMoments& m) {
+    DistributionMoments result = {m.mean, m.c[2], 0.0, 0.0};
+    if (m.c[2] > 0) {
+        result.skewness = m.c[3] / (m.c[2] * std::sqrt(m.c[2]));
+        result.kurtosis = m.c[4] / (m.c[2] * m.c[2]) - 3.0;
+    }
+    return result;
+}
+
+// Кумулянты k2 = c2, k3 = c3, k4 = c4 - 3 c2^2 складываются;
+// для c4 это c4(a) + c4(b) + 6 c2(a) c2(b)
+CentralMoments sum(const CentralMoments& a, const CentralMoments& b) {
+    return {a.mean + b.mean,
+            {1.0, 0.0, a.c[2] + b.c[2], a.c[3] + b.c[3], a.c[4] + b.c[4] + 6.0 * a.c[2] * b.c[2]}};
+}
+
+CentralMoments sumIid(const CentralMoments& m, std::uint64_t n) {
+    double count = static_cast<double>(n);
+    double k4 = m.c[4] - 3.0 * m.c[2] * m.c[2];
+    double c2 = count * m.c[2];
+    return {count * m.mean, {1.0, 0.0, c2, count * m.c[3], count * k4 + 3.0 * c2 * c2}};
+}
+
+// XY - mx my = Dx Y + mx Dy, где Dx = X - mx, Dy = Y - my; по независимости
+// E[(XY - mx my)^k] = sum_j C(k, j) cx[j] mx^(k-j) E[Y^j Dy^(k-j)],
+// E[Y^j Dy^m] = sum_i C(j, i) my^(j-i) cy[i+m]
+CentralMoments product(const CentralMoments& x, const CentralMoments& y) {
+    static const double binomial[5][5] = {
+        {1, 0, 0, 0, 0},
+        {1, 1, 0, 0, 0},
+        {1, 2, 1, 0, 0},
+        {1, 3, 3, 1, 0},
+        {1, 4, 6, 4, 1},
+    };
+    double powX[5] = {1.0, x.mean, x.mean * x.mean, x.mean * x.mean * x.mean, x.mean * x.mean * x.mean * x.mean};
+    double powY[5] = {1.0, y.mean, y.mean * y.mean, y.mean * y.mean * y.mean, y.mean * y.mean * y.mean * y.mean};
+
+    CentralMoments result = {x.mean * y.mean, {1.0, 0.0, 0.0, 0.0, 0.0}};
+    for (int k = 2; k <= 4; ++k) {
+        double total = 0.0;
+        for (int j = 0; j <= k; ++j) {
+            double mixed = 0.0;
+            for (int i = 0; i <= j; ++i) {
+                mixed += binomial[j][i] * powY[j - i] * y.c[i + k - j];
+            }
+            total += binomial[k][j] * x.c[j] * powX[k - j] * mixed;
+        }
+        result.c[k] = total;
+    }
+    return result;
+}
+
+}
+
+DistributionMoments momentsOfSum(AtomSpan a, AtomSpan b) {
+    return toMoments(sum(fromAtoms(a), fromAtoms(b)));
+}
+
+DistributionMoments momentsOfSum(const DistributionMoments& a, const DistributionMoments& b) {
+    return toMoments(sum(fromMoments(a), fromMoments(b)));
+}
+
+DistributionMoments momentsOfSum(const std::vector<AtomSpan>& operands) {
+    if (operands.empty()) {
+        throw std::invalid_argument("At least one operand is required");
+    }
+    CentralMoments total = fromAtoms(operands[0]);
+    for (std::size_t i = 1; i < operands.size(); ++i) {
+        total = sum(total, fromAtoms(operands[i]));
+    }
+    return toMoments(total);
+}
+
+DistributionMoments momentsOfSumIid(AtomSpan atoms, std::uint64_t n) {
+    return toMoments(sumIid(fromAtoms(atoms), n));
+}
+
+DistributionMoments momentsOfSumIid(const DistributionMoments& moments, std::uint64_t n) {
+    return toMoments(sumIid(fromMoments(moments), n));
+}
+
+DistributionMoments momentsOfProduct(AtomSpan a, AtomSpan b) {
+    return toMoments(product(fromAtoms(a), fromAtoms(b)));
+}
+
+DistributionMoments momentsOfProduct(const DistributionMoments& a, const DistributionMoments& b) {
+    return toMoments(product(fromMoments(a), fromMoments(b)));
+}
+
+DistributionMoments momentsOfProduct(const std::vector<AtomSpan>& operands) {
+    if (operands.empty()) {
+        throw std::invalid_argument("At least one operand is required");
+    }
+    CentralMoments total = fromAtoms(operands[0]);
+    for (std::size_t i = 1; i < operands.size(); ++i) {
+        total = product(total, fromAtoms(operands[i]));
+    }
+    return toMoments(total);
+}
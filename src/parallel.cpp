@@ -0,0 +1,152 @@
+#include "../include/parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Один вызов parallelFor: диапазоны разбираются по номеру через next
+struct Job {
+    const std::function<void(std::size_t begin, std::size_t end)>* body;
+    std::size_t step;
+    std::size_t extra;
+    std::size_t chunks;
+    std::atomic<std::size_t> next{0};
+    std::size_t finished = 0; // далее - под mutex пула
+    std::size_t users = 0;    // рабочие потоки, взявшие задание
+    std::exception_ptr error;
+
+    std::size_t begin(std::size_t chunk) const { return chunk * step + std::min(chunk, extra); }
+};
+
+// Потоки создаются при первом параллельном вызове и живут до конца программы.
+// Вызывающий поток сам разбирает диапазоны своего задания, поэтому вложенный
+// parallelFor (из тела другого) не ждет занятых потоков и не блокируется.
+class ThreadPool {
+private:
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable jobDone;
+    std::deque<Job*> jobs;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    void work(Job& job) {
+        for (;;) {
+            std::size_t chunk = job.next.fetch_add(1);
+            if (chunk >= job.chunks) return;
+
+            std::exception_ptr error;
+            try {
+                (*job.body)(job.begin(chunk), job.begin(chunk + 1));
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (error && !job.error) job.error = error;
+            if (++job.finished == job.chunks) jobDone.notify_all();
+        }
+    }
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            workReady.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            Job* job = jobs.front();
+            if (job->next.load() >= job->chunks) {
+                jobs.pop_front(); // все диапазоны уже разобраны
+                continue;
+            }
+            ++job->users;
+            lock.unlock();
+            work(*job);
+            lock.lock();
+            if (--job->users == 0) jobDone.notify_all();
+        }
+    }
+
+public:
+    explicit ThreadPool(unsigned threads) {
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([this]() { loop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void run(Job& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(&job);
+        }
+        workReady.notify_all();
+        work(job);
+
+        // Задание живет на стеке вызывающего: ждем, пока его не отпустят все потоки
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = std::find(jobs.begin(), jobs.end(), &job);
+        if (it != jobs.end()) jobs.erase(it);
+        jobDone.wait(lock, [&job]() { return job.finished == job.chunks && job.users == 0; });
+    }
+};
+
+ThreadPool& pool() {
+    // Вызывающий поток работает наравне с пулом
+    static ThreadPool instance(hardwareThreads() - 1);
+    return instance;
+}
+
+}
+
+unsigned hardwareThreads() {
+    static const unsigned threads = []() {
+        // Неверное или слишком большое значение не учитывается
+        if (const char* text = std::getenv("PTMS_THREADS")) {
+            char* end = nullptr;
+            unsigned long value = std::strtoul(text, &end, 10);
+            if (end != text && *end == '\0' && value > 0 && value <= 1024) return static_cast<unsigned>(value);
+        }
+        unsigned detected = std::thread::hardware_concurrency();
+        return detected == 0 ? 1u : detected;
+    }();
+    return threads;
+}
+
+void parallelFor(std::size_t count, std::size_t minChunk,
+                 const std::function<void(std::size_t begin, std::size_t end)>& body) {
+    if (count == 0) return;
+
+    // Округление вниз: каждый диапазон не короче minChunk
+    std::size_t chunks = std::min<std::size_t>(hardwareThreads(), count / std::max<std::size_t>(minChunk, 1));
+    if (chunks <= 1) {
+        body(0, count);
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    job.step = count / chunks;
+    job.extra = count % chunks;
+    job.chunks = chunks;
+    pool().run(job);
+
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
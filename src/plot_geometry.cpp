@@ -0,0 +1,122 @@
+#include "../include/plot_geometry.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace plot_geometry {
+
+std::pair<double, double> valueRange(const DiscreteRandomVariable& rv) {
+    AtomSpan atoms = rv.atoms();
+    if (atoms.empty()) return {0.0, 1.0};
+
+    // Атомы упорядочены по значению: крайние значения - первый и последний
+    double minVal = atoms[0].first;
+    double maxVal = atoms[atoms.size() - 1].first;
+
+    double range = maxVal - minVal;
+    if (range == 0) range = 1.0;
+
+    return {minVal - range * 0.1, maxVal + range * 0.1};
+}
+
+std::pair<double, double> probabilityRange(const DiscreteRandomVariable& rv) {
+    AtomSpan atoms = rv.atoms();
+    if (atoms.empty()) return {0.0, 1.0};
+
+    double maxProb = 0.0;
+    for (const auto& atom : atoms) {
+        maxProb = std::max(maxProb, atom.second);
+    }
+    return {0.0, maxProb * 1.1};
+}
+
+PlotGeometry build(const DiscreteRandomVariable& rv) {
+    auto range = valueRange(rv);
+    return build(rv, {range.first, range.second, 0});
+}
+
+PlotGeometry build(const DiscreteRandomVariable& rv, const PlotViewport& viewport) {
+    double width = viewport.maxValue - viewport.minValue;
+    if (!(width > 0)) {
+        throw std::invalid_argument("Plot viewport must have positive width");
+    }
+
+    PlotGeometry geometry;
+    AtomSpan atoms = rv.atoms();
+    if (atoms.empty()) return geometry;
+    const double* cumulative = rv.cumulativeProbabilities();
+
+    using Atom = std::pair<double, double>;
+    std::size_t first = std::lower_bound(atoms.begin(), atoms.end(), viewport.minValue,
+                                         [](const Atom& atom, double value) { return atom.first < value; }) -
+                        atoms.begin();
+    std::size_t last = std::upper_bound(atoms.begin(), atoms.end(), viewport.maxValue,
+                                        [](double value, const Atom& atom) { return value < atom.first; }) -
+                       atoms.begin();
+
+    // Функция распределения слева и справа от видимой части
+    float before = first > 0 ? static_cast<float>(cumulative[first - 1] * 0.8) : 0.0f;
+    float after = last > 0 ? static_cast<float>(cumulative[last - 1] * 0.8) : 0.0f;
+    geometry.cdf.push_back({0.0f, before});
+    if (first == last) {
+        geometry.cdf.push_back({1.0f, after});
+        return geometry;
+    }
+
+    double maxProb = 0.0;
+    for (std::size_t i = first; i < last; ++i) {
+        maxProb = std::max(maxProb, atoms[i].second);
+    }
+    double yScale = 0.8 / (maxProb * 1.1);
+
+    std::size_t columns = viewport.columns;
+    bool decimate = columns > 0 && last - first > columns;
+    auto columnOf = [&](double value) {
+        auto column = static_cast<std::size_t>((value - viewport.minValue) / width * static_cast<double>(columns));
+        return std::min(column, columns - 1);
+    };
+
+    std::size_t groups = decimate ? columns : last - first;
+    geometry.stems.reserve(2 * groups);
+    geometry.points.reserve(2 * groups);
+    geometry.cdf.reserve(2 * groups + 2);
+
+    // Группа - один атом или все атомы одного столбца пикселей
+    for (std::size_t i = first; i < last;) {
+        std::size_t end = i + 1;
+        std::size_t minIndex = i, maxIndex = i;
+        float x;
+        if (decimate) {
+            std::size_t column = columnOf(atoms[i].first);
+            for (; end < last && columnOf(atoms[end].first) == column; ++end) {
+                if (atoms[end].second < atoms[minIndex].second) minIndex = end;
+                if (atoms[end].second > atoms[maxIndex].second) maxIndex = end;
+            }
+            x = static_cast<float>((static_cast<double>(column) + 0.5) / static_cast<double>(columns) * 0.8 + 0.1);
+        } else {
+            x = static_cast<float>((atoms[i].first - viewport.minValue) / width * 0.8 + 0.1);
+        }
+
+        float low = static_cast<float>(atoms[minIndex].second * yScale);
+        float high = static_cast<float>(atoms[maxIndex].second * yScale);
+        geometry.stems.push_back({x, 0.0f});
+        geometry.stems.push_back({x, high});
+        if (minIndex < maxIndex) {
+            geometry.points.push_back({x, low});
+            geometry.points.push_back({x, high});
+        } else if (maxIndex < minIndex) {
+            geometry.points.push_back({x, high});
+            geometry.points.push_back({x, low});
+        } else {
+            geometry.points.push_back({x, high});
+        }
+
+        // Горизонтальный участок до текущей точки, затем скачок на сумму p группы
+        geometry.cdf.push_back({x, geometry.cdf.back().y});
+        geometry.cdf.push_back({x, static_cast<float>(cumulative[end - 1] * 0.8)});
+        i = end;
+    }
+    geometry.cdf.push_back({1.0f, after});
+    return geometry;
+}
+
+}
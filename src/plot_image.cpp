@@ -0,0 +1,375 @@
+#include "../include/plot_image.h"
+#include "../include/binary_format.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+struct Color {
+    unsigned char r, g, b;
+};
+
+// Цвета - как у PlotRenderer
+const Color kBackground = {255, 255, 255};
+const Color kAxes = {0, 0, 0};
+const Color kLaw = {51, 102, 204};
+const Color kPolyline = {204, 51, 51};
+const Color kPolylinePoints = {51, 51, 204};
+const Color kCdf = {51, 153, 51};
+
+const int kLineWidth = 2;
+const int kPointSize = 6;
+
+// Растеризация в координатах проекции glOrtho(-0.1, 1.1, -0.1, 1.1)
+class Canvas {
+private:
+    RgbImage& image;
+
+    double pixelX(float x) const { return (x + 0.1) / 1.2 * image.width; }
+    double pixelY(float y) const { return (1.1 - y) / 1.2 * image.height; }
+
+    // Первый из size пикселей, центры которых лежат в [center - size/2, center + size/2)
+    static int firstPixel(double center, int size) {
+        return static_cast<int>(std::ceil(center - size / 2.0 - 0.5));
+    }
+
+public:
+    explicit Canvas(RgbImage& image) : image(image) {}
+
+    // Прямоугольник [x0, x1) x [y0, y1) с отсечением по границам
+    void fill(int x0, int y0, int x1, int y1, Color color) {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, image.width);
+        y1 = std::min(y1, image.height);
+        for (int y = y0; y < y1; ++y) {
+            unsigned char* p = image.pixels.data() + (static_cast<std::size_t>(y) * image.width + x0) * 3;
+            for (int x = x0; x < x1; ++x, p += 3) {
+                p[0] = color.r;
+                p[1] = color.g;
+                p[2] = color.b;
+            }
+        }
+    }
+
+    // Квадратная точка, как GL_POINTS без сглаживания
+    void point(PlotVertex vertex, int size, Color color) {
+        int x = firstPixel(pixelX(vertex.x), size);
+        int y = firstPixel(pixelY(vertex.y), size);
+        fill(x, y, x + size, y + size, color);
+    }
+
+    // Отрезок толщины width: по каждому пикселю главной оси - width пикселей поперек
+    void line(PlotVertex from, PlotVertex to, int width, Color color) {
+        double ax = pixelX(from.x), ay = pixelY(from.y);
+        double bx = pixelX(to.x), by = pixelY(to.y);
+        double dx = bx - ax, dy = by - ay;
+        if (std::fabs(dx) >= std::fabs(dy)) {
+            if (dx == 0) return;
+            if (dx < 0) {
+                std::swap(ax, bx);
+                std::swap(ay, by);
+            }
+            int first = std::max(static_cast<int>(std::ceil(ax - 0.5)), 0);
+            int last = std::min(static_cast<int>(std::floor(bx - 0.5)), image.width - 1);
+            double slope = dy / dx;
+            for (int x = first; x <= last; ++x) {
+                int y = firstPixel(ay + (x + 0.5 - ax) * slope, width);
+                fill(x, y, x + 1, y + width, color);
+            }
+        } else {
+            if (dy < 0) {
+                std::swap(ax, bx);
+                std::swap(ay, by);
+            }
+            int first = std::max(static_cast<int>(std::ceil(ay - 0.5)), 0);
+            int last = std::min(static_cast<int>(std::floor(by - 0.5)), image.height - 1);
+            double slope = dx / dy;
+            for (int y = first; y <= last; ++y) {
+                int x = firstPixel(ax + (y + 0.5 - ay) * slope, width);
+                fill(x, y, x + width, y + 1, color);
+            }
+        }
+    }
+
+    void strip(const std::vector<PlotVertex>& vertices, int width, Color color) {
+        for (std::size_t i = 1; i < vertices.size(); ++i) {
+            line(vertices[i - 1], vertices[i], width, color);
+        }
+    }
+};
+
+// Поток бит deflate: младшие биты - первыми
+class BitWriter {
+private:
+    std::string& out;
+    std::uint64_t buffer = 0;
+    int count = 0;
+
+public:
+    explicit BitWriter(std::string& out) : out(out) {}
+
+    void put(std::uint32_t bits, int length) {
+        buffer |= static_cast<std::uint64_t>(bits) << count;
+        count += length;
+        while (count >= 8) {
+            out.push_back(static_cast<char>(buffer & 0xFF));
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    void flush() {
+        if (count > 0) out.push_back(static_cast<char>(buffer & 0xFF));
+        buffer = 0;
+        count = 0;
+    }
+};
+
+// Фиксированные коды Хаффмана (RFC 1951, 3.2.6), уже развернутые для записи младшими битами вперед
+struct FixedCodes {
+    std::uint16_t literal[288];
+    std::uint8_t literalLength[288];
+    std::uint16_t lengthSymbol[259]; // длина повтора 3..258 -> символ
+    std::uint8_t lengthExtraBits[259];
+    std::uint16_t lengthExtra[259];
+
+    static std::uint16_t reverse(std::uint16_t code, int length) {
+        std::uint16_t result = 0;
+        for (int i = 0; i < length; ++i) {
+            result = static_cast<std::uint16_t>((result << 1) | ((code >> i) & 1));
+        }
+        return result;
+    }
+
+    FixedCodes() {
+        for (int s = 0; s < 288; ++s) {
+            int code, length;
+            if (s < 144) {
+                code = 0x30 + s;
+                length = 8;
+            } else if (s < 256) {
+                code = 0x190 + (s - 144);
+                length = 9;
+            } else if (s < 280) {
+                code = s - 256;
+                length = 7;
+            } else {
+                code = 0xC0 + (s - 280);
+                length = 8;
+            }
+            literal[s] = reverse(static_cast<std::uint16_t>(code), length);
+            literalLength[s] = static_cast<std::uint8_t>(length);
+        }
+
+        static const int base[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                     31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const int extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                      2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        for (int k = 0; k < 29; ++k) {
+            // 258 кодируется отдельным символом 285, а не 284 с дополнительными битами
+            int end = k + 1 < 29 ? base[k + 1] : 259;
+            for (int length = base[k]; length < end; ++length) {
+                lengthSymbol[length] = static_cast<std::uint16_t>(257 + k);
+                lengthExtraBits[length] = static_cast<std::uint8_t>(extra[k]);
+                lengthExtra[length] = static_cast<std::uint16_t>(length - base[k]);
+            }
+        }
+    }
+};
+
+const FixedCodes& fixedCodes() {
+    static const FixedCodes codes;
+    return codes;
+}
+
+std::uint32_t adler32(const unsigned char* data, std::size_t size) {
+    std::uint32_t a = 1, b = 0;
+    while (size > 0) {
+        // 5552 - наибольший блок, при котором суммы не переполняют 32 бита
+        std::size_t block = std::min<std::size_t>(size, 5552);
+        size -= block;
+        for (std::size_t i = 0; i < block; ++i) {
+            a += data[i];
+            b += a;
+        }
+        data += block;
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+// Поток zlib из одного блока с фиксированными кодами; повторы - только на расстоянии 1
+std::string deflateRuns(const std::vector<unsigned char>& data) {
+    const FixedCodes& codes = fixedCodes();
+    std::string out;
+    out.reserve(data.size() / 8 + 64);
+    out.push_back(static_cast<char>(0x78));
+    out.push_back(static_cast<char>(0x01));
+
+    BitWriter bits(out);
+    bits.put(1, 1); // последний блок
+    bits.put(1, 2); // фиксированные коды
+    auto literal = [&](int symbol) { bits.put(codes.literal[symbol], codes.literalLength[symbol]); };
+
+    std::size_t i = 0;
+    while (i < data.size()) {
+        unsigned char value = data[i];
+        literal(value);
+        std::size_t run = 1;
+        while (i + run < data.size() && data[i + run] == value) ++run;
+        i += run;
+        --run;
+        while (run >= 3) {
+            std::size_t length = std::min<std::size_t>(run, 258);
+            // Остаток короче 3 нельзя закодировать повтором: укорачиваем текущий
+            if (run - length > 0 && run - length < 3) length = run - 3;
+            literal(codes.lengthSymbol[length]);
+            bits.put(codes.lengthExtra[length], codes.lengthExtraBits[length]);
+            bits.put(0, 5); // код расстояния 0: расстояние 1
+            run -= length;
+        }
+        for (; run > 0; --run) literal(value);
+    }
+    literal(256);
+    bits.flush();
+
+    std::uint32_t adler = adler32(data.data(), data.size());
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((adler >> shift) & 0xFF));
+    }
+    return out;
+}
+
+void writeChunk(std::ostream& out, const char* type, const std::string& data) {
+    unsigned char header[8];
+    std::uint32_t size = static_cast<std::uint32_t>(data.size());
+    for (int k = 0; k < 4; ++k) {
+        header[k] = static_cast<unsigned char>(size >> (24 - 8 * k));
+    }
+    std::memcpy(header + 4, type, 4);
+    std::uint32_t crc = binary_format::crc32(header + 4, 4);
+    crc = binary_format::crc32(data.data(), data.size(), crc);
+
+    unsigned char trailer[4];
+    for (int k = 0; k < 4; ++k) {
+        trailer[k] = static_cast<unsigned char>(crc >> (24 - 8 * k));
+    }
+    out.write(reinterpret_cast<const char*>(header), 8);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    out.write(reinterpret_cast<const char*>(trailer), 4);
+}
+
+void appendBigEndian(std::string& out, std::uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+void checkImage(const RgbImage& image) {
+    if (image.width <= 0 || image.height <= 0 ||
+        image.pixels.size() != static_cast<std::size_t>(image.width) * image.height * 3) {
+        throw std::invalid_argument("Invalid image");
+    }
+}
+
+}
+
+namespace plot_image {
+
+std::size_t plotColumns(int width) {
+    return static_cast<std::size_t>(std::max(width, 1)) * 2 / 3;
+}
+
+RgbImage render(const PlotGeometry& geometry, int view, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Image size must be positive");
+    }
+    if (view < 0 || view > 2) {
+        throw std::invalid_argument("Unknown plot view");
+    }
+
+    RgbImage image{width, height, std::vector<unsigned char>(static_cast<std::size_t>(width) * height * 3)};
+    Canvas canvas(image);
+    std::memset(image.pixels.data(), kBackground.r, image.pixels.size());
+
+    switch (view) {
+        case 0:
+            for (std::size_t i = 0; i + 1 < geometry.stems.size(); i += 2) {
+                canvas.line(geometry.stems[i], geometry.stems[i + 1], kLineWidth, kLaw);
+            }
+            for (std::size_t i = 1; i < geometry.stems.size(); i += 2) {
+                canvas.point(geometry.stems[i], kPointSize, kLaw);
+            }
+            break;
+        case 1:
+            canvas.strip(geometry.points, kLineWidth, kPolyline);
+            for (const PlotVertex& vertex : geometry.points) {
+                canvas.point(vertex, kPointSize, kPolylinePoints);
+            }
+            break;
+        case 2:
+            canvas.strip(geometry.cdf, kLineWidth, kCdf);
+            break;
+    }
+
+    canvas.line({0.0f, 0.0f}, {1.0f, 0.0f}, 1, kAxes);
+    canvas.line({0.0f, 0.0f}, {0.0f, 1.0f}, 1, kAxes);
+    return image;
+}
+
+RgbImage render(const DiscreteRandomVariable& rv, int view, int width, int height) {
+    auto range = plot_geometry::valueRange(rv);
+    PlotGeometry geometry = plot_geometry::build(rv, {range.first, range.second, plotColumns(width)});
+    return render(geometry, view, width, height);
+}
+
+void writePPM(std::ostream& out, const RgbImage& image) {
+    checkImage(image);
+    out << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+    out.write(reinterpret_cast<const char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+}
+
+void writePNG(std::ostream& out, const RgbImage& image) {
+    checkImage(image);
+
+    // Строки с фильтром Up (2): разность с предыдущей строкой, фон дает серии нулей
+    std::size_t stride = static_cast<std::size_t>(image.width) * 3;
+    std::vector<unsigned char> filtered((stride + 1) * image.height);
+    for (int y = 0; y < image.height; ++y) {
+        const unsigned char* row = image.pixels.data() + y * stride;
+        unsigned char* target = filtered.data() + y * (stride + 1);
+        if (y == 0) {
+            target[0] = 0;
+            std::memcpy(target + 1, row, stride);
+            continue;
+        }
+        const unsigned char* above = row - stride;
+        target[0] = 2;
+        for (std::size_t i = 0; i < stride; ++i) {
+            target[i + 1] = static_cast<unsigned char>(row[i] - above[i]);
+        }
+    }
+
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.write(reinterpret_cast<const char*>(signature), 8);
+
+    std::string header;
+    appendBigEndian(header, static_cast<std::uint32_t>(image.width));
+    appendBigEndian(header, static_cast<std::uint32_t>(image.height));
+    header.push_back(8); // бит на канал
+    header.push_back(2); // RGB
+    header.push_back(0); // deflate
+    header.push_back(0); // адаптивная фильтрация
+    header.push_back(0); // без чересстрочности
+    writeChunk(out, "IHDR", header);
+    writeChunk(out, "IDAT", deflateRuns(filtered));
+    writeChunk(out, "IEND", std::string());
+}
+
+}
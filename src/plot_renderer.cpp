@@ -0,0 +1,162 @@
+#include "../include/plot_renderer.h"
+#define GLFW_INCLUDE_GLEXT
+#include <GLFW/glfw3.h>
+#include <cstdio>
+#include <utility>
+
+static_assert(sizeof(PlotVertex) == 2 * sizeof(GLfloat), "PlotVertex must be two packed floats");
+
+struct PlotRenderer::BufferApi {
+    PFNGLGENBUFFERSPROC genBuffers;
+    PFNGLDELETEBUFFERSPROC deleteBuffers;
+    PFNGLBINDBUFFERPROC bindBuffer;
+    PFNGLBUFFERDATAPROC bufferData;
+};
+
+namespace {
+
+bool hasBufferObjects() {
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    int major = 0, minor = 0;
+    if (!version || std::sscanf(version, "%d.%d", &major, &minor) != 2) return false;
+    return major > 1 || (major == 1 && minor >= 5);
+}
+
+// Смещение в буфере вершин либо адрес в клиентском массиве
+const void* vertexPointer(const std::vector<PlotVertex>& vertices, bool buffered, std::size_t first) {
+    if (buffered) return reinterpret_cast<const void*>(first * sizeof(PlotVertex));
+    return vertices.data() + first;
+}
+
+}
+
+PlotRenderer::PlotRenderer(ProcLoader loader) : buffers{0, 0, 0} {
+    if (!loader || !hasBufferObjects()) return;
+
+    auto table = std::make_unique<BufferApi>();
+    table->genBuffers = reinterpret_cast<PFNGLGENBUFFERSPROC>(loader("glGenBuffers"));
+    table->deleteBuffers = reinterpret_cast<PFNGLDELETEBUFFERSPROC>(loader("glDeleteBuffers"));
+    table->bindBuffer = reinterpret_cast<PFNGLBINDBUFFERPROC>(loader("glBindBuffer"));
+    table->bufferData = reinterpret_cast<PFNGLBUFFERDATAPROC>(loader("glBufferData"));
+    if (!table->genBuffers || !table->deleteBuffers || !table->bindBuffer || !table->bufferData) return;
+
+    table->genBuffers(3, buffers);
+    api = std::move(table);
+}
+
+PlotRenderer::~PlotRenderer() {
+    if (api) api->deleteBuffers(3, buffers);
+}
+
+void PlotRenderer::setGeometry(PlotGeometry newGeometry) {
+    geometry = std::move(newGeometry);
+    if (!api) return;
+
+    const std::vector<PlotVertex>* sources[3] = {&geometry.stems, &geometry.points, &geometry.cdf};
+    for (int view = 0; view < 3; ++view) {
+        api->bindBuffer(GL_ARRAY_BUFFER, buffers[view]);
+        api->bufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sources[view]->size() * sizeof(PlotVertex)),
+                        sources[view]->data(), GL_STATIC_DRAW);
+    }
+    api->bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PlotRenderer::draw(int view, Path path) const {
+    if (path == Path::Immediate) {
+        drawImmediate(view);
+    } else {
+        drawVertexArrays(view);
+    }
+}
+
+void PlotRenderer::drawVertexArrays(int view) const {
+    const std::vector<PlotVertex>& vertices = view == 0 ? geometry.stems : view == 1 ? geometry.points : geometry.cdf;
+    if (vertices.empty()) return;
+    auto count = static_cast<GLsizei>(vertices.size());
+    bool buffered = api != nullptr;
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    if (buffered) api->bindBuffer(GL_ARRAY_BUFFER, buffers[view]);
+    glLineWidth(2.0f);
+
+    switch (view) {
+        case 0:
+            // Отрезки - все вершины подряд, точки - каждая вторая (верхние концы)
+            glColor3f(0.2f, 0.4f, 0.8f);
+            glVertexPointer(2, GL_FLOAT, 0, vertexPointer(vertices, buffered, 0));
+            glDrawArrays(GL_LINES, 0, count);
+            glPointSize(6.0f);
+            glVertexPointer(2, GL_FLOAT, 2 * sizeof(PlotVertex), vertexPointer(vertices, buffered, 1));
+            glDrawArrays(GL_POINTS, 0, count / 2);
+            break;
+        case 1:
+            glColor3f(0.8f, 0.2f, 0.2f);
+            glVertexPointer(2, GL_FLOAT, 0, vertexPointer(vertices, buffered, 0));
+            glDrawArrays(GL_LINE_STRIP, 0, count);
+            glColor3f(0.2f, 0.2f, 0.8f);
+            glPointSize(6.0f);
+            glDrawArrays(GL_POINTS, 0, count);
+            break;
+        case 2:
+            glColor3f(0.2f, 0.6f, 0.2f);
+            glVertexPointer(2, GL_FLOAT, 0, vertexPointer(vertices, buffered, 0));
+            glDrawArrays(GL_LINE_STRIP, 0, count);
+            break;
+    }
+
+    if (buffered) api->bindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void PlotRenderer::drawImmediate(int view) const {
+    switch (view) {
+        case 0:
+            glColor3f(0.2f, 0.4f, 0.8f);
+            glLineWidth(2.0f);
+            for (size_t i = 0; i + 1 < geometry.stems.size(); i += 2) {
+                const PlotVertex& base = geometry.stems[i];
+                const PlotVertex& top = geometry.stems[i + 1];
+
+                // Вертикальная линия
+                glBegin(GL_LINES);
+                glVertex2f(base.x, base.y);
+                glVertex2f(top.x, top.y);
+                glEnd();
+
+                // Точка сверху
+                glPointSize(6.0f);
+                glBegin(GL_POINTS);
+                glVertex2f(top.x, top.y);
+                glEnd();
+            }
+            break;
+        case 1:
+            if (geometry.points.empty()) return;
+            glColor3f(0.8f, 0.2f, 0.2f);
+            glLineWidth(2.0f);
+            glBegin(GL_LINE_STRIP);
+            for (const PlotVertex& vertex : geometry.points) {
+                glVertex2f(vertex.x, vertex.y);
+            }
+            glEnd();
+
+            glColor3f(0.2f, 0.2f, 0.8f);
+            glPointSize(6.0f);
+            glBegin(GL_POINTS);
+            for (const PlotVertex& vertex : geometry.points) {
+                glVertex2f(vertex.x, vertex.y);
+            }
+            glEnd();
+            break;
+        case 2:
+            if (geometry.cdf.empty()) return;
+            glColor3f(0.2f, 0.6f, 0.2f);
+            glLineWidth(2.0f);
+            glBegin(GL_LINE_STRIP);
+            for (const PlotVertex& vertex : geometry.cdf) {
+                glVertex2f(vertex.x, vertex.y);
+            }
+            glEnd();
+            break;
+    }
+}
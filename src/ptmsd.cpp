@@ -0,0 +1,123 @@
+#include "../include/query_server.h"
+#include "../include/distribution_file.h"
+#include "../include/parallel.h"
+#include "../include/tracing.h"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ptmsd: демон запросов к распределениям через Unix domain socket (см. query_server.h)
+
+namespace {
+
+QueryServer* activeServer = nullptr;
+
+void handleSignal(int) {
+    if (activeServer) activeServer->stop();
+}
+
+void printUsage(std::ostream& out) {
+    out << "Usage: ptmsd --socket path [options]\n"
+           "\n"
+           "Options:\n"
+           "  --threads n           requests served concurrently (default: hardware threads)\n"
+           "  --cache-atoms n       result cache size in atoms (default 16777216)\n"
+           "  --data-dir path       directory for client Load requests (default: Load disabled)\n"
+           "  --preload NAME=path   load a distribution before serving (repeatable)\n"
+           "  --trace path          write a Chrome trace-event file until shutdown\n";
+}
+
+std::size_t parseCount(const std::string& text) {
+    std::size_t used = 0;
+    unsigned long long value = 0;
+    try {
+        value = std::stoull(text, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != text.size()) {
+        throw std::invalid_argument("Invalid number: " + text);
+    }
+    return static_cast<std::size_t>(value);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string socketPath;
+    std::size_t threads = hardwareThreads();
+    std::size_t cacheAtoms = std::size_t(1) << 24;
+    std::vector<std::pair<std::string, std::string>> preload;
+    std::string tracePath;
+    std::string dataDirectory;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            std::string value = argv[++i];
+            if (arg == "--socket") {
+                socketPath = value;
+            } else if (arg == "--threads") {
+                threads = parseCount(value);
+            } else if (arg == "--cache-atoms") {
+                cacheAtoms = parseCount(value);
+            } else if (arg == "--data-dir") {
+                dataDirectory = value;
+            } else if (arg == "--trace") {
+                tracePath = value;
+            } else if (arg == "--preload") {
+                std::size_t eq = value.find('=');
+                if (eq == std::string::npos || eq == 0 || eq + 1 == value.size()) {
+                    throw std::invalid_argument("Expected NAME=path: " + value);
+                }
+                preload.push_back({value.substr(0, eq), value.substr(eq + 1)});
+            } else {
+                throw std::invalid_argument("Unknown option: " + arg);
+            }
+        }
+        if (socketPath.empty()) {
+            throw std::invalid_argument("Expected --socket");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ptmsd: " << e.what() << "\n\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    try {
+        QueryServer server(socketPath, threads, cacheAtoms, dataDirectory);
+        if (!tracePath.empty()) {
+            tracing::start(tracePath);
+        }
+
+        std::vector<DiscreteRandomVariable> loaded(preload.size());
+        parallelFor(loaded.size(), 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                loaded[i] = loadDistributionFile(preload[i].second);
+            }
+        });
+        for (std::size_t i = 0; i < loaded.size(); ++i) {
+            server.bind(preload[i].first, std::move(loaded[i]));
+        }
+
+        activeServer = &server;
+        std::signal(SIGINT, handleSignal);
+        std::signal(SIGTERM, handleSignal);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        server.run();
+        activeServer = nullptr;
+        tracing::stop();
+    } catch (const std::exception& e) {
+        std::cerr << "ptmsd: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include "../include/query_client.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using query_protocol::MessageReader;
+using query_protocol::MessageWriter;
+using query_protocol::Operation;
+using query_protocol::RequestCode;
+using query_protocol::Status;
+
+namespace {
+
+// Тело ответа после байта статуса
+MessageReader payload(const std::vector<unsigned char>& body) {
+    return MessageReader(body.data() + 1, body.size() - 1);
+}
+
+}
+
+QueryClient::QueryClient(const std::string& socketPath) : fd(-1) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Cannot create socket: ") + std::strerror(errno));
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot connect to " + socketPath + ": " + std::strerror(error));
+    }
+}
+
+QueryClient::~QueryClient() {
+    if (fd >= 0) ::close(fd);
+}
+
+QueryClient::QueryClient(QueryClient&& other) noexcept : fd(other.fd) {
+    other.fd = -1;
+}
+
+QueryClient& QueryClient::operator=(QueryClient&& other) noexcept {
+    if (this != &other) {
+        if (fd >= 0) ::close(fd);
+        fd = other.fd;
+        other.fd = -1;
+    }
+    return *this;
+}
+
+MessageWriter QueryClient::request(RequestCode code) const {
+    MessageWriter message;
+    message.putU8(static_cast<std::uint8_t>(code));
+    return message;
+}
+
+std::vector<unsigned char> QueryClient::call(const MessageWriter& message) {
+    if (fd < 0) {
+        throw std::runtime_error("Client is not connected");
+    }
+    query_protocol::writeFrame(fd, message.data());
+    std::vector<unsigned char> body;
+    if (!query_protocol::readFrame(fd, body) || body.empty()) {
+        throw std::runtime_error("Connection closed by server");
+    }
+    if (body[0] != static_cast<std::uint8_t>(Status::Ok)) {
+        throw std::runtime_error(payload(body).getString());
+    }
+    return body;
+}
+
+std::size_t QueryClient::load(const std::string& name, const std::string& path) {
+    MessageWriter message = request(RequestCode::Load);
+    message.putString(name);
+    message.putString(path);
+    return payload(call(message)).getU64();
+}
+
+std::size_t QueryClient::put(const std::string& name, const DiscreteRandomVariable& rv) {
+    MessageWriter message = request(RequestCode::Put);
+    message.putString(name);
+    message.putAtoms(rv.atoms());
+    return payload(call(message)).getU64();
+}
+
+void QueryClient::drop(const std::string& name) {
+    MessageWriter message = request(RequestCode::Drop);
+    message.putString(name);
+    call(message);
+}
+
+DiscreteRandomVariable QueryClient::get(const std::string& name) {
+    MessageWriter message = request(RequestCode::Get);
+    message.putString(name);
+    std::vector<unsigned char> body = call(message);
+    return DiscreteRandomVariable(payload(body).getAtoms());
+}
+
+DistributionMoments QueryClient::moments(const std::string& name) {
+    MessageWriter message = request(RequestCode::Moments);
+    message.putString(name);
+    std::vector<unsigned char> body = call(message);
+    MessageReader reader = payload(body);
+    DistributionMoments result;
+    result.expectation = reader.getF64();
+    result.variance = reader.getF64();
+    result.skewness = reader.getF64();
+    result.kurtosis = reader.getF64();
+    return result;
+}
+
+std::vector<double> QueryClient::cdf(const std::string& name, const std::vector<double>& points) {
+    MessageWriter message = request(RequestCode::Cdf);
+    message.putString(name);
+    message.putU32(static_cast<std::uint32_t>(points.size()));
+    for (double x : points) message.putF64(x);
+    std::vector<unsigned char> body = call(message);
+    MessageReader reader = payload(body);
+    std::vector<double> result(points.size());
+    for (double& value : result) value = reader.getF64();
+    return result;
+}
+
+std::vector<double> QueryClient::quantile(const std::string& name, const std::vector<double>& levels) {
+    MessageWriter message = request(RequestCode::Quantile);
+    message.putString(name);
+    message.putU32(static_cast<std::uint32_t>(levels.size()));
+    for (double p : levels) message.putF64(p);
+    std::vector<unsigned char> body = call(message);
+    MessageReader reader = payload(body);
+    std::vector<double> result(levels.size());
+    for (double& value : result) value = reader.getF64();
+    return result;
+}
+
+std::size_t QueryClient::apply(Operation op, const std::string& result, const std::string& left,
+                               const std::string& right, bool* cacheHit) {
+    if (op != Operation::Sum && op != Operation::Product) {
+        throw std::invalid_argument("Operation expects a numeric operand");
+    }
+    MessageWriter message = request(RequestCode::Apply);
+    message.putU8(static_cast<std::uint8_t>(op));
+    message.putString(result);
+    message.putString(left);
+    message.putString(right);
+    std::vector<unsigned char> body = call(message);
+    MessageReader reader = payload(body);
+    std::size_t atoms = reader.getU64();
+    bool hit = reader.getU8() != 0;
+    if (cacheHit) *cacheHit = hit;
+    return atoms;
+}
+
+std::size_t QueryClient::apply(Operation op, const std::string& result, const std::string& left,
+                               double scalar, bool* cacheHit) {
+    if (op != Operation::Scale && op != Operation::Shift) {
+        throw std::invalid_argument("Operation expects a distribution operand");
+    }
+    MessageWriter message = request(RequestCode::Apply);
+    message.putU8(static_cast<std::uint8_t>(op));
+    message.putString(result);
+    message.putString(left);
+    message.putF64(scalar);
+    std::vector<unsigned char> body = call(message);
+    MessageReader reader = payload(body);
+    std::size_t atoms = reader.getU64();
+    bool hit = reader.getU8() != 0;
+    if (cacheHit) *cacheHit = hit;
+    return atoms;
+}
+
+query_protocol::ServerStats QueryClient::stats() {
+    std::vector<unsigned char> body = call(request(RequestCode::Stats));
+    MessageReader reader = payload(body);
+    query_protocol::ServerStats result;
+    result.variables = reader.getU64();
+    result.cacheEntries = reader.getU64();
+    result.cacheHits = reader.getU64();
+    result.cacheMisses = reader.getU64();
+    return result;
+}
+
+std::string QueryClient::instrumentation() {
+    std::vector<unsigned char> body = call(request(RequestCode::Instrumentation));
+    return payload(body).getString();
+}
+
+void QueryClient::shutdown() {
+    call(request(RequestCode::Shutdown));
+}
@@ -0,0 +1,152 @@
+#include "../include/query_protocol.h"
+#include "../include/binary_format.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// Запись без SIGPIPE при закрытом собеседнике, где это поддерживается
+#ifdef MSG_NOSIGNAL
+const int kSendFlags = MSG_NOSIGNAL;
+#else
+const int kSendFlags = 0;
+#endif
+
+// Читает ровно size байт; false, если соединение закрыто до первого байта
+bool readExact(int fd, unsigned char* data, std::size_t size, bool allowClose) {
+    std::size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::read(fd, data + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            throw std::runtime_error(std::string("Socket read failed: ") + std::strerror(errno));
+        }
+        if (n == 0) {
+            if (done == 0 && allowClose) return false;
+            throw std::runtime_error("Connection closed in the middle of a message");
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+void writeExact(int fd, const unsigned char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, kSendFlags);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            throw std::runtime_error(std::string("Socket write failed: ") + std::strerror(errno));
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+}
+
+namespace query_protocol {
+
+void MessageWriter::putU32(std::uint32_t value) {
+    binary_format::appendLE(bytes, value, 4);
+}
+
+void MessageWriter::putU64(std::uint64_t value) {
+    binary_format::appendLE(bytes, value, 8);
+}
+
+void MessageWriter::putF64(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU64(bits);
+}
+
+void MessageWriter::putString(const std::string& value) {
+    putU32(static_cast<std::uint32_t>(value.size()));
+    bytes.insert(bytes.end(), value.begin(), value.end());
+}
+
+void MessageWriter::putAtoms(AtomSpan atoms) {
+    putU64(atoms.size());
+    bytes.reserve(bytes.size() + 16 * atoms.size());
+    for (const auto& atom : atoms) {
+        putF64(atom.first);
+        putF64(atom.second);
+    }
+}
+
+const unsigned char* MessageReader::take(std::size_t size) {
+    if (static_cast<std::size_t>(end - cursor) < size) {
+        throw std::runtime_error("Truncated message");
+    }
+    const unsigned char* result = cursor;
+    cursor += size;
+    return result;
+}
+
+std::uint8_t MessageReader::getU8() {
+    return *take(1);
+}
+
+std::uint32_t MessageReader::getU32() {
+    return static_cast<std::uint32_t>(binary_format::getLE(take(4), 4));
+}
+
+std::uint64_t MessageReader::getU64() {
+    return binary_format::getLE(take(8), 8);
+}
+
+double MessageReader::getF64() {
+    std::uint64_t bits = getU64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string MessageReader::getString() {
+    std::uint32_t size = getU32();
+    const unsigned char* data = take(size);
+    return std::string(reinterpret_cast<const char*>(data), size);
+}
+
+std::vector<std::pair<double, double>> MessageReader::getAtoms() {
+    std::uint64_t count = getU64();
+    // Число атомов проверяется по остатку тела до выделения памяти
+    if (count > static_cast<std::uint64_t>(end - cursor) / 16) {
+        throw std::runtime_error("Truncated message");
+    }
+    std::vector<std::pair<double, double>> atoms(count);
+    for (auto& atom : atoms) {
+        atom.first = getF64();
+        atom.second = getF64();
+    }
+    return atoms;
+}
+
+bool readFrame(int fd, std::vector<unsigned char>& body) {
+    unsigned char header[4];
+    if (!readExact(fd, header, sizeof(header), true)) {
+        return false;
+    }
+    std::uint32_t size = static_cast<std::uint32_t>(binary_format::getLE(header, 4));
+    if (size > kMaxMessageSize) {
+        throw std::runtime_error("Message too large");
+    }
+    body.resize(size);
+    readExact(fd, body.data(), size, false);
+    return true;
+}
+
+void writeFrame(int fd, const std::vector<unsigned char>& body) {
+    if (body.size() > kMaxMessageSize) {
+        throw std::runtime_error("Message too large");
+    }
+    unsigned char header[4];
+    binary_format::putLE(header, body.size(), 4);
+    writeExact(fd, header, sizeof(header));
+    writeExact(fd, body.data(), body.size());
+}
+
+}
@@ -0,0 +1,497 @@
+#include "../include/query_server.h"
+#include "../include/binary_format.h"
+#include "../include/distribution_file.h"
+#include "../include/instrumentation.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using query_protocol::MessageReader;
+using query_protocol::MessageWriter;
+using query_protocol::Operation;
+using query_protocol::RequestCode;
+using query_protocol::Status;
+
+namespace {
+
+std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+// Есть ли уже сервер на этом пути (тогда файл сокета не удаляется)
+bool isSocketInUse(const sockaddr_un& address) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    bool inUse = ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    ::close(fd);
+    return inUse;
+}
+
+// Путь файла для Load: клиент не выходит за каталог данных сервера
+std::string dataFilePath(const std::string& directory, const std::string& path) {
+    if (directory.empty()) {
+        throw std::invalid_argument("Load is disabled: the server has no data directory");
+    }
+    if (path.empty() || path.front() == '/') {
+        throw std::invalid_argument("Load path must be relative to the data directory: " + path);
+    }
+    for (std::size_t begin = 0; begin <= path.size();) {
+        std::size_t end = std::min(path.find('/', begin), path.size());
+        if (path.compare(begin, end - begin, "..") == 0) {
+            throw std::invalid_argument("Load path must not contain '..': " + path);
+        }
+        begin = end + 1;
+    }
+    return directory + "/" + path;
+}
+
+// Стоимость записи кеша - число атомов (плюс служебная часть)
+std::size_t cacheCost(const DiscreteRandomVariable& rv) {
+    return rv.atoms().size() + 1;
+}
+
+}
+
+std::size_t QueryServer::OperationKeyHash::operator()(const OperationKey& key) const {
+    std::uint64_t h = key.left * 0x9E3779B97F4A7C15ull;
+    h ^= (key.right + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2)) * 0xC2B2AE3D27D4EB4Full;
+    return static_cast<std::size_t>(h ^ (h >> 29) ^ key.op);
+}
+
+QueryServer::QueryServer(const std::string& socketPath, std::size_t threads, std::size_t cacheAtoms,
+                         const std::string& dataDirectory)
+    : socketPath(socketPath), dataDirectory(dataDirectory), listenFd(-1), wakePipe{-1, -1}, stopping(false),
+      threadCount(std::max<std::size_t>(threads, 1)), nextId(1), cache(cacheAtoms), cacheHits(0), cacheMisses(0) {
+    sockaddr_un address = socketAddress(socketPath);
+    if (isSocketInUse(address)) {
+        throw std::runtime_error("Socket is already in use: " + socketPath);
+    }
+    ::unlink(socketPath.c_str()); // файл, оставшийся от завершившегося сервера
+
+    if (::pipe(wakePipe) != 0) {
+        throw systemError("Cannot create pipe");
+    }
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        int error = errno;
+        ::close(wakePipe[0]);
+        ::close(wakePipe[1]);
+        errno = error;
+        throw systemError("Cannot create socket");
+    }
+    // До listen() подключиться нельзя, поэтому права меняются раньше первого клиента
+    if (::bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::chmod(socketPath.c_str(), S_IRUSR | S_IWUSR) != 0 || ::listen(listenFd, SOMAXCONN) != 0) {
+        int error = errno;
+        ::close(listenFd);
+        ::close(wakePipe[0]);
+        ::close(wakePipe[1]);
+        ::unlink(socketPath.c_str());
+        errno = error;
+        throw systemError("Cannot listen on " + socketPath);
+    }
+    ::fcntl(listenFd, F_SETFD, FD_CLOEXEC);
+}
+
+QueryServer::~QueryServer() {
+    ::close(listenFd);
+    ::close(wakePipe[0]);
+    ::close(wakePipe[1]);
+    ::unlink(socketPath.c_str());
+}
+
+void QueryServer::bind(const std::string& name, DiscreteRandomVariable rv) {
+    store(name, std::make_shared<const DiscreteRandomVariable>(std::move(rv)));
+}
+
+void QueryServer::stop() {
+    // Только async-signal-safe операции
+    stopping.store(true);
+    char byte = 0;
+    ssize_t written = ::write(wakePipe[1], &byte, 1);
+    (void)written;
+}
+
+void QueryServer::run() {
+    // Канал пробуждения не должен блокировать ни stop(), ни рабочие потоки
+    for (int fd : wakePipe) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    std::vector<pollfd> fds;
+    while (!stopping.load()) {
+        fds.clear();
+        fds.push_back({listenFd, POLLIN, 0});
+        fds.push_back({wakePipe[0], POLLIN, 0});
+        for (const auto& entry : connections) {
+            if (!entry.second.busy) fds.push_back({entry.first, POLLIN, 0});
+        }
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[1].revents) {
+            char bytes[64];
+            while (::read(wakePipe[0], bytes, sizeof(bytes)) > 0) {
+            }
+            if (stopping.load()) break;
+            std::vector<std::pair<int, bool>> done;
+            {
+                std::lock_guard<std::mutex> lock(jobsMutex);
+                done.swap(finished);
+            }
+            for (const auto& item : done) {
+                auto it = connections.find(item.first);
+                it->second.busy = false;
+                if (!item.second) {
+                    closeConnection(item.first);
+                } else {
+                    dispatch(it->first, it->second); // следующий кадр мог прийти вместе с первым
+                }
+            }
+        }
+
+        for (std::size_t i = 2; i < fds.size(); ++i) {
+            if (!fds[i].revents) continue;
+            auto it = connections.find(fds[i].fd);
+            if (!receive(it->first, it->second)) {
+                closeConnection(it->first);
+            } else {
+                dispatch(it->first, it->second);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = ::accept(listenFd, nullptr, nullptr);
+            if (fd >= 0) { // иначе EINTR, ECONNABORTED и т.п.
+                ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+                connections[fd];
+            }
+        }
+    }
+
+    // Остановка: невыполненные запросы отбрасываются, выполняемые прерываются
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping.store(true);
+        jobs.clear();
+        finished.clear();
+    }
+    for (const auto& entry : connections) {
+        ::shutdown(entry.first, SHUT_RDWR);
+    }
+    jobsReady.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    for (const auto& entry : connections) {
+        ::close(entry.first);
+    }
+    connections.clear();
+}
+
+bool QueryServer::receive(int fd, Connection& connection) {
+    std::size_t used = connection.input.size();
+    connection.input.resize(used + 65536);
+    ssize_t n;
+    do {
+        n = ::read(fd, connection.input.data() + used, 65536);
+    } while (n < 0 && errno == EINTR);
+    connection.input.resize(used + std::max<ssize_t>(n, 0));
+    if (n <= 0) {
+        return false; // закрыто клиентом (в том числе посреди кадра) или ошибка
+    }
+    if (connection.input.size() >= 4 &&
+        binary_format::getLE(connection.input.data(), 4) > query_protocol::kMaxMessageSize) {
+        return false;
+    }
+    return true;
+}
+
+void QueryServer::dispatch(int fd, Connection& connection) {
+    std::vector<unsigned char>& input = connection.input;
+    if (connection.busy || input.size() < 4) return;
+    std::size_t size = static_cast<std::size_t>(binary_format::getLE(input.data(), 4));
+    if (size > query_protocol::kMaxMessageSize) {
+        closeConnection(fd);
+        return;
+    }
+    if (input.size() - 4 < size) return;
+
+    Job job = {fd, std::vector<unsigned char>(input.begin() + 4, input.begin() + 4 + size)};
+    input.erase(input.begin(), input.begin() + 4 + size);
+    connection.busy = true;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.push_back(std::move(job));
+    }
+    jobsReady.notify_one();
+}
+
+void QueryServer::closeConnection(int fd) {
+    ::close(fd);
+    connections.erase(fd);
+}
+
+void QueryServer::workerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobsReady.wait(lock, [this]() { return stopping.load() || !jobs.empty(); });
+            if (stopping.load()) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        MessageReader request(job.body.data(), job.body.size());
+        MessageWriter response;
+        bool shutdown = false;
+        try {
+            shutdown = handle(request, response);
+        } catch (const std::exception& e) {
+            response = MessageWriter();
+            response.putU8(static_cast<std::uint8_t>(Status::Error));
+            response.putString(e.what());
+        }
+        bool healthy = true;
+        try {
+            query_protocol::writeFrame(job.fd, response.data());
+        } catch (const std::exception&) {
+            healthy = false; // обрыв соединения: его закроет поток run()
+        }
+
+        if (shutdown) {
+            stop(); // после ответа: остановка прерывает обслуживаемые соединения
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            finished.push_back({job.fd, healthy});
+        }
+        char byte = 1;
+        ssize_t written = ::write(wakePipe[1], &byte, 1);
+        (void)written; // канал полон - поток run() и так проснется
+    }
+}
+
+QueryServer::Stored QueryServer::lookup(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(variablesMutex);
+    auto it = variables.find(name);
+    if (it == variables.end()) {
+        throw std::invalid_argument("Unknown variable: " + name);
+    }
+    return it->second;
+}
+
+std::uint64_t QueryServer::store(const std::string& name, std::shared_ptr<const DiscreteRandomVariable> rv,
+                                 std::uint64_t id) {
+    std::size_t atoms = rv->atoms().size();
+    Stored entry = {std::move(rv), id != 0 ? id : nextId.fetch_add(1)};
+    std::unique_lock<std::shared_mutex> lock(variablesMutex);
+    variables[name] = std::move(entry);
+    return atoms;
+}
+
+std::pair<QueryServer::Stored, bool> QueryServer::apply(Operation op, const Stored& left, const Stored* right,
+                                                        double scalar) {
+    OperationKey key = {static_cast<std::uint8_t>(op), left.id, 0};
+    if (right) {
+        // Сумма и произведение коммутативны
+        key.left = std::min(left.id, right->id);
+        key.right = std::max(left.id, right->id);
+    } else {
+        scalar += 0.0; // -0 и 0 - одна операция
+        std::memcpy(&key.right, &scalar, sizeof(scalar));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (const Stored* cached = cache.find(key)) {
+            ++cacheHits;
+            return {*cached, true};
+        }
+    }
+
+    // Вычисление вне блокировки: одновременные одинаковые запросы могут посчитать результат дважды
+    const DiscreteRandomVariable& a = *left.rv;
+    std::shared_ptr<const DiscreteRandomVariable> rv;
+    switch (op) {
+        case Operation::Sum:
+            rv = std::make_shared<const DiscreteRandomVariable>(a + *right->rv);
+            break;
+        case Operation::Product:
+            rv = std::make_shared<const DiscreteRandomVariable>(a * *right->rv);
+            break;
+        case Operation::Scale:
+            rv = scalar == 0.0
+                ? std::make_shared<const DiscreteRandomVariable>(std::vector<std::pair<double, double>>{{0.0, 1.0}})
+                : std::make_shared<const DiscreteRandomVariable>(a * scalar);
+            break;
+        case Operation::Shift:
+            rv = std::make_shared<const DiscreteRandomVariable>(a + DiscreteRandomVariable({{scalar, 1.0}}));
+            break;
+    }
+
+    Stored result = {rv, nextId.fetch_add(1)};
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cache.insert(key, result, cacheCost(*rv));
+        ++cacheMisses;
+    }
+    return {result, false};
+}
+
+namespace {
+
+// Аргументы разобраны целиком: лишние байты - ошибка запроса (до его выполнения)
+void expectEnd(const MessageReader& request) {
+    if (!request.atEnd()) {
+        throw std::invalid_argument("Unexpected data at the end of a request");
+    }
+}
+
+}
+
+bool QueryServer::handle(MessageReader& request, MessageWriter& response) {
+    auto code = static_cast<RequestCode>(request.getU8());
+    response.putU8(static_cast<std::uint8_t>(Status::Ok));
+    switch (code) {
+        case RequestCode::Load: {
+            std::string name = request.getString();
+            std::string path = request.getString();
+            expectEnd(request);
+            auto rv = std::make_shared<const DiscreteRandomVariable>(loadDistributionFile(dataFilePath(dataDirectory, path)));
+            response.putU64(store(name, std::move(rv)));
+            return false;
+        }
+        case RequestCode::Put: {
+            std::string name = request.getString();
+            auto atoms = request.getAtoms();
+            expectEnd(request);
+            response.putU64(store(name, std::make_shared<const DiscreteRandomVariable>(atoms)));
+            return false;
+        }
+        case RequestCode::Drop: {
+            std::string name = request.getString();
+            expectEnd(request);
+            std::unique_lock<std::shared_mutex> lock(variablesMutex);
+            if (variables.erase(name) == 0) {
+                throw std::invalid_argument("Unknown variable: " + name);
+            }
+            return false;
+        }
+        case RequestCode::Get: {
+            std::string name = request.getString();
+            expectEnd(request);
+            response.putAtoms(lookup(name).rv->atoms());
+            return false;
+        }
+        case RequestCode::Moments: {
+            std::string name = request.getString();
+            expectEnd(request);
+            DistributionMoments moments = lookup(name).rv->atoms().moments();
+            response.putF64(moments.expectation);
+            response.putF64(moments.variance);
+            response.putF64(moments.skewness);
+            response.putF64(moments.kurtosis);
+            return false;
+        }
+        case RequestCode::Cdf:
+        case RequestCode::Quantile: {
+            Stored entry = lookup(request.getString());
+            std::uint32_t count = request.getU32();
+            for (std::uint32_t i = 0; i < count; ++i) {
+                double point = request.getF64();
+                response.putF64(code == RequestCode::Cdf ? entry.rv->cdf(point) : entry.rv->quantile(point));
+            }
+            expectEnd(request);
+            return false;
+        }
+        case RequestCode::Apply: {
+            std::uint8_t opCode = request.getU8();
+            if (opCode > static_cast<std::uint8_t>(Operation::Shift)) {
+                throw std::invalid_argument("Unknown operation");
+            }
+            auto op = static_cast<Operation>(opCode);
+            std::string result = request.getString();
+            std::string leftName = request.getString();
+            bool binary = op == Operation::Sum || op == Operation::Product;
+            std::string rightName = binary ? request.getString() : std::string();
+            double scalar = binary ? 0.0 : request.getF64();
+            expectEnd(request);
+            if (!std::isfinite(scalar)) {
+                throw std::invalid_argument("Operand must be finite");
+            }
+
+            Stored left = lookup(leftName);
+            std::pair<Stored, bool> applied;
+            if (binary) {
+                Stored right = lookup(rightName);
+                applied = apply(op, left, &right, 0.0);
+            } else {
+                applied = apply(op, left, nullptr, scalar);
+            }
+            // Идентификатор результата сохраняется: цепочки операций тоже попадают в кеш
+            response.putU64(store(result, applied.first.rv, applied.first.id));
+            response.putU8(applied.second ? 1 : 0);
+            return false;
+        }
+        case RequestCode::Stats: {
+            expectEnd(request);
+            query_protocol::ServerStats current = stats();
+            response.putU64(current.variables);
+            response.putU64(current.cacheEntries);
+            response.putU64(current.cacheHits);
+            response.putU64(current.cacheMisses);
+            return false;
+        }
+        case RequestCode::Instrumentation:
+            expectEnd(request);
+            response.putString(instrumentation::snapshotJSON());
+            return false;
+        case RequestCode::Shutdown:
+            expectEnd(request);
+            return true;
+    }
+    throw std::invalid_argument("Unknown request");
+}
+
+query_protocol::ServerStats QueryServer::stats() {
+    query_protocol::ServerStats result;
+    {
+        std::shared_lock<std::shared_mutex> lock(variablesMutex);
+        result.variables = variables.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        result.cacheEntries = cache.size();
+    }
+    result.cacheHits = cacheHits.load();
+    result.cacheMisses = cacheMisses.load();
+    return result;
+}
@@ -1,28 +1,141 @@
 #include "../include/random_variable.h"
+#include "../include/binary_format.h"
+#include "../include/compressed_format.h"
+#include "../include/value_accumulator.h"
+#include "../include/instrumentation.h"
+#include "../include/tracing.h"
 #include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <charconv>
+#include <limits>
+#include <type_traits>
 
-DiscreteRandomVariable::DiscreteRandomVariable() : totalProbability(0.0) {}
+static_assert(sizeof(std::pair<double, double>) == binary_format::kAtomSize,
+              "Atoms must be stored as two contiguous doubles");
 
-DiscreteRandomVariable::DiscreteRandomVariable(const std::vector<std::pair<double, double>>& dist) {
+namespace {
+
+// Поле атома в файле: целые значения - int64, остальное - float64
+template <typename V>
+std::uint8_t valueTypeCode() {
+    return std::is_integral<V>::value ? binary_format::kTypeInt64 : binary_format::kTypeFloat64;
+}
+
+template <typename T>
+std::uint64_t fieldBits(T value) {
+    if constexpr (std::is_integral<T>::value) {
+        return static_cast<std::uint64_t>(value);
+    } else {
+        double wide = static_cast<double>(value);
+        std::uint64_t bits;
+        std::memcpy(&bits, &wide, sizeof(bits));
+        return bits;
+    }
+}
+
+template <typename T>
+T fieldFromBits(std::uint64_t bits) {
+    if constexpr (std::is_integral<T>::value) {
+        return static_cast<T>(bits);
+    } else {
+        T value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+// Типизированная нагрузка: поля атомов подряд по 8 байт, little-endian
+template <typename SourceValue>
+std::vector<std::pair<SourceValue, double>> decodeTyped(const unsigned char* in, std::size_t count) {
+    std::vector<std::pair<SourceValue, double>> atoms(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        atoms[i].first = fieldFromBits<SourceValue>(binary_format::getLE(in, 8));
+        atoms[i].second = fieldFromBits<double>(binary_format::getLE(in + 8, 8));
+        in += binary_format::kAtomSize;
+    }
+    return atoms;
+}
+
+// Целые значения принимаются из float64 только без потери точности
+template <typename V, typename Source>
+V convertValue(Source value) {
+    if constexpr (std::is_integral<V>::value && !std::is_integral<Source>::value) {
+        const Source limit = 9223372036854775808.0; // 2^63
+        if (!(value >= -limit && value < limit) || value != static_cast<Source>(static_cast<V>(value))) {
+            throw std::runtime_error("Distribution values are not integers");
+        }
+    }
+    return static_cast<V>(value);
+}
+
+// Самое длинное представление в формате "%f": все цифры целой части, знак, точка и 6 знаков
+template <typename T>
+void appendNumber(std::string& out, T value) {
+    if constexpr (std::is_integral<T>::value) {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    } else {
+        char buffer[std::numeric_limits<T>::max_exponent10 + 16];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 6);
+        out.append(buffer, result.ptr);
+    }
+}
+
+}
+
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P>::BasicDiscreteRandomVariable() : totalProbability(0.0) {}
+
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P>::BasicDiscreteRandomVariable(const allocator_type& alloc)
+    : distribution(alloc), cumulative(alloc), totalProbability(0.0) {}
+
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P>::BasicDiscreteRandomVariable(const std::vector<Atom>& dist, const allocator_type& alloc)
+    : distribution(alloc), cumulative(alloc), totalProbability(0.0) {
     setDistribution(dist);
 }
 
-void DiscreteRandomVariable::validateDistribution() {
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P>::BasicDiscreteRandomVariable(const BasicDiscreteRandomVariable& other,
+                                                               const allocator_type& alloc)
+    : distribution(other.distribution, alloc), cumulative(other.cumulative, alloc),
+      totalProbability(other.totalProbability) {}
+
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P>::BasicDiscreteRandomVariable(BasicDiscreteRandomVariable&& other,
+                                                               const allocator_type& alloc)
+    : distribution(std::move(other.distribution), alloc), cumulative(std::move(other.cumulative), alloc),
+      totalProbability(other.totalProbability) {}
+
+template <typename V, typename P>
+typename BasicDiscreteRandomVariable<V, P>::allocator_type BasicDiscreteRandomVariable<V, P>::get_allocator() const {
+    return distribution.get_allocator();
+}
+
+template <typename V, typename P>
+void BasicDiscreteRandomVariable<V, P>::validateDistribution() {
+    PTMS_PROBE(Validate, distribution.size());
     if (distribution.empty()) {
         throw std::invalid_argument("Distribution cannot be empty");
     }
-    
-    // Проверка на уникальность значений
-    std::vector<double> values;
-    for (const auto& pair : distribution) {
-        values.push_back(pair.first);
+
+    // Храним атомы упорядоченными по значению; уже упорядоченные данные
+    // (результаты операторов, файлы) проверяются за один проход
+    auto byValue = [](const auto& a, const auto& b) { return a.first < b.first; };
+    if (!std::is_sorted(distribution.begin(), distribution.end(), byValue)) {
+        std::sort(distribution.begin(), distribution.end(), byValue);
     }
-    std::sort(values.begin(), values.end());
-    auto last = std::unique(values.begin(), values.end());
-    if (last != values.end()) {
+
+    // Проверка на уникальность значений
+    auto duplicate = std::adjacent_find(distribution.begin(), distribution.end(),
+        [](const auto& a, const auto& b) { return a.first == b.first; });
+    if (duplicate != distribution.end()) {
         throw std::invalid_argument("All values must be unique");
     }
-    
+
     // Проверка вероятностей
     totalProbability = 0.0;
     for (const auto& pair : distribution) {
@@ -31,193 +144,434 @@ void DiscreteRandomVariable::validateDistribution() {
         }
         totalProbability += pair.second;
     }
-    
-    if (std::abs(totalProbability - 1.0) > 1e-10) {
+
+    const real_type tolerance = std::max<real_type>(1e-10, 4 * std::numeric_limits<P>::epsilon());
+    if (std::abs(totalProbability - 1) > tolerance) {
         normalizeProbabilities();
     }
+
+    cumulative.resize(distribution.size());
+    real_type sum = 0.0;
+    for (size_t i = 0; i < distribution.size(); ++i) {
+        sum += distribution[i].second;
+        cumulative[i] = static_cast<P>(sum);
+    }
 }
 
-void DiscreteRandomVariable::normalizeProbabilities() {
+template <typename V, typename P>
+void BasicDiscreteRandomVariable<V, P>::normalizeProbabilities() {
     for (auto& pair : distribution) {
-        pair.second /= totalProbability;
+        pair.second = static_cast<P>(pair.second / totalProbability);
     }
     totalProbability = 1.0;
 }
 
-void DiscreteRandomVariable::setDistribution(const std::vector<std::pair<double, double>>& dist) {
-    distribution = dist;
+template <typename V, typename P>
+void BasicDiscreteRandomVariable<V, P>::setDistribution(const std::vector<Atom>& dist) {
+    // Проверка внутри операторов входит в их собственную область трассировки
+    PTMS_TRACE("setDistribution", "core");
+    distribution.assign(dist.begin(), dist.end());
     validateDistribution();
 }
 
-const std::vector<std::pair<double, double>>& DiscreteRandomVariable::getDistribution() const {
-    return distribution;
+template <typename V, typename P>
+void BasicDiscreteRandomVariable<V, P>::adoptDistribution(AtomStorage&& dist) {
+    // При совпадении ресурсов буфер в куче перемещается без копирования
+    distribution = std::move(dist);
+    validateDistribution();
 }
 
-DiscreteRandomVariable DiscreteRandomVariable::operator*(double scalar) const {
-    std::vector<std::pair<double, double>> result;
-    for (const auto& pair : distribution) {
-        result.push_back({pair.first * scalar, pair.second});
+template <typename V, typename P>
+template <typename SourceValue, typename SourceProbability>
+void BasicDiscreteRandomVariable<V, P>::adoptConverted(const std::pair<SourceValue, SourceProbability>* atoms,
+                                                       std::size_t count) {
+    AtomStorage dist(get_allocator());
+    dist.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        dist.push_back({convertValue<V>(atoms[i].first), static_cast<P>(atoms[i].second)});
     }
-    return DiscreteRandomVariable(result);
+    adoptDistribution(std::move(dist));
 }
 
-DiscreteRandomVariable DiscreteRandomVariable::operator+(const DiscreteRandomVariable& other) const {
-    std::map<double, double> resultMap;
-    
-    for (const auto& pair1 : distribution) {
-        for (const auto& pair2 : other.distribution) {
-            double sumValue = pair1.first + pair2.first;
-            double probProduct = pair1.second * pair2.second;
-            resultMap[sumValue] += probProduct;
-        }
+template <typename V, typename P>
+typename BasicDiscreteRandomVariable<V, P>::Span BasicDiscreteRandomVariable<V, P>::getDistribution() const {
+    return atoms();
+}
+
+template <typename V, typename P>
+typename BasicDiscreteRandomVariable<V, P>::Span BasicDiscreteRandomVariable<V, P>::atoms() const {
+    // После неудачной проверки префиксные суммы могут не соответствовать атомам
+    const P* prefix = cumulative.size() == distribution.size() ? cumulative.data() : nullptr;
+    return Span(distribution.data(), distribution.size(), prefix);
+}
+
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P> BasicDiscreteRandomVariable<V, P>::operator*(V scalar) const {
+    PTMS_PROBE(Scale, distribution.size());
+    PTMS_TRACE("scale", "core");
+    AtomStorage result(get_allocator());
+    result.reserve(distribution.size());
+    for (const auto& pair : distribution) {
+        result.push_back({pair.first * scalar, pair.second});
     }
-    
-    std::vector<std::pair<double, double>> result;
-    for (const auto& pair : resultMap) {
-        result.push_back(pair);
+    // Отрицательный множитель обращает порядок значений
+    if (scalar < 0) {
+        std::reverse(result.begin(), result.end());
     }
-    
-    return DiscreteRandomVariable(result);
+
+    BasicDiscreteRandomVariable rv(get_allocator());
+    rv.adoptDistribution(std::move(result));
+    return rv;
+}
+
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P> BasicDiscreteRandomVariable<V, P>::operator+(const BasicDiscreteRandomVariable& other) const {
+    return sumOf(atoms(), other.atoms(), get_allocator());
 }
 
-DiscreteRandomVariable DiscreteRandomVariable::operator*(const DiscreteRandomVariable& other) const {
-    std::map<double, double> resultMap;
-    
-    for (const auto& pair1 : distribution) {
-        for (const auto& pair2 : other.distribution) {
-            double productValue = pair1.first * pair2.first;
-            double probProduct = pair1.second * pair2.second;
-            resultMap[productValue] += probProduct;
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P> BasicDiscreteRandomVariable<V, P>::operator*(const BasicDiscreteRandomVariable& other) const {
+    return productOf(atoms(), other.atoms(), get_allocator());
+}
+
+namespace {
+
+// Общее ядро для sumOf/productOf: все временные буферы - из ресурса результата.
+// Вероятности накапливаются в типе статистик, затем приводятся к P.
+template <typename Storage, typename V, typename P, typename Combine>
+Storage combineAtoms(BasicAtomSpan<V, P> a, BasicAtomSpan<V, P> b, Combine combine,
+                     std::pmr::memory_resource* resource) {
+    using Real = StatisticType<V, P>;
+    BasicValueAccumulator<V, Real> accumulator(resource);
+    // Для решеток у суммы n + m - 1 значений; при большем числе таблица вырастет
+    accumulator.reset(a.size() + b.size());
+    for (const auto& pair1 : a) {
+        for (const auto& pair2 : b) {
+            accumulator.add(combine(pair1.first, pair2.first), static_cast<Real>(pair1.second) * pair2.second);
         }
     }
-    
-    std::vector<std::pair<double, double>> result;
-    for (const auto& pair : resultMap) {
-        result.push_back(pair);
+    accumulator.sortByValue();
+
+    Storage result(resource);
+    result.reserve(accumulator.size());
+    for (size_t k = 0; k < accumulator.size(); ++k) {
+        result.push_back({accumulator.value(k), static_cast<P>(accumulator.probability(k))});
     }
-    
-    return DiscreteRandomVariable(result);
+    return result;
 }
 
-double DiscreteRandomVariable::expectation() const {
-    double mean = 0.0;
-    for (const auto& pair : distribution) {
-        mean += pair.first * pair.second;
-    }
-    return mean;
 }
 
-double DiscreteRandomVariable::variance() const {
-    double mean = expectation();
-    double var = 0.0;
-    for (const auto& pair : distribution) {
-        var += std::pow(pair.first - mean, 2) * pair.second;
-    }
-    return var;
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P> BasicDiscreteRandomVariable<V, P>::sumOf(Span a, Span b, const allocator_type& alloc) {
+    PTMS_PROBE(Sum, static_cast<std::uint64_t>(a.size()) * b.size());
+    PTMS_TRACE("sumOf", "core");
+    BasicDiscreteRandomVariable rv(alloc);
+    rv.adoptDistribution(combineAtoms<AtomStorage>(a, b, [](V x, V y) { return x + y; }, alloc.resource()));
+    return rv;
 }
 
-double DiscreteRandomVariable::standardDeviation() const {
-    return std::sqrt(variance());
+template <typename V, typename P>
+BasicDiscreteRandomVariable<V, P> BasicDiscreteRandomVariable<V, P>::productOf(Span a, Span b, const allocator_type& alloc) {
+    PTMS_PROBE(Product, static_cast<std::uint64_t>(a.size()) * b.size());
+    PTMS_TRACE("productOf", "core");
+    BasicDiscreteRandomVariable rv(alloc);
+    rv.adoptDistribution(combineAtoms<AtomStorage>(a, b, [](V x, V y) { return x * y; }, alloc.resource()));
+    return rv;
 }
 
-double DiscreteRandomVariable::skewness() const {
-    double mean = expectation();
-    double stdDev = standardDeviation();
-    if (stdDev == 0) return 0.0;
-    
-    double skew = 0.0;
-    for (const auto& pair : distribution) {
-        skew += std::pow((pair.first - mean) / stdDev, 3) * pair.second;
-    }
-    return skew;
+template <typename V, typename P>
+typename BasicDiscreteRandomVariable<V, P>::real_type BasicDiscreteRandomVariable<V, P>::expectation() const {
+    return atoms().expectation();
 }
 
-double DiscreteRandomVariable::kurtosis() const {
-    double mean = expectation();
-    double stdDev = standardDeviation();
-    if (stdDev == 0) return 0.0;
-    
-    double kurt = 0.0;
-    for (const auto& pair : distribution) {
-        kurt += std::pow((pair.first - mean) / stdDev, 4) * pair.second;
+template <typename V, typename P>
+typename BasicDiscreteRandomVariable<V, P>::real_type BasicDiscreteRandomVariable<V, P>::variance() const {
+    return atoms().variance();
+}
+
+template <typename V, typename P>
+typename BasicDiscreteRandomVariable<V, P>::real_type BasicDiscreteRandomVariable<V, P>::standardDeviation() const {
+    return atoms().standardDeviation();
+}
+
+template <typename V, typename P>
+typename BasicDiscreteRandomVariable<V, P>::real_type BasicDiscreteRandomVariable<V, P>::skewness() const {
+    return atoms().skewness();
+}
+
+template <typename V, typename P>
+typename BasicDiscreteRandomVariable<V, P>::real_type BasicDiscreteRandomVariable<V, P>::kurtosis() const {
+    return atoms().kurtosis();
+}
+
+template <typename V, typename P>
+void BasicDiscreteRandomVariable<V, P>::serialize(std::ofstream& file) const {
+    PTMS_PROBE(Serialize, distribution.size());
+    PTMS_TRACE("serialize", "io");
+    if (!file.is_open()) {
+        throw std::runtime_error("File is not open for writing");
+    }
+
+    BinaryHeader header;
+    header.version = binary_format::kFormatVersion;
+    header.flags = binary_format::kFlagCanonical;
+    header.atomCount = distribution.size();
+    header.valueType = valueTypeCode<V>();
+    header.probabilityType = binary_format::kTypeFloat64;
+
+    const char* payload = reinterpret_cast<const char*>(distribution.data());
+    size_t payloadSize = distribution.size() * binary_format::kAtomSize;
+    std::vector<std::pair<double, double>> converted;
+    std::vector<unsigned char> packed;
+
+    if (!binary_format::hasDefaultTypes(header)) {
+        // Целые значения: поля атомов упаковываются подряд
+        header.version = binary_format::kTypedFormatVersion;
+        payloadSize = distribution.size() * binary_format::kAtomSize;
+        packed.resize(payloadSize);
+        unsigned char* out = packed.data();
+        for (const auto& pair : distribution) {
+            binary_format::putLE(out, fieldBits(pair.first), 8);
+            binary_format::putLE(out + 8, fieldBits(pair.second), 8);
+            out += 16;
+        }
+        payload = reinterpret_cast<const char*>(packed.data());
+    } else {
+        if constexpr (!std::is_same<Atom, std::pair<double, double>>::value) {
+            // long double хранится как float64
+            converted.reserve(distribution.size());
+            for (const auto& pair : distribution) {
+                converted.push_back({static_cast<double>(pair.first), static_cast<double>(pair.second)});
+            }
+            payload = reinterpret_cast<const char*>(converted.data());
+        }
+
+        // На big-endian платформе приводим полезную нагрузку к little-endian
+        if (!binary_format::isLittleEndianHost()) {
+            if (converted.empty()) {
+                const auto* atoms = reinterpret_cast<const std::pair<double, double>*>(payload);
+                converted.assign(atoms, atoms + distribution.size());
+            }
+            binary_format::byteSwap64(converted.data(), converted.size() * 2);
+            payload = reinterpret_cast<const char*>(converted.data());
+        }
+    }
+
+    header.crc = binary_format::crc32(payload, payloadSize);
+    binary_format::writeHeader(file, header);
+    file.write(payload, payloadSize);
+    if (!file) {
+        throw std::runtime_error("Failed to write distribution");
     }
-    return kurt - 3.0; // Excess kurtosis
 }
 
-void DiscreteRandomVariable::serialize(std::ofstream& file) const {
+template <typename V, typename P>
+void BasicDiscreteRandomVariable<V, P>::serializeCompressed(std::ofstream& file) const {
+    PTMS_PROBE(Serialize, distribution.size());
+    PTMS_TRACE("serializeCompressed", "io");
     if (!file.is_open()) {
         throw std::runtime_error("File is not open for writing");
     }
-    
-    size_t size = distribution.size();
-    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-    
-    for (const auto& pair : distribution) {
-        file.write(reinterpret_cast<const char*>(&pair.first), sizeof(pair.first));
-        file.write(reinterpret_cast<const char*>(&pair.second), sizeof(pair.second));
+    if constexpr (std::is_same<Atom, std::pair<double, double>>::value) {
+        compressed_format::write(file, atoms(), binary_format::kFlagCanonical);
+    } else {
+        // Сжатый формат хранит атомы float64; целые значения должны представляться точно
+        std::vector<std::pair<double, double>> converted;
+        converted.reserve(distribution.size());
+        for (const auto& pair : distribution) {
+            double value = static_cast<double>(pair.first);
+            if constexpr (std::is_integral<V>::value) {
+                if (value < -9007199254740992.0 || value > 9007199254740992.0) { // 2^53
+                    throw std::runtime_error("Values do not fit into the compressed format exactly");
+                }
+            }
+            converted.push_back({value, static_cast<double>(pair.second)});
+        }
+        compressed_format::write(file, AtomSpan(converted), binary_format::kFlagCanonical);
     }
 }
 
-void DiscreteRandomVariable::deserialize(std::ifstream& file) {
+template <typename V, typename P>
+void BasicDiscreteRandomVariable<V, P>::deserialize(std::ifstream& file) {
     if (!file.is_open()) {
         throw std::runtime_error("File is not open for reading");
     }
-    
-    size_t size;
-    file.read(reinterpret_cast<char*>(&size), sizeof(size));
-    
-    std::vector<std::pair<double, double>> dist;
-    for (size_t i = 0; i < size; ++i) {
-        double value, probability;
-        file.read(reinterpret_cast<char*>(&value), sizeof(value));
-        file.read(reinterpret_cast<char*>(&probability), sizeof(probability));
-        dist.push_back({value, probability});
-    }
-    
-    setDistribution(dist);
+    PTMS_PROBE_SCOPE(probe, Deserialize);
+    PTMS_TRACE("deserialize", "io");
+
+    std::streampos start = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff available = file.tellg() - start;
+    file.seekg(start);
+
+    char magic[4] = {};
+    file.read(magic, sizeof(magic));
+    file.clear();
+    file.seekg(start);
+
+    uint64_t size;
+    uint32_t expectedCrc = 0;
+    bool legacy = std::memcmp(magic, binary_format::kMagic, sizeof(magic)) != 0;
+    if (legacy) {
+        // Старый формат без заголовка: size_t и пары значений в порядке хоста
+        size_t legacySize = 0;
+        file.read(reinterpret_cast<char*>(&legacySize), sizeof(legacySize));
+        size = legacySize;
+        PTMS_PROBE_ITEMS(probe, size);
+        available -= sizeof(legacySize);
+    } else {
+        BinaryHeader header = binary_format::readHeader(file);
+        PTMS_PROBE_ITEMS(probe, header.atomCount);
+        available -= binary_format::kHeaderSize;
+        if (header.flags & binary_format::kFlagCompressed) {
+            std::pmr::vector<std::pair<double, double>> decoded =
+                compressed_format::read(file, header, static_cast<uint64_t>(available), get_allocator().resource());
+            adoptConverted(decoded.data(), decoded.size());
+            return;
+        }
+
+        if (!binary_format::hasDefaultTypes(header)) {
+            // Единственная типизированная нагрузка - целые значения с вероятностями float64
+            if (header.atomCount > static_cast<uint64_t>(available) / binary_format::kAtomSize) {
+                throw std::runtime_error("Unexpected end of file");
+            }
+            std::vector<unsigned char> packed(static_cast<size_t>(header.atomCount) * binary_format::kAtomSize);
+            file.read(reinterpret_cast<char*>(packed.data()), packed.size());
+            if (!file) {
+                throw std::runtime_error("Unexpected end of file");
+            }
+            if (binary_format::crc32(packed.data(), packed.size()) != header.crc) {
+                throw std::runtime_error("Distribution checksum mismatch");
+            }
+
+            size_t count = static_cast<size_t>(header.atomCount);
+            adoptConverted(decodeTyped<std::int64_t>(packed.data(), count).data(), count);
+            return;
+        }
+        size = header.atomCount;
+        expectedCrc = header.crc;
+    }
+
+    if (!file || size > static_cast<uint64_t>(available) / binary_format::kAtomSize) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+
+    // Пары float64: для DiscreteRandomVariable читаются прямо в хранилище атомов
+    auto readPayload = [&](auto& dist) {
+        dist.resize(static_cast<size_t>(size));
+        size_t payloadSize = dist.size() * binary_format::kAtomSize;
+        file.read(reinterpret_cast<char*>(dist.data()), payloadSize);
+        if (!file) {
+            throw std::runtime_error("Unexpected end of file");
+        }
+
+        if (!legacy) {
+            if (binary_format::crc32(dist.data(), payloadSize) != expectedCrc) {
+                throw std::runtime_error("Distribution checksum mismatch");
+            }
+            if (!binary_format::isLittleEndianHost()) {
+                binary_format::byteSwap64(dist.data(), dist.size() * 2);
+            }
+        }
+    };
+
+    if constexpr (std::is_same<Atom, std::pair<double, double>>::value) {
+        AtomStorage dist(get_allocator());
+        readPayload(dist);
+        adoptDistribution(std::move(dist));
+    } else {
+        std::pmr::vector<std::pair<double, double>> dist(get_allocator());
+        readPayload(dist);
+        adoptConverted(dist.data(), dist.size());
+    }
 }
 
-std::vector<double> DiscreteRandomVariable::getValues() const {
-    std::vector<double> values;
+template <typename V, typename P>
+std::vector<V> BasicDiscreteRandomVariable<V, P>::getValues() const {
+    std::vector<V> values;
+    values.reserve(distribution.size());
     for (const auto& pair : distribution) {
         values.push_back(pair.first);
     }
     return values;
 }
 
-std::vector<double> DiscreteRandomVariable::getProbabilities() const {
-    std::vector<double> probs;
+template <typename V, typename P>
+std::vector<P> BasicDiscreteRandomVariable<V, P>::getProbabilities() const {
+    std::vector<P> probs;
+    probs.reserve(distribution.size());
     for (const auto& pair : distribution) {
         probs.push_back(pair.second);
     }
     return probs;
 }
 
-std::vector<std::pair<double, double>> DiscreteRandomVariable::getCDF() const {
-    std::vector<std::pair<double, double>> sorted = distribution;
-    std::sort(sorted.begin(), sorted.end(), 
-        [](const auto& a, const auto& b) { return a.first < b.first; });
-    
-    std::vector<std::pair<double, double>> cdf;
-    double cumulative = 0.0;
-    
-    for (const auto& pair : sorted) {
-        cumulative += pair.second;
-        cdf.push_back({pair.first, cumulative});
+template <typename V, typename P>
+std::vector<std::pair<V, P>> BasicDiscreteRandomVariable<V, P>::getCDF() const {
+    std::vector<std::pair<V, P>> cdf;
+    cdf.reserve(distribution.size());
+    for (size_t i = 0; i < distribution.size(); ++i) {
+        cdf.push_back({distribution[i].first, cumulative[i]});
     }
-    
     return cdf;
 }
 
-std::string DiscreteRandomVariable::toString() const {
-    std::string result = "Discrete Random Variable:\n";
+template <typename V, typename P>
+typename BasicDiscreteRandomVariable<V, P>::real_type BasicDiscreteRandomVariable<V, P>::cdf(real_type x) const {
+    PTMS_PROBE(Cdf, distribution.size());
+    auto it = std::upper_bound(distribution.begin(), distribution.end(), x,
+        [](real_type value, const auto& atom) { return value < atom.first; });
+    if (it == distribution.begin()) return 0.0;
+    return std::min<real_type>(cumulative[it - distribution.begin() - 1], 1.0);
+}
+
+template <typename V, typename P>
+V BasicDiscreteRandomVariable<V, P>::quantile(real_type p) const {
+    PTMS_PROBE(Quantile, distribution.size());
+    if (distribution.empty()) {
+        throw std::invalid_argument("Distribution cannot be empty");
+    }
+    if (!(p >= 0.0 && p <= 1.0)) {
+        throw std::invalid_argument("Quantile level must be in [0, 1]");
+    }
+
+    auto it = std::lower_bound(cumulative.begin(), cumulative.end(), p);
+    if (it == cumulative.end()) {
+        return distribution.back().first; // накопленная сумма может не дотянуть до 1
+    }
+    return distribution[it - cumulative.begin()].first;
+}
+
+template <typename V, typename P>
+std::string BasicDiscreteRandomVariable<V, P>::toString() const {
+    // Тот же вид, что и у std::to_string ("%f"), но без временных строк
+    std::string result;
+    result.reserve(128 + distribution.size() * 48);
+    result += "Discrete Random Variable:\n";
     for (const auto& pair : distribution) {
-        result += "  Value: " + std::to_string(pair.first) + 
-                 ", Probability: " + std::to_string(pair.second) + "\n";
+        result += "  Value: ";
+        appendNumber(result, pair.first);
+        result += ", Probability: ";
+        appendNumber(result, pair.second);
+        result += '\n';
     }
-    result += "Expectation: " + std::to_string(expectation()) + "\n";
-    result += "Variance: " + std::to_string(variance()) + "\n";
-    result += "Skewness: " + std::to_string(skewness()) + "\n";
-    result += "Kurtosis: " + std::to_string(kurtosis()) + "\n";
+    result += "Expectation: ";
+    appendNumber(result, expectation());
+    result += "\nVariance: ";
+    appendNumber(result, variance());
+    result += "\nSkewness: ";
+    appendNumber(result, skewness());
+    result += "\nKurtosis: ";
+    appendNumber(result, kurtosis());
+    result += '\n';
     return result;
-}
\ No newline at end of file
+}
+
+// Поддерживаемые типы значений и вероятностей
+template class BasicDiscreteRandomVariable<std::int64_t, double>;
+template class BasicDiscreteRandomVariable<std::int64_t, long double>;
+template class BasicDiscreteRandomVariable<double, double>;
+template class BasicDiscreteRandomVariable<double, long double>;
+template class BasicDiscreteRandomVariable<long double, double>;
+template class BasicDiscreteRandomVariable<long double, long double>;
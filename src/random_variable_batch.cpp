@@ -0,0 +1,377 @@
+#include "../include/random_variable_batch.h"
+#include "../include/parallel.h"
+#include "../include/value_accumulator.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Распределений на поток: меньшие объемы считаются в вызывающем потоке
+const std::size_t kMinDistributionsPerThread = 1024;
+
+// Пакетные статистики обрабатывают группы из kLanes распределений: k-е атомы всех
+// распределений группы складываются одной векторной операцией (дорожка -
+// распределение). Для этого атомы один раз перекладываются в LaneLayout, а чтобы
+// дополнения было мало, внутри окна из kSortWindow распределений группы
+// составляются из распределений близкой длины. Короткие дорожки дополнены повтором
+// последнего атома с нулевой вероятностью, который прибавляет к суммам ровно +0.0,
+// поэтому в каждой дорожке порядок сложения и результат те же, что у прохода по
+// одному распределению (AtomSpan::moments, cdf, quantile). Циклы по дорожкам без
+// ветвлений векторизует компилятор, встроенные функции не нужны.
+const std::size_t kLanes = 8;
+const std::size_t kSortWindow = 256;
+
+}
+
+// Группа g занимает [groupOffsets[g], groupOffsets[g + 1]) массивов values и
+// probabilities: k-й атом дорожки lane - элемент k * kLanes + lane. Дорожка lane
+// группы g - распределение rows[g * kLanes + lane]
+struct RandomVariableBatch::LaneLayout {
+    std::vector<double> values;
+    std::vector<double> probabilities;
+    std::vector<std::size_t> groupOffsets;
+    std::vector<std::size_t> rows;
+
+    std::size_t groups() const { return groupOffsets.size() - 1; }
+};
+
+namespace {
+
+using LaneLayout = RandomVariableBatch::LaneLayout;
+
+// Группа макета; дорожки lane >= lanes (в последней группе) не заняты
+struct LaneGroup {
+    const double* values;
+    const double* probabilities;
+    const std::size_t* rows;
+    std::size_t atoms;
+    std::size_t lanes;
+};
+
+void momentsOf(const LaneGroup& group, DistributionMoments* out) {
+    double mean[kLanes] = {};
+    for (std::size_t k = 0; k < group.atoms; ++k) {
+        const double* v = group.values + k * kLanes;
+        const double* p = group.probabilities + k * kLanes;
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            mean[lane] += v[lane] * p[lane];
+        }
+    }
+
+    double m2[kLanes] = {}, m3[kLanes] = {}, m4[kLanes] = {};
+    for (std::size_t k = 0; k < group.atoms; ++k) {
+        const double* v = group.values + k * kLanes;
+        const double* p = group.probabilities + k * kLanes;
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            double d = v[lane] - mean[lane];
+            double d2 = d * d;
+            m2[lane] += d2 * p[lane];
+            m3[lane] += d2 * d * p[lane];
+            m4[lane] += d2 * d2 * p[lane];
+        }
+    }
+
+    for (std::size_t lane = 0; lane < group.lanes; ++lane) {
+        out[group.rows[lane]] = momentsFromCentralSums(mean[lane], m2[lane], m3[lane], m4[lane]);
+    }
+}
+
+// Атомы упорядочены по значению, поэтому после первого v > x дорожка прибавляет
+// только +0.0; когда так во всех дорожках, группа досрочно завершается
+void cdfOf(const LaneGroup& group, const double* x, double* out) {
+    double cumulative[kLanes] = {};
+    for (std::size_t k = 0; k < group.atoms; ++k) {
+        const double* v = group.values + k * kLanes;
+        const double* p = group.probabilities + k * kLanes;
+        double inside = 0.0;
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            double below = static_cast<double>(v[lane] <= x[lane]);
+            cumulative[lane] += p[lane] * below;
+            inside += below;
+        }
+        if (inside == 0.0) break;
+    }
+    for (std::size_t lane = 0; lane < group.lanes; ++lane) {
+        out[group.rows[lane]] = std::min(cumulative[lane], 1.0);
+    }
+}
+
+// Ответ - атом с номером, равным числу префиксных сумм меньше level; если сумма
+// не дотянула до level из-за округления - последний атом (повтор в дополнении)
+void quantileOf(const LaneGroup& group, double level, double* out) {
+    double cumulative[kLanes] = {};
+    double below[kLanes] = {};
+    for (std::size_t k = 0; k < group.atoms; ++k) {
+        const double* p = group.probabilities + k * kLanes;
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            cumulative[lane] += p[lane];
+            below[lane] += static_cast<double>(cumulative[lane] < level);
+        }
+    }
+    for (std::size_t lane = 0; lane < group.lanes; ++lane) {
+        std::size_t k = std::min(static_cast<std::size_t>(below[lane]), group.atoms - 1);
+        out[group.rows[lane]] = group.values[k * kLanes + lane];
+    }
+}
+
+// Группы делятся между потоками
+template <typename Kernel>
+void forEachGroup(const LaneLayout& layout, std::size_t distributions, Kernel kernel) {
+    parallelFor(layout.groups(), kMinDistributionsPerThread / kLanes, [&](std::size_t first, std::size_t last) {
+        for (std::size_t g = first; g < last; ++g) {
+            std::size_t offset = layout.groupOffsets[g];
+            LaneGroup group = {layout.values.data() + offset, layout.probabilities.data() + offset,
+                               layout.rows.data() + g * kLanes, (layout.groupOffsets[g + 1] - offset) / kLanes,
+                               std::min(kLanes, distributions - g * kLanes)};
+            kernel(group);
+        }
+    });
+}
+}
+
+RandomVariableBatch::RandomVariableBatch() : offsets(1, 0) {}
+
+void RandomVariableBatch::reserve(std::size_t distributions, std::size_t atoms) {
+    offsets.reserve(distributions + 1);
+    values.reserve(atoms);
+    probabilities.reserve(atoms);
+}
+
+void RandomVariableBatch::clear() {
+    layout.reset();
+    values.clear();
+    probabilities.clear();
+    offsets.assign(1, 0);
+}
+
+std::size_t RandomVariableBatch::add(const DiscreteRandomVariable& rv) {
+    layout.reset();
+    // Распределение уже проверено и упорядочено
+    for (const auto& pair : rv.getDistribution()) {
+        values.push_back(pair.first);
+        probabilities.push_back(pair.second);
+    }
+    offsets.push_back(values.size());
+    return size() - 1;
+}
+
+std::size_t RandomVariableBatch::add(AtomSpan atoms) {
+    layout.reset();
+    for (const auto& pair : atoms) {
+        values.push_back(pair.first);
+        probabilities.push_back(pair.second);
+    }
+    offsets.push_back(values.size());
+
+    try {
+        validateLast();
+    } catch (...) {
+        offsets.pop_back();
+        values.resize(offsets.back());
+        probabilities.resize(offsets.back());
+        throw;
+    }
+    return size() - 1;
+}
+
+void RandomVariableBatch::validateLast() {
+    std::size_t begin = offsets[offsets.size() - 2];
+    std::size_t end = offsets.back();
+    if (begin == end) {
+        throw std::invalid_argument("Distribution cannot be empty");
+    }
+
+    if (!std::is_sorted(values.begin() + begin, values.begin() + end)) {
+        std::vector<std::pair<double, double>> atoms;
+        atoms.reserve(end - begin);
+        for (std::size_t k = begin; k < end; ++k) {
+            atoms.push_back({values[k], probabilities[k]});
+        }
+        std::sort(atoms.begin(), atoms.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (std::size_t k = begin; k < end; ++k) {
+            values[k] = atoms[k - begin].first;
+            probabilities[k] = atoms[k - begin].second;
+        }
+    }
+
+    if (std::adjacent_find(values.begin() + begin, values.begin() + end) != values.begin() + end) {
+        throw std::invalid_argument("All values must be unique");
+    }
+
+    double total = 0.0;
+    for (std::size_t k = begin; k < end; ++k) {
+        if (probabilities[k] < 0) {
+            throw std::invalid_argument("Probabilities cannot be negative");
+        }
+        total += probabilities[k];
+    }
+    if (std::abs(total - 1.0) > 1e-10) {
+        for (std::size_t k = begin; k < end; ++k) {
+            probabilities[k] /= total;
+        }
+    }
+}
+
+DiscreteRandomVariable RandomVariableBatch::get(std::size_t i) const {
+    std::vector<std::pair<double, double>> dist;
+    dist.reserve(atomCount(i));
+    for (std::size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+        dist.push_back({values[k], probabilities[k]});
+    }
+    return DiscreteRandomVariable(std::move(dist));
+}
+
+std::shared_ptr<const RandomVariableBatch::LaneLayout> RandomVariableBatch::laneLayout() const {
+    std::shared_ptr<const LaneLayout> current = std::atomic_load(&layout);
+    if (current) {
+        return current;
+    }
+
+    // Одновременные первые запросы могут построить макет дважды - результат одинаков
+    auto built = std::make_shared<LaneLayout>();
+    std::size_t n = size();
+    std::size_t groups = (n + kLanes - 1) / kLanes;
+    built->rows.resize(n);
+    for (std::size_t i = 0; i < n; ++i) built->rows[i] = i;
+    for (std::size_t first = 0; first < n; first += kSortWindow) {
+        std::stable_sort(built->rows.begin() + first, built->rows.begin() + std::min(n, first + kSortWindow),
+            [this](std::size_t a, std::size_t b) { return atomCount(a) > atomCount(b); });
+    }
+    built->rows.resize(groups * kLanes, 0);
+
+    built->groupOffsets.resize(groups + 1, 0);
+    for (std::size_t g = 0; g < groups; ++g) {
+        // Длиннейшее распределение группы - первое после сортировки
+        built->groupOffsets[g + 1] = built->groupOffsets[g] + atomCount(built->rows[g * kLanes]) * kLanes;
+    }
+    built->values.resize(built->groupOffsets.back());
+    built->probabilities.resize(built->groupOffsets.back());
+
+    parallelFor(groups, kMinDistributionsPerThread / kLanes, [&](std::size_t first, std::size_t last) {
+        for (std::size_t g = first; g < last; ++g) {
+            double* v = built->values.data() + built->groupOffsets[g];
+            double* p = built->probabilities.data() + built->groupOffsets[g];
+            std::size_t atoms = (built->groupOffsets[g + 1] - built->groupOffsets[g]) / kLanes;
+            for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                // Свободные дорожки последней группы повторяют ее первое распределение
+                std::size_t i = g * kLanes + lane < n ? built->rows[g * kLanes + lane] : built->rows[g * kLanes];
+                std::size_t count = g * kLanes + lane < n ? atomCount(i) : 0;
+                for (std::size_t k = 0; k < atoms; ++k) {
+                    v[k * kLanes + lane] = valuesOf(i)[std::min(k, atomCount(i) - 1)];
+                    p[k * kLanes + lane] = k < count ? probabilitiesOf(i)[k] : 0.0;
+                }
+            }
+        }
+    });
+
+    std::atomic_store(&layout, std::shared_ptr<const LaneLayout>(std::move(built)));
+    return std::atomic_load(&layout);
+}
+
+std::vector<DistributionMoments> RandomVariableBatch::moments() const {
+    std::vector<DistributionMoments> result(size());
+    forEachGroup(*laneLayout(), size(), [&](const LaneGroup& group) {
+        momentsOf(group, result.data());
+    });
+    return result;
+}
+
+std::vector<double> RandomVariableBatch::cdf(double x) const {
+    std::vector<double> result(size());
+    double points[kLanes];
+    std::fill(points, points + kLanes, x);
+    forEachGroup(*laneLayout(), size(), [&](const LaneGroup& group) {
+        cdfOf(group, points, result.data());
+    });
+    return result;
+}
+
+std::vector<double> RandomVariableBatch::cdf(const std::vector<double>& points) const {
+    if (points.size() != size()) {
+        throw std::invalid_argument("Expected one point per distribution");
+    }
+    std::vector<double> result(size());
+    forEachGroup(*laneLayout(), size(), [&](const LaneGroup& group) {
+        double x[kLanes] = {};
+        for (std::size_t lane = 0; lane < group.lanes; ++lane) {
+            x[lane] = points[group.rows[lane]];
+        }
+        cdfOf(group, x, result.data());
+    });
+    return result;
+}
+
+std::vector<double> RandomVariableBatch::quantile(double p) const {
+    if (!(p >= 0.0 && p <= 1.0)) {
+        throw std::invalid_argument("Quantile level must be in [0, 1]");
+    }
+    std::vector<double> result(size());
+    forEachGroup(*laneLayout(), size(), [&](const LaneGroup& group) {
+        quantileOf(group, p, result.data());
+    });
+    return result;
+}
+
+RandomVariableBatch RandomVariableBatch::pairwiseSum(const RandomVariableBatch& other) const {
+    if (size() != other.size()) {
+        throw std::invalid_argument("Batches must contain the same number of distributions");
+    }
+
+    // Каждый кусок собирает свой фрагмент CSR, затем фрагменты склеиваются по порядку
+    std::size_t n = size();
+    std::size_t pieces = std::max<std::size_t>(1, std::min<std::size_t>(4 * hardwareThreads(), n / kMinDistributionsPerThread));
+    std::vector<RandomVariableBatch> parts(pieces);
+
+    parallelFor(pieces, 1, [&](std::size_t firstPiece, std::size_t lastPiece) {
+        ValueAccumulator accumulator;
+        for (std::size_t piece = firstPiece; piece < lastPiece; ++piece) {
+            RandomVariableBatch& part = parts[piece];
+            for (std::size_t i = n * piece / pieces; i < n * (piece + 1) / pieces; ++i) {
+                const double* av = valuesOf(i);
+                const double* ap = probabilitiesOf(i);
+                const double* bv = other.valuesOf(i);
+                const double* bp = other.probabilitiesOf(i);
+                std::size_t na = atomCount(i);
+                std::size_t nb = other.atomCount(i);
+
+                accumulator.reset(na + nb);
+                for (std::size_t a = 0; a < na; ++a) {
+                    for (std::size_t b = 0; b < nb; ++b) {
+                        accumulator.add(av[a] + bv[b], ap[a] * bp[b]);
+                    }
+                }
+                accumulator.sortByValue();
+
+                // Нормировка - как в DiscreteRandomVariable::validateDistribution
+                double total = 0.0;
+                for (std::size_t k = 0; k < accumulator.size(); ++k) {
+                    total += accumulator.probability(k);
+                }
+                bool normalize = std::abs(total - 1.0) > 1e-10;
+                for (std::size_t k = 0; k < accumulator.size(); ++k) {
+                    part.values.push_back(accumulator.value(k));
+                    part.probabilities.push_back(normalize ? accumulator.probability(k) / total
+                                                           : accumulator.probability(k));
+                }
+                part.offsets.push_back(part.values.size());
+            }
+        }
+    });
+
+    RandomVariableBatch result;
+    std::size_t totalAtoms = 0;
+    for (const auto& part : parts) totalAtoms += part.totalAtoms();
+    result.reserve(n, totalAtoms);
+    for (const auto& part : parts) {
+        std::size_t base = result.values.size();
+        result.values.insert(result.values.end(), part.values.begin(), part.values.end());
+        result.probabilities.insert(result.probabilities.end(), part.probabilities.begin(), part.probabilities.end());
+        for (std::size_t k = 1; k < part.offsets.size(); ++k) {
+            result.offsets.push_back(base + part.offsets[k]);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,178 @@
+#include "../include/plot_geometry.h"
+#include "../include/plot_renderer.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ptms-render-bench: время кадра для путей glBegin/glEnd и массивов вершин.
+// Окно создается скрытым; без дисплея запускается через Xvfb с программным
+// растеризатором Mesa:
+//   xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ptms-render-bench --atoms 1000000
+
+namespace {
+
+void printUsage(std::ostream& out) {
+    out << "Usage: ptms-render-bench [options]\n"
+           "\n"
+           "Options:\n"
+           "  --atoms n      support size of the random distribution (default 100000)\n"
+           "  --frames n     frames timed per view and path (default 100)\n"
+           "  --width n      framebuffer width (default 800)\n"
+           "  --height n     framebuffer height (default 600)\n"
+           "  --decimate     reduce the support to pixel columns, as the visualizer does\n";
+}
+
+std::size_t parseCount(const std::string& text) {
+    std::size_t used = 0;
+    unsigned long long value = 0;
+    try {
+        value = std::stoull(text, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != text.size() || value == 0) {
+        throw std::invalid_argument("Invalid number: " + text);
+    }
+    return static_cast<std::size_t>(value);
+}
+
+// Случайные вероятности на равномерной сетке значений
+DiscreteRandomVariable randomDistribution(std::size_t atoms) {
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> weight(0.5, 1.5);
+    std::vector<std::pair<double, double>> dist(atoms);
+    double total = 0.0;
+    for (std::size_t i = 0; i < atoms; ++i) {
+        dist[i] = {static_cast<double>(i), weight(generator)};
+        total += dist[i].second;
+    }
+    for (auto& atom : dist) {
+        atom.second /= total;
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+struct Timing {
+    double mean; // мс
+    double best; // мс
+};
+
+Timing timeFrames(const PlotRenderer& renderer, int view, PlotRenderer::Path path, std::size_t frames) {
+    using Clock = std::chrono::steady_clock;
+    // Первый кадр прогревает драйвер и не учитывается
+    std::vector<double> samples;
+    samples.reserve(frames);
+    for (std::size_t frame = 0; frame <= frames; ++frame) {
+        auto start = Clock::now();
+        glClear(GL_COLOR_BUFFER_BIT);
+        renderer.draw(view, path);
+        glFinish();
+        double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (frame > 0) samples.push_back(elapsed);
+    }
+
+    double total = 0.0;
+    for (double sample : samples) total += sample;
+    return {total / static_cast<double>(samples.size()), *std::min_element(samples.begin(), samples.end())};
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t atoms = 100000;
+    std::size_t frames = 100;
+    int width = 800;
+    int height = 600;
+    bool decimate = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--decimate") {
+                decimate = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            std::string value = argv[++i];
+            if (arg == "--atoms") {
+                atoms = parseCount(value);
+            } else if (arg == "--frames") {
+                frames = parseCount(value);
+            } else if (arg == "--width") {
+                width = static_cast<int>(parseCount(value));
+            } else if (arg == "--height") {
+                height = static_cast<int>(parseCount(value));
+            } else {
+                throw std::invalid_argument("Unknown option: " + arg);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ptms-render-bench: " << e.what() << "\n\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    if (!glfwInit()) {
+        std::cerr << "ptms-render-bench: failed to initialize GLFW" << std::endl;
+        return 1;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(width, height, "ptms-render-bench", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "ptms-render-bench: failed to create an OpenGL context" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+
+    int status = 0;
+    {
+        DiscreteRandomVariable rv = randomDistribution(atoms);
+        auto range = plot_geometry::valueRange(rv);
+        std::size_t columns = decimate ? static_cast<std::size_t>(width) * 2 / 3 : 0;
+
+        PlotRenderer renderer(glfwGetProcAddress);
+        renderer.setGeometry(plot_geometry::build(rv, {range.first, range.second, columns}));
+
+        glViewport(0, 0, width, height);
+        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+        glOrtho(-0.1, 1.1, -0.1, 1.1, -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+
+        std::cout << "renderer: " << glGetString(GL_RENDERER) << "\n"
+                  << "atoms: " << atoms << (decimate ? " (decimated)" : "") << ", " << width << "x" << height
+                  << ", " << frames << " frames\n"
+                  << "vertex path: " << (renderer.usesBufferObjects() ? "buffer objects" : "client arrays") << "\n\n";
+
+        const char* views[] = {"law", "polyline", "cdf"};
+        std::printf("%-10s %16s %16s %10s\n", "view", "immediate ms", "vertex array ms", "speedup");
+        for (int view = 0; view < 3; ++view) {
+            Timing immediate = timeFrames(renderer, view, PlotRenderer::Path::Immediate, frames);
+            Timing arrays = timeFrames(renderer, view, PlotRenderer::Path::VertexArrays, frames);
+            std::printf("%-10s %8.3f (%5.3f) %8.3f (%5.3f) %9.1fx\n", views[view], immediate.mean, immediate.best,
+                        arrays.mean, arrays.best, immediate.mean / arrays.mean);
+            // Ошибка GL в любом из путей - неудача прогона (ctest render_benchmark_test)
+            GLenum error = glGetError();
+            if (error != GL_NO_ERROR) {
+                std::fprintf(stderr, "ptms-render-bench: OpenGL error 0x%04x in view %s\n", error, views[view]);
+                status = 1;
+            }
+        }
+        std::printf("\nmean (best) frame time\n");
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return status;
+}
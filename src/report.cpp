@@ -0,0 +1,224 @@
+#include "../include/report.h"
+#include "../include/plot_image.h"
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+
+// Цвета и размеры - как у PlotRenderer и plot_image
+const char* const kLawColor = "#3366cc";
+const char* const kPolylineColor = "#cc3333";
+const char* const kPolylinePointsColor = "#3333cc";
+const char* const kCdfColor = "#339933";
+const double kPointSize = 6.0;
+
+const char* const kStyle =
+    "body{font-family:sans-serif;margin:24px;color:#222}"
+    "section{border-top:1px solid #ccc;padding:12px 0}"
+    "h2{font-size:15px;margin:0 0 8px;word-break:break-all}"
+    "table{border-collapse:collapse;margin-bottom:8px}"
+    "th,td{padding:2px 12px 2px 0;text-align:left;font-size:13px}"
+    "svg{margin-right:8px;border:1px solid #eee}"
+    ".error{color:#b00}";
+
+void appendInteger(std::string& out, std::size_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Координаты SVG - с одним знаком после точки
+void appendCoordinate(std::string& out, double value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 1);
+    out.append(buffer, result.ptr);
+}
+
+// Статистики - шесть значащих цифр, как удобно читать в отчете
+void appendStatistic(std::string& out, double value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+    out.append(buffer, result.ptr);
+}
+
+void appendEscaped(std::string& out, const std::string& text) {
+    for (char c : text) {
+        switch (c) {
+            case '&':
+                out += "&amp;";
+                break;
+            case '<':
+                out += "&lt;";
+                break;
+            case '>':
+                out += "&gt;";
+                break;
+            case '"':
+                out += "&quot;";
+                break;
+            default:
+                out.push_back(c);
+        }
+    }
+}
+
+// Перевод координат проекции glOrtho(-0.1, 1.1, -0.1, 1.1) в пиксели
+struct PixelMapping {
+    double width;
+    double height;
+
+    double x(float value) const { return (value + 0.1) / 1.2 * width; }
+    double y(float value) const { return (1.1 - value) / 1.2 * height; }
+};
+
+void appendPair(std::string& out, double x, double y) {
+    appendCoordinate(out, x);
+    out.push_back(',');
+    appendCoordinate(out, y);
+}
+
+void appendPolyline(std::string& out, const std::vector<PlotVertex>& vertices, const PixelMapping& map,
+                    const char* color) {
+    out += "<polyline fill=\"none\" stroke-width=\"2\" stroke=\"";
+    out += color;
+    out += "\" points=\"";
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        if (i) out.push_back(' ');
+        appendPair(out, map.x(vertices[i].x), map.y(vertices[i].y));
+    }
+    out += "\"/>";
+}
+
+// Квадратные точки одним контуром; step - шаг по массиву вершин
+void appendPoints(std::string& out, const std::vector<PlotVertex>& vertices, std::size_t first, std::size_t step,
+                  const PixelMapping& map, const char* color) {
+    out += "<path fill=\"";
+    out += color;
+    out += "\" d=\"";
+    for (std::size_t i = first; i < vertices.size(); i += step) {
+        out.push_back('M');
+        appendPair(out, map.x(vertices[i].x) - kPointSize / 2, map.y(vertices[i].y) - kPointSize / 2);
+        out += "h6v6h-6z";
+    }
+    out += "\"/>";
+}
+
+}
+
+namespace report {
+
+std::string svgPlot(const PlotGeometry& geometry, int view, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Image size must be positive");
+    }
+    if (view < 0 || view > 2) {
+        throw std::invalid_argument("Unknown plot view");
+    }
+    PixelMapping map{static_cast<double>(width), static_cast<double>(height)};
+
+    std::string out = "<svg xmlns=\"http://www.w3.org/2000/svg\" shape-rendering=\"crispEdges\" width=\"";
+    appendInteger(out, static_cast<std::size_t>(width));
+    out += "\" height=\"";
+    appendInteger(out, static_cast<std::size_t>(height));
+    out += "\">";
+
+    switch (view) {
+        case 0:
+            if (!geometry.stems.empty()) {
+                out += "<path fill=\"none\" stroke-width=\"2\" stroke=\"";
+                out += kLawColor;
+                out += "\" d=\"";
+                for (std::size_t i = 0; i + 1 < geometry.stems.size(); i += 2) {
+                    out.push_back('M');
+                    appendPair(out, map.x(geometry.stems[i].x), map.y(geometry.stems[i].y));
+                    out.push_back('V');
+                    appendCoordinate(out, map.y(geometry.stems[i + 1].y));
+                }
+                out += "\"/>";
+                appendPoints(out, geometry.stems, 1, 2, map, kLawColor);
+            }
+            break;
+        case 1:
+            if (!geometry.points.empty()) {
+                appendPolyline(out, geometry.points, map, kPolylineColor);
+                appendPoints(out, geometry.points, 0, 1, map, kPolylinePointsColor);
+            }
+            break;
+        case 2:
+            if (!geometry.cdf.empty()) {
+                appendPolyline(out, geometry.cdf, map, kCdfColor);
+            }
+            break;
+    }
+
+    // Оси
+    out += "<path fill=\"none\" stroke=\"#000\" stroke-width=\"1\" d=\"M";
+    appendPair(out, map.x(0.0f), map.y(0.0f));
+    out.push_back('H');
+    appendCoordinate(out, map.x(1.0f));
+    out.push_back('M');
+    appendPair(out, map.x(0.0f), map.y(0.0f));
+    out.push_back('V');
+    appendCoordinate(out, map.y(1.0f));
+    out += "\"/></svg>";
+    return out;
+}
+
+std::string htmlHeader(const std::string& title) {
+    std::string out = "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>";
+    appendEscaped(out, title);
+    out += "</title><style>";
+    out += kStyle;
+    out += "</style></head><body>\n<h1>";
+    appendEscaped(out, title);
+    out += "</h1>\n";
+    return out;
+}
+
+void appendSection(std::string& out, const std::string& name, const DiscreteRandomVariable& rv, int plotWidth,
+                   int plotHeight) {
+    AtomSpan atoms = rv.atoms();
+    DistributionMoments moments = atoms.empty() ? DistributionMoments{0.0, 0.0, 0.0, 0.0} : atoms.moments();
+    auto range = plot_geometry::valueRange(rv);
+    PlotGeometry geometry =
+        plot_geometry::build(rv, {range.first, range.second, plot_image::plotColumns(plotWidth)});
+
+    out += "<section><h2>";
+    appendEscaped(out, name);
+    out += "</h2><table><tr><th>Atoms</th><th>E[X]</th><th>Var[X]</th><th>Skew</th><th>Kurt</th></tr><tr><td>";
+    appendInteger(out, atoms.size());
+    double fields[] = {moments.expectation, moments.variance, moments.skewness, moments.kurtosis};
+    for (double field : fields) {
+        out += "</td><td>";
+        appendStatistic(out, field);
+    }
+    out += "</td></tr></table>\n";
+    for (int view = 0; view < 3; ++view) {
+        out += svgPlot(geometry, view, plotWidth, plotHeight);
+        out.push_back('\n');
+    }
+    out += "</section>\n";
+}
+
+void appendErrorSection(std::string& out, const std::string& name, const std::string& error) {
+    out += "<section><h2>";
+    appendEscaped(out, name);
+    out += "</h2><p class=\"error\">";
+    appendEscaped(out, error);
+    out += "</p></section>\n";
+}
+
+std::string htmlFooter(std::size_t entries, std::size_t failures) {
+    std::string out = "<footer><p>";
+    appendInteger(out, entries);
+    out += entries == 1 ? " distribution" : " distributions";
+    if (failures > 0) {
+        out += ", ";
+        appendInteger(out, failures);
+        out += " failed to load";
+    }
+    out += "</p></footer>\n</body></html>\n";
+    return out;
+}
+
+}
@@ -0,0 +1,182 @@
+#include "../include/text_format.h"
+#include "../include/mapped_file.h"
+#include "../include/parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// Минимальный объем, ради которого стоит запускать отдельный поток разбора
+const std::size_t kParseChunkBytes = 1 << 20;
+// Максимальная длина кратчайшего представления double
+const std::size_t kMaxDoubleChars = 24;
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+const char* skipBlanks(const char* p, const char* end) {
+    while (p != end && isBlank(*p)) ++p;
+    return p;
+}
+
+const char* lineEnd(const char* p, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    return newline ? newline : end;
+}
+
+std::size_t countLines(const char* begin, const char* end) {
+    return static_cast<std::size_t>(std::count(begin, end, '\n'));
+}
+
+// Разбирает одну строку; false - строку нужно пропустить, исключение - ошибка формата
+bool parseLine(const char* p, const char* end, char delimiter, std::pair<double, double>& atom) {
+    p = skipBlanks(p, end);
+    while (end != p && (end[-1] == '\r' || isBlank(end[-1]))) --end;
+    if (p == end || *p == '#') {
+        return false;
+    }
+
+    auto value = std::from_chars(p, end, atom.first);
+    if (value.ec != std::errc()) {
+        throw std::invalid_argument("Invalid value");
+    }
+    p = skipBlanks(value.ptr, end);
+    if (p == end || *p != delimiter) {
+        throw std::invalid_argument("Expected delimiter");
+    }
+    p = skipBlanks(p + 1, end);
+
+    auto probability = std::from_chars(p, end, atom.second);
+    if (probability.ec != std::errc() || probability.ptr != end) {
+        throw std::invalid_argument("Invalid probability");
+    }
+    return true;
+}
+
+void parseRange(const char* begin, const char* end, char delimiter, const char* origin,
+                std::vector<std::pair<double, double>>& out) {
+    const char* p = begin;
+    while (p < end) {
+        const char* eol = lineEnd(p, end);
+        std::pair<double, double> atom;
+        try {
+            if (parseLine(p, eol, delimiter, atom)) {
+                out.push_back(atom);
+            }
+        } catch (const std::invalid_argument& e) {
+            throw std::invalid_argument(std::string(e.what()) + " at line " +
+                                        std::to_string(countLines(origin, p) + 1));
+        }
+        p = eol + 1;
+    }
+}
+
+}
+
+namespace text_format {
+
+void appendNumber(std::string& out, double value) {
+    char buffer[kMaxDoubleChars];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+std::vector<std::pair<double, double>> parseCSV(const char* data, std::size_t size, char delimiter) {
+    const char* begin = data;
+    const char* end = data + size;
+
+    // Заголовок: первая содержательная строка, не начинающаяся с числа
+    const char* p = begin;
+    while (p < end) {
+        const char* eol = lineEnd(p, end);
+        const char* first = skipBlanks(p, eol);
+        if (first != eol && *first != '#' && *first != '\r') {
+            double probe;
+            if (std::from_chars(first, eol, probe).ec != std::errc()) {
+                begin = eol + 1 < end ? eol + 1 : end;
+            }
+            break;
+        }
+        p = eol + 1;
+    }
+
+    // Границы кусков сдвигаются к началу следующей строки
+    std::size_t pieces = std::max<std::size_t>(1, static_cast<std::size_t>(end - begin) / kParseChunkBytes);
+    pieces = std::min<std::size_t>(pieces, 4 * hardwareThreads());
+    std::vector<const char*> bounds(pieces + 1, end);
+    bounds[0] = begin;
+    for (std::size_t i = 1; i < pieces; ++i) {
+        const char* target = begin + (end - begin) * i / pieces;
+        target = std::max(target, bounds[i - 1]);
+        const char* eol = lineEnd(target, end);
+        bounds[i] = eol == end ? end : eol + 1;
+    }
+
+    std::vector<std::vector<std::pair<double, double>>> parts(pieces);
+    parallelFor(pieces, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            // Строка CSV занимает не меньше 4 байт
+            parts[i].reserve(static_cast<std::size_t>(bounds[i + 1] - bounds[i]) / 4);
+            parseRange(bounds[i], bounds[i + 1], delimiter, data, parts[i]);
+        }
+    });
+
+    if (pieces == 1) {
+        return std::move(parts[0]);
+    }
+    std::size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    std::vector<std::pair<double, double>> result;
+    result.reserve(total);
+    for (const auto& part : parts) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
+
+DiscreteRandomVariable readCSV(const std::string& path, char delimiter) {
+    MappedFile file(path);
+    return DiscreteRandomVariable(parseCSV(reinterpret_cast<const char*>(file.data()), file.size(), delimiter));
+}
+
+void appendCSV(std::string& out, AtomSpan atoms, char delimiter) {
+    out.reserve(out.size() + atoms.size() * (2 * kMaxDoubleChars + 2));
+    for (const auto& atom : atoms) {
+        appendNumber(out, atom.first);
+        out.push_back(delimiter);
+        appendNumber(out, atom.second);
+        out.push_back('\n');
+    }
+}
+
+std::string formatCSV(AtomSpan atoms, char delimiter) {
+    std::string out;
+    appendCSV(out, atoms, delimiter);
+    return out;
+}
+
+void writeCSV(const std::string& path, AtomSpan atoms, char delimiter) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+
+    // Пишем кусками, чтобы не держать весь текст в памяти
+    const std::size_t chunkAtoms = 1 << 16;
+    std::string buffer;
+    for (std::size_t offset = 0; offset < atoms.size(); offset += chunkAtoms) {
+        buffer.clear();
+        std::size_t count = std::min(chunkAtoms, atoms.size() - offset);
+        appendCSV(buffer, AtomSpan(atoms.data() + offset, count), delimiter);
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+    if (!file) {
+        throw std::runtime_error("Failed to write distribution");
+    }
+}
+
+}
@@ -0,0 +1,274 @@
+#include "../include/tracing.h"
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Event {
+    const char* name;
+    const char* category;
+    std::uint64_t start;    // нс от начала записи
+    std::uint64_t duration; // нс
+    std::uint32_t thread;
+};
+
+// Кольцо одного потока: пишет владелец, читает фоновый поток (SPSC)
+const std::size_t kRingSize = 32768; // ~1.3 МБ на поток
+// Период сброса: 32768 событий за 20 мс - запас для самых частых областей
+const auto kFlushPeriod = std::chrono::milliseconds(20);
+
+struct Ring {
+    Event events[kRingSize];
+    std::atomic<std::uint64_t> head{0};
+    std::atomic<std::uint64_t> tail{0};
+};
+
+std::atomic<bool> enabled{false};
+std::atomic<std::uint64_t> dropped{0};
+std::atomic<std::uint32_t> nextThread{1};
+// Начало текущей записи, нс steady_clock; области читают его без блокировки
+std::atomic<std::uint64_t> epoch{0};
+
+// Кольца не удаляются; кольцо завершившегося потока достается следующему,
+// поэтому номер потока хранится в каждом событии
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring*> free;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+struct RingHandle {
+    Ring* ring;
+    std::uint32_t thread;
+
+    RingHandle() : thread(nextThread.fetch_add(1)) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.free.empty()) {
+            ring = r.free.back();
+            r.free.pop_back();
+        } else {
+            r.rings.push_back(std::make_unique<Ring>());
+            ring = r.rings.back().get();
+        }
+    }
+
+    ~RingHandle() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.free.push_back(ring);
+    }
+};
+
+// Состояние записи; меняется только start()/stop() под controlMutex
+struct Session {
+    std::mutex controlMutex;
+    std::ofstream file;
+    std::thread flusher;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    bool firstEvent = true;
+    std::string buffer;
+
+    // Выход из программы без stop() (например, по ошибке) завершает запись
+    ~Session();
+};
+
+Session& session() {
+    // Реестр создается раньше и поэтому разрушается позже сессии
+    registry();
+    static Session instance;
+    return instance;
+}
+
+std::uint64_t now() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+void appendInteger(std::string& out, std::uint64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void appendMicroseconds(std::string& out, std::uint64_t nanoseconds) {
+    appendInteger(out, nanoseconds / 1000);
+    unsigned fraction = static_cast<unsigned>(nanoseconds % 1000);
+    char digits[4] = {'.', static_cast<char>('0' + fraction / 100), static_cast<char>('0' + fraction / 10 % 10),
+                      static_cast<char>('0' + fraction % 10)};
+    out.append(digits, sizeof(digits));
+}
+
+void appendString(std::string& out, const char* text) {
+    out += '"';
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') out += '\\';
+        out += *text;
+    }
+    out += '"';
+}
+
+// Забирает события из всех колец в буфер и дописывает его в файл
+void drain(Session& s) {
+    Registry& r = registry();
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& ring : r.rings) rings.push_back(ring.get());
+    }
+
+    s.buffer.clear();
+    for (Ring* ring : rings) {
+        std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        std::uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const Event& event = ring->events[tail % kRingSize];
+            s.buffer += s.firstEvent ? "\n" : ",\n";
+            s.firstEvent = false;
+            s.buffer += "{\"name\":";
+            appendString(s.buffer, event.name);
+            s.buffer += ",\"cat\":";
+            appendString(s.buffer, event.category);
+            s.buffer += ",\"ph\":\"X\",\"pid\":1,\"tid\":";
+            appendInteger(s.buffer, event.thread);
+            s.buffer += ",\"ts\":";
+            appendMicroseconds(s.buffer, event.start);
+            s.buffer += ",\"dur\":";
+            appendMicroseconds(s.buffer, event.duration);
+            s.buffer += '}';
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    s.file.write(s.buffer.data(), static_cast<std::streamsize>(s.buffer.size()));
+}
+
+void flushLoop(Session& s) {
+    std::unique_lock<std::mutex> lock(s.wakeMutex);
+    while (!s.stopping) {
+        s.wake.wait_for(lock, kFlushPeriod, [&s]() { return s.stopping; });
+        lock.unlock();
+        drain(s);
+        lock.lock();
+    }
+}
+
+// Остановка фонового потока и запись окончания файла; вызывается под controlMutex
+void finish(Session& s) {
+    enabled.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(s.wakeMutex);
+        s.stopping = true;
+    }
+    s.wake.notify_one();
+    s.flusher.join();
+
+    drain(s);
+    s.file << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << dropped.load() << "}}\n";
+    s.file.close();
+}
+
+Session::~Session() {
+    std::lock_guard<std::mutex> control(controlMutex);
+    if (enabled.load()) {
+        finish(*this);
+    }
+}
+
+}
+
+namespace tracing {
+
+void start(const std::string& path) {
+    Session& s = session();
+    std::lock_guard<std::mutex> control(s.controlMutex);
+    if (enabled.load()) {
+        throw std::runtime_error("Tracing is already active");
+    }
+    s.file.open(path, std::ios::binary | std::ios::trunc);
+    if (!s.file.is_open()) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+    s.file << "{\"traceEvents\":[";
+
+    // События прошлой записи, не попавшие в файл, отбрасываются
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& ring : r.rings) {
+            ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+    }
+
+    epoch.store(now(), std::memory_order_relaxed);
+    dropped.store(0);
+    s.stopping = false;
+    s.firstEvent = true;
+    enabled.store(true, std::memory_order_release);
+    s.flusher = std::thread(flushLoop, std::ref(s));
+}
+
+void stop() {
+    Session& s = session();
+    std::lock_guard<std::mutex> control(s.controlMutex);
+    if (!enabled.load()) {
+        return;
+    }
+    finish(s);
+    if (!s.file) {
+        s.file.clear();
+        throw std::runtime_error("Failed to write trace");
+    }
+}
+
+bool active() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+std::uint64_t droppedEvents() {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+Scope::Scope(const char* name, const char* category)
+    : name(name), category(category), start(enabled.load(std::memory_order_acquire) ? now() : 0) {}
+
+Scope::~Scope() {
+    // Область, начатая до start() или закончившаяся после stop(), не записывается
+    if (start == 0 || !enabled.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::uint64_t end = now();
+    std::uint64_t base = epoch.load(std::memory_order_relaxed);
+    if (start < base) {
+        return;
+    }
+
+    registry();
+    thread_local RingHandle handle;
+    Ring& ring = *handle.ring;
+    std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= kRingSize) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.events[head % kRingSize] = {name, category, start - base, end - start, handle.thread};
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+}
@@ -0,0 +1,278 @@
+#include "../include/transforms.h"
+#include "../include/lane_math.h"
+#include "../include/parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// Точки считаются пакетами по kLanes: для каждого атома пакет обновляется одним
+// циклом ядер lane_math, который компилятор переводит в SIMD; точки вне диапазона
+// ядер (переполнение, NaN, большие фазы, z <= 0) досчитываются libm после цикла.
+const std::size_t kLanes = 8;
+// Блок точек и блок атомов (2048 атомов - 32 КБ, помещаются в кеш L1/L2)
+const std::size_t kPointBlock = 64;
+const std::size_t kAtomBlock = 2048;
+// Слагаемых на поток: меньшие сетки считаются в вызывающем потоке
+const std::size_t kMinTermsPerThread = 1 << 16;
+
+double power(double x, unsigned order) {
+    double result = 1.0;
+    for (unsigned i = 0; i < order; ++i) result *= x;
+    return result;
+}
+
+// x (x - 1) ... (x - order + 1)
+double fallingFactorial(double x, unsigned order) {
+    double result = 1.0;
+    for (unsigned i = 0; i < order; ++i) result *= x - i;
+    return result;
+}
+
+// Пакеты точек. load - параметры точек пакета, add - вклад одного атома
+// во все точки, store - первые count сумм. Для каждой точки атомы
+// суммируются по порядку, как и при поточечном счете.
+
+// sum_k p_k f(x_k) z^(x_k - order), f - убывающий факториал порядка order.
+// z^y = e^(y ln z): ln z хранится с запасом точности (long double), y ln z
+// раскладывается точно, поэтому погрешность не растет с |y ln z|.
+// z <= 0 и бесконечности считаются std::pow.
+class PowerLanes {
+private:
+    unsigned order;
+    double base[kLanes];
+    double logHigh[kLanes];
+    double logLow[kLanes];
+    std::uint64_t viaPow[kLanes]; // старший бит - точка считается std::pow
+    double sum[kLanes];
+
+public:
+    using Result = double;
+    static constexpr double kPadding = 1.0;
+
+    explicit PowerLanes(unsigned order = 0) : order(order) {}
+
+    void load(const double* points) {
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            double z = points[l];
+            base[l] = z;
+            bool direct = z > 0 && std::isfinite(z);
+            viaPow[l] = direct ? 0 : lane_math::kSignBit;
+            long double logarithm = direct ? std::log(static_cast<long double>(z)) : 0.0L;
+            logHigh[l] = static_cast<double>(logarithm);
+            logLow[l] = static_cast<double>(logarithm - logHigh[l]);
+            sum[l] = 0.0;
+        }
+    }
+
+    void add(double x, double p) {
+        double factor = fallingFactorial(x, order);
+        if (factor == 0.0) {
+            // Слагаемые с нулевым множителем не дают z^{x-k} с отрицательной степенью в нуле
+            for (std::size_t l = 0; l < kLanes; ++l) sum[l] += 0.0 * p;
+            return;
+        }
+        double y = x - order;
+        double term[kLanes];
+        std::uint64_t slow[kLanes];
+        std::uint64_t anySlow = 0;
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            double hi, lo;
+            lane_math::exactProduct(y, logHigh[l], hi, lo);
+            lo += y * logLow[l];
+            term[l] = lane_math::exp(hi, lo);
+            slow[l] = viaPow[l] | lane_math::outside(hi, lane_math::kExpLimit);
+            anySlow |= slow[l];
+        }
+        if (anySlow >> 63) {
+            for (std::size_t l = 0; l < kLanes; ++l) {
+                if (slow[l] >> 63) term[l] = std::pow(base[l], y);
+            }
+        }
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            sum[l] += factor * term[l] * p;
+        }
+    }
+
+    void store(std::size_t count, double* out) const {
+        std::copy(sum, sum + count, out);
+    }
+};
+
+// sum_k p_k x_k^order e^(t x_k)
+class ExpLanes {
+private:
+    unsigned order;
+    double t[kLanes];
+    double sum[kLanes];
+
+public:
+    using Result = double;
+    static constexpr double kPadding = 0.0;
+
+    explicit ExpLanes(unsigned order = 0) : order(order) {}
+
+    void load(const double* points) {
+        std::copy(points, points + kLanes, t);
+        std::fill(sum, sum + kLanes, 0.0);
+    }
+
+    void add(double x, double p) {
+        double factor = power(x, order);
+        double term[kLanes];
+        std::uint64_t anySlow = 0;
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            double a = t[l] * x;
+            term[l] = lane_math::exp(a);
+            anySlow |= lane_math::outside(a, lane_math::kExpLimit);
+        }
+        if (anySlow >> 63) {
+            for (std::size_t l = 0; l < kLanes; ++l) {
+                double a = t[l] * x;
+                if (lane_math::outside(a, lane_math::kExpLimit) >> 63) term[l] = std::exp(a);
+            }
+        }
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            sum[l] += factor * term[l] * p;
+        }
+    }
+
+    void store(std::size_t count, double* out) const {
+        std::copy(sum, sum + count, out);
+    }
+};
+
+// sum_k p_k x_k^order e^(i t x_k); действительная и мнимая части - отдельные суммы
+class CisLanes {
+private:
+    unsigned order;
+    double t[kLanes];
+    double real[kLanes];
+    double imag[kLanes];
+
+public:
+    using Result = std::complex<double>;
+    static constexpr double kPadding = 0.0;
+
+    explicit CisLanes(unsigned order = 0) : order(order) {}
+
+    void load(const double* points) {
+        std::copy(points, points + kLanes, t);
+        std::fill(real, real + kLanes, 0.0);
+        std::fill(imag, imag + kLanes, 0.0);
+    }
+
+    void add(double x, double p) {
+        double factor = power(x, order);
+        double cosine[kLanes], sine[kLanes];
+        std::uint64_t anySlow = 0;
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            double a = t[l] * x;
+            lane_math::sinCos(a, cosine[l], sine[l]);
+            anySlow |= lane_math::outside(a, lane_math::kTrigLimit);
+        }
+        if (anySlow >> 63) {
+            for (std::size_t l = 0; l < kLanes; ++l) {
+                double a = t[l] * x;
+                if (lane_math::outside(a, lane_math::kTrigLimit) >> 63) {
+                    cosine[l] = std::cos(a);
+                    sine[l] = std::sin(a);
+                }
+            }
+        }
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            real[l] += factor * cosine[l] * p;
+            imag[l] += factor * sine[l] * p;
+        }
+    }
+
+    void store(std::size_t count, std::complex<double>* out) const {
+        for (std::size_t l = 0; l < count; ++l) out[l] = std::complex<double>(real[l], imag[l]);
+    }
+};
+
+// Общее ядро: блок из kPointBlock точек (kPointBlock / kLanes пакетов) проходит
+// атомы блоками по kAtomBlock, чтобы блок атомов оставался в кеше
+template <typename Lanes>
+std::vector<typename Lanes::Result> evaluate(AtomSpan atoms, const std::vector<double>& points, const Lanes& lanes) {
+    const std::size_t kPacksPerBlock = kPointBlock / kLanes;
+    std::vector<typename Lanes::Result> result(points.size());
+    std::size_t n = atoms.size();
+    std::size_t packs = (points.size() + kLanes - 1) / kLanes;
+    std::size_t minPacks = std::max<std::size_t>(1, kMinTermsPerThread / std::max<std::size_t>(n * kLanes, 1));
+
+    parallelFor(packs, minPacks, [&](std::size_t first, std::size_t last) {
+        std::array<Lanes, kPacksPerBlock> block;
+        for (std::size_t packBegin = first; packBegin < last; packBegin += kPacksPerBlock) {
+            std::size_t packEnd = std::min(packBegin + kPacksPerBlock, last);
+            for (std::size_t i = packBegin; i < packEnd; ++i) {
+                // Неполный последний пакет дополняется нейтральной точкой
+                double packPoints[kLanes];
+                for (std::size_t l = 0; l < kLanes; ++l) {
+                    std::size_t j = i * kLanes + l;
+                    packPoints[l] = j < points.size() ? points[j] : Lanes::kPadding;
+                }
+                block[i - packBegin] = lanes;
+                block[i - packBegin].load(packPoints);
+            }
+            for (std::size_t atomBegin = 0; atomBegin < n; atomBegin += kAtomBlock) {
+                std::size_t atomEnd = std::min(atomBegin + kAtomBlock, n);
+                for (std::size_t i = packBegin; i < packEnd; ++i) {
+                    Lanes& pack = block[i - packBegin];
+                    for (std::size_t k = atomBegin; k < atomEnd; ++k) {
+                        pack.add(atoms[k].first, atoms[k].second);
+                    }
+                }
+            }
+            for (std::size_t i = packBegin; i < packEnd; ++i) {
+                std::size_t begin = i * kLanes;
+                block[i - packBegin].store(std::min(kLanes, points.size() - begin), result.data() + begin);
+            }
+        }
+    });
+    return result;
+}
+
+}
+
+namespace transforms {
+
+std::vector<double> pgf(AtomSpan atoms, const std::vector<double>& points) {
+    return evaluate(atoms, points, PowerLanes(0));
+}
+
+std::vector<double> pgfDerivative(AtomSpan atoms, const std::vector<double>& points, unsigned order) {
+    return evaluate(atoms, points, PowerLanes(order));
+}
+
+std::vector<double> mgf(AtomSpan atoms, const std::vector<double>& points) {
+    return evaluate(atoms, points, ExpLanes(0));
+}
+
+std::vector<double> mgfDerivative(AtomSpan atoms, const std::vector<double>& points, unsigned order) {
+    return evaluate(atoms, points, ExpLanes(order));
+}
+
+std::vector<std::complex<double>> characteristicFunction(AtomSpan atoms, const std::vector<double>& points) {
+    return evaluate(atoms, points, CisLanes(0));
+}
+
+std::vector<std::complex<double>> characteristicFunctionDerivative(AtomSpan atoms, const std::vector<double>& points,
+                                                                   unsigned order) {
+    // d^k/dt^k E[e^{itX}] = i^k E[X^k e^{itX}]
+    std::vector<std::complex<double>> result = evaluate(atoms, points, CisLanes(order));
+
+    for (auto& value : result) {
+        switch (order % 4) {
+            case 1: value = std::complex<double>(-value.imag(), value.real()); break;
+            case 2: value = -value; break;
+            case 3: value = std::complex<double>(value.imag(), -value.real()); break;
+            default: break;
+        }
+    }
+    return result;
+}
+
+}
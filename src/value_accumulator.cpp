@@ -0,0 +1,114 @@
+#include "../include/value_accumulator.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+// Меньшие наборы целых ключей быстрее сортируются сравнениями
+static const std::size_t kRadixSortThreshold = 256;
+
+template <typename K, typename S>
+BasicValueAccumulator<K, S>::BasicValueAccumulator(std::pmr::memory_resource* resource)
+    : keys(resource), sums(resource), used(resource), slots(resource), order(resource), shift(64) {}
+
+template <typename K, typename S>
+void BasicValueAccumulator<K, S>::reset(std::size_t expected) {
+    // Оценка лишь задает начальный размер; слишком большая не должна занимать память
+    expected = std::min<std::size_t>(expected, std::size_t(1) << 24);
+
+    std::size_t capacity = 16;
+    int bits = 4;
+    while (capacity < 2 * expected) {
+        capacity <<= 1;
+        ++bits;
+    }
+    if (capacity > slots.size()) {
+        slots.clear();
+        slots.resize(capacity, 0);
+        shift = 64 - bits;
+    } else {
+        for (std::uint32_t slot : used) slots[slot] = 0;
+    }
+    keys.clear();
+    sums.clear();
+    used.clear();
+    order.clear();
+}
+
+template <typename K, typename S>
+void BasicValueAccumulator<K, S>::grow() {
+    // Индексы значений хранятся в 32 битах
+    if (keys.size() >= std::numeric_limits<std::uint32_t>::max() - 1) {
+        throw std::length_error("Too many atoms in the result");
+    }
+    std::size_t capacity = 2 * slots.size();
+    slots.clear();
+    slots.resize(capacity, 0);
+    --shift;
+    used.clear();
+    for (std::uint32_t index = 0; index < keys.size(); ++index) {
+        std::size_t slot = emptySlot(keys[index]);
+        slots[slot] = index + 1;
+        used.push_back(static_cast<std::uint32_t>(slot));
+    }
+}
+
+template <typename K, typename S>
+void BasicValueAccumulator<K, S>::sortByValue() {
+    order.resize(keys.size());
+    for (std::uint32_t k = 0; k < order.size(); ++k) order[k] = k;
+    if constexpr (std::is_integral<K>::value) {
+        if (order.size() >= kRadixSortThreshold) {
+            radixSortOrder();
+            return;
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](std::uint32_t x, std::uint32_t y) { return keys[x] < keys[y]; });
+}
+
+template <typename K, typename S>
+void BasicValueAccumulator<K, S>::radixSortOrder() {
+    // LSD по байтам ключа со сдвинутым знаковым битом; байты, одинаковые
+    // у всех ключей (узкий диапазон значений), пропускаются
+    using Entry = std::pair<std::uint64_t, std::uint32_t>;
+    std::size_t n = order.size();
+    std::pmr::memory_resource* resource = keys.get_allocator().resource();
+    std::pmr::vector<Entry> current(n, resource);
+    std::pmr::vector<Entry> next(n, resource);
+
+    // Счетчики на стеке: сортировка не выделяет память вне resource
+    std::size_t counts[8 * 256] = {};
+    for (std::size_t k = 0; k < n; ++k) {
+        std::uint64_t key = static_cast<std::uint64_t>(keys[k]) ^ (1ull << 63);
+        current[k] = {key, static_cast<std::uint32_t>(k)};
+        for (int pass = 0; pass < 8; ++pass) {
+            ++counts[pass * 256 + ((key >> (8 * pass)) & 0xFF)];
+        }
+    }
+
+    for (int pass = 0; pass < 8; ++pass) {
+        std::size_t* count = &counts[pass * 256];
+        std::uint64_t sample = (current[0].first >> (8 * pass)) & 0xFF;
+        if (count[sample] == n) continue;
+
+        std::size_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            std::size_t c = count[digit];
+            count[digit] = offset;
+            offset += c;
+        }
+        for (const Entry& entry : current) {
+            next[count[(entry.first >> (8 * pass)) & 0xFF]++] = entry;
+        }
+        current.swap(next);
+    }
+
+    for (std::size_t k = 0; k < n; ++k) order[k] = current[k].second;
+}
+
+// Поддерживаемые типы ключей и сумм
+template class BasicValueAccumulator<std::int64_t, double>;
+template class BasicValueAccumulator<std::int64_t, long double>;
+template class BasicValueAccumulator<double, double>;
+template class BasicValueAccumulator<double, long double>;
+template class BasicValueAccumulator<long double, double>;
+template class BasicValueAccumulator<long double, long double>;
@@ -1,11 +1,18 @@
 #include "../include/visualizer.h"
+#include "../include/tracing.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 
-Visualizer::Visualizer() : window(nullptr), currentView(0) {}
+Visualizer::Visualizer()
+    : window(nullptr), currentView(0), moments{0.0, 0.0, 0.0, 0.0}, fullRange(0.0, 1.0), visibleRange(0.0, 1.0),
+      dataDirty(true), layoutDirty(true), frameDirty(true), statisticsDirty(true) {}
 
 Visualizer::~Visualizer() {
+    // Буферы удаляются, пока контекст окна еще существует
+    renderer.reset();
     if (window) {
         glfwDestroyWindow(window);
         glfwTerminate();
@@ -26,50 +33,95 @@ bool Visualizer::initialize(int width, int height, const std::string& title) {
     }
     
     glfwMakeContextCurrent(window);
+    glfwSetWindowUserPointer(window, this);
     glfwSetKeyCallback(window, keyCallback);
     glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+    glfwSetScrollCallback(window, scrollCallback);
+    renderer = std::make_unique<PlotRenderer>(glfwGetProcAddress);
     
     // Установка примера распределения
     std::vector<std::pair<double, double>> exampleDist = {
         {1, 0.1}, {2, 0.2}, {3, 0.4}, {4, 0.2}, {5, 0.1}
     };
     rv.setDistribution(exampleDist);
+    dataDirty = true;
     
     return true;
 }
 
 void Visualizer::setRandomVariable(const DiscreteRandomVariable& variable) {
     rv = variable;
+    dataDirty = true;
+    statisticsDirty = true;
+    requestRedraw();
+}
+
+void Visualizer::requestRedraw() {
+    frameDirty = true;
+    // Будит цикл, ожидающий в glfwWaitEvents
+    if (window) glfwPostEmptyEvent();
 }
 
 void Visualizer::run() {
+    // Без событий цикл спит в glfwWaitEvents и не расходует процессор
     while (!glfwWindowShouldClose(window)) {
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
-        
+        if (frameDirty) {
+            frameDirty = false;
+            drawFrame();
+        }
+        if (statisticsDirty) {
+            PTMS_TRACE("statistics", "render");
+            drawStatistics();
+            statisticsDirty = false;
+        }
+        PTMS_TRACE("waitEvents", "render");
+        glfwWaitEvents();
+    }
+}
+
+void Visualizer::drawFrame() {
+    PTMS_TRACE("frame", "render");
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    if (dataDirty) {
+        PTMS_TRACE("moments", "render");
+        AtomSpan atoms = rv.atoms();
+        moments = atoms.empty() ? DistributionMoments{0.0, 0.0, 0.0, 0.0} : atoms.moments();
+        fullRange = plot_geometry::valueRange(rv);
+        visibleRange = fullRange;
+        dataDirty = false;
+        layoutDirty = true;
+    }
+    if (layoutDirty) {
+        // Область графика [0.1, 0.9] занимает 0.8 / 1.2 ширины окна
+        PTMS_TRACE("geometry", "render");
+        auto columns = static_cast<std::size_t>(std::max(width, 1) * 2 / 3);
+        renderer->setGeometry(plot_geometry::build(rv, {visibleRange.first, visibleRange.second, columns}));
+        layoutDirty = false;
+    }
+    {
+        PTMS_TRACE("clear", "render");
+
         glViewport(0, 0, width, height);
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        
+
         setupProjection();
-        
-        switch (currentView) {
-            case 0:
-                drawDistributionLaw();
-                break;
-            case 1:
-                drawPolyline();
-                break;
-            case 2:
-                drawCDF();
-                break;
-        }
-        
+    }
+
+    {
+        PTMS_TRACE("plot", "render");
+        renderer->draw(currentView);
+    }
+
+    {
+        PTMS_TRACE("axes", "render");
         drawAxes();
-        drawStatistics();
-        
+    }
+    {
+        PTMS_TRACE("swapBuffers", "render");
         glfwSwapBuffers(window);
-        glfwPollEvents();
     }
 }
 
@@ -84,6 +136,21 @@ void Visualizer::setupProjection() {
     glLoadIdentity();
 }
 
+void Visualizer::zoom(double cursorX, double factor) {
+    // Значение под курсором остается на месте; отдалить дальше всего носителя нельзя
+    double fullWidth = fullRange.second - fullRange.first;
+    double width = visibleRange.second - visibleRange.first;
+    double newWidth = std::min(width * factor, fullWidth);
+    if (newWidth < fullWidth * 1e-9) return;
+
+    double anchor = visibleRange.first + (cursorX - 0.1) / 0.8 * width;
+    double first = anchor - (anchor - visibleRange.first) * newWidth / width;
+    first = std::max(fullRange.first, std::min(first, fullRange.second - newWidth));
+    visibleRange = {first, first + newWidth};
+    layoutDirty = true;
+    requestRedraw();
+}
+
 void Visualizer::drawAxes() {
     glColor3f(0.0f, 0.0f, 0.0f);
     glLineWidth(1.0f);
@@ -101,110 +168,6 @@ void Visualizer::drawAxes() {
     glEnd();
 }
 
-void Visualizer::drawDistributionLaw() {
-    auto values = rv.getValues();
-    auto probs = rv.getProbabilities();
-    
-    if (values.empty()) return;
-    
-    auto valueRange = getValueRange();
-    auto probRange = getProbabilityRange();
-    
-    double minVal = valueRange.first;
-    double maxVal = valueRange.second;
-    double maxProb = probRange.second;
-    
-    glColor3f(0.2f, 0.4f, 0.8f);
-    glLineWidth(2.0f);
-    
-    for (size_t i = 0; i < values.size(); ++i) {
-        double x = (values[i] - minVal) / (maxVal - minVal) * 0.8 + 0.1;
-        double y = (probs[i] / maxProb) * 0.8;
-        
-        // Вертикальная линия
-        glBegin(GL_LINES);
-        glVertex2f(x, 0.0f);
-        glVertex2f(x, y);
-        glEnd();
-        
-        // Точка сверху
-        glPointSize(6.0f);
-        glBegin(GL_POINTS);
-        glVertex2f(x, y);
-        glEnd();
-    }
-}
-
-void Visualizer::drawPolyline() {
-    auto values = rv.getValues();
-    auto probs = rv.getProbabilities();
-    
-    if (values.empty()) return;
-    
-    auto valueRange = getValueRange();
-    auto probRange = getProbabilityRange();
-    
-    double minVal = valueRange.first;
-    double maxVal = valueRange.second;
-    double maxProb = probRange.second;
-    
-    glColor3f(0.8f, 0.2f, 0.2f);
-    glLineWidth(2.0f);
-    
-    glBegin(GL_LINE_STRIP);
-    for (size_t i = 0; i < values.size(); ++i) {
-        double x = (values[i] - minVal) / (maxVal - minVal) * 0.8 + 0.1;
-        double y = (probs[i] / maxProb) * 0.8;
-        glVertex2f(x, y);
-    }
-    glEnd();
-    
-    glColor3f(0.2f, 0.2f, 0.8f);
-    glPointSize(6.0f);
-    glBegin(GL_POINTS);
-    for (size_t i = 0; i < values.size(); ++i) {
-        double x = (values[i] - minVal) / (maxVal - minVal) * 0.8 + 0.1;
-        double y = (probs[i] / maxProb) * 0.8;
-        glVertex2f(x, y);
-    }
-    glEnd();
-}
-
-void Visualizer::drawCDF() {
-    auto cdf = rv.getCDF();
-    if (cdf.empty()) return;
-    
-    auto valueRange = getValueRange();
-    double minVal = valueRange.first;
-    double maxVal = valueRange.second;
-    
-    glColor3f(0.2f, 0.6f, 0.2f);
-    glLineWidth(2.0f);
-    
-    glBegin(GL_LINE_STRIP);
-    glVertex2f(0.0f, 0.0f);
-    
-    double prevX = 0.0;
-    double prevY = 0.0;
-    
-    for (size_t i = 0; i < cdf.size(); ++i) {
-        double x = (cdf[i].first - minVal) / (maxVal - minVal) * 0.8 + 0.1;
-        double y = cdf[i].second * 0.8;
-        
-        // Горизонтальная линия до текущей точки
-        if (i > 0) {
-            glVertex2f(x, prevY);
-        }
-        
-        glVertex2f(x, y);
-        prevX = x;
-        prevY = y;
-    }
-    
-    glVertex2f(1.0f, 1.0f);
-    glEnd();
-}
-
 void Visualizer::drawText(const std::string& text, double x, double y) {
     // Простая реализация текста с помощью точек
     glColor3f(0.0f, 0.0f, 0.0f);
@@ -233,10 +196,11 @@ void Visualizer::drawStatistics() {
             break;
     }
     
-    stats << "\nE[X] = " << rv.expectation();
-    stats << "  Var[X] = " << rv.variance();
-    stats << "\nSkew = " << rv.skewness();
-    stats << "  Kurt = " << rv.kurtosis();
+    // Моменты посчитаны вместе с геометрией
+    stats << "\nE[X] = " << moments.expectation;
+    stats << "  Var[X] = " << moments.variance;
+    stats << "\nSkew = " << moments.skewness;
+    stats << "  Kurt = " << moments.kurtosis;
     stats << "\nPress SPACE to change view";
     
     // В реальном приложении здесь должна быть реализация вывода текста
@@ -244,34 +208,14 @@ void Visualizer::drawStatistics() {
     std::cout << "\r" << stats.str() << std::flush;
 }
 
-std::pair<double, double> Visualizer::getValueRange() const {
-    auto values = rv.getValues();
-    if (values.empty()) return {0.0, 1.0};
-    
-    double minVal = *std::min_element(values.begin(), values.end());
-    double maxVal = *std::max_element(values.begin(), values.end());
-    
-    // Добавляем немного отступа
-    double range = maxVal - minVal;
-    if (range == 0) range = 1.0;
-    
-    return {minVal - range * 0.1, maxVal + range * 0.1};
-}
-
-std::pair<double, double> Visualizer::getProbabilityRange() const {
-    auto probs = rv.getProbabilities();
-    if (probs.empty()) return {0.0, 1.0};
-    
-    double maxProb = *std::max_element(probs.begin(), probs.end());
-    return {0.0, maxProb * 1.1}; // 10% отступ сверху
-}
-
 void Visualizer::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (action == GLFW_PRESS) {
         Visualizer* visualizer = static_cast<Visualizer*>(glfwGetWindowUserPointer(window));
         
         if (key == GLFW_KEY_SPACE) {
             visualizer->currentView = (visualizer->currentView + 1) % 3;
+            visualizer->statisticsDirty = true;
+            visualizer->requestRedraw();
         } else if (key == GLFW_KEY_ESCAPE) {
             glfwSetWindowShouldClose(window, GLFW_TRUE);
         }
@@ -280,4 +224,25 @@ void Visualizer::keyCallback(GLFWwindow* window, int key, int scancode, int acti
 
 void Visualizer::framebufferSizeCallback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    // Число столбцов геометрии зависит от ширины кадра
+    Visualizer* visualizer = static_cast<Visualizer*>(glfwGetWindowUserPointer(window));
+    visualizer->layoutDirty = true;
+    visualizer->requestRedraw();
+}
+
+void Visualizer::scrollCallback(GLFWwindow* window, double /*xoffset*/, double yoffset) {
+    Visualizer* visualizer = static_cast<Visualizer*>(glfwGetWindowUserPointer(window));
+    double cursorX, cursorY;
+    int width, height;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+    glfwGetWindowSize(window, &width, &height);
+    if (width <= 0) return;
+
+    // Колесо вверх - приблизить; координата курсора переводится в проекцию [-0.1, 1.1]
+    visualizer->zoom(cursorX / width * 1.2 - 0.1, std::pow(0.8, yoffset));
+}
+
+void Visualizer::windowRefreshCallback(GLFWwindow* window) {
+    // Окно перекрывали или восстановили из свернутого состояния
+    static_cast<Visualizer*>(glfwGetWindowUserPointer(window))->requestRedraw();
 }
\ No newline at end of file
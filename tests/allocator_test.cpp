@@ -0,0 +1,105 @@
+#include "../include/random_variable.h"
+#include "test_support.h"
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+// Операторы с арифметикой на арене (monotonic_buffer_resource): в установившемся
+// режиме ни одного обращения ни к ресурсу за ареной, ни к ресурсу по умолчанию
+
+namespace {
+
+// Считает обращения и передает их дальше
+class CallCounter : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        return upstream->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        ++deallocations;
+        upstream->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+
+    explicit CallCounter(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+};
+
+// Распределение с нерешетчатыми значениями: у суммы n * m различных атомов
+DiscreteRandomVariable irregular(std::size_t atoms, double shift) {
+    std::vector<std::pair<double, double>> dist(atoms);
+    for (std::size_t i = 0; i < atoms; ++i) {
+        double x = static_cast<double>(i);
+        dist[i] = {shift + x * x * 1.001, 1.0 + 0.1 * x};
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+// Одна "обработка запроса" целиком на арене
+void request(const DiscreteRandomVariable& a, const DiscreteRandomVariable& b, std::pmr::memory_resource* arena,
+             const DiscreteRandomVariable& expectedSum, const DiscreteRandomVariable& expectedProduct) {
+    DiscreteRandomVariable x(a, arena);
+    DiscreteRandomVariable y(b, arena);
+    DiscreteRandomVariable sum = x + y;
+    DiscreteRandomVariable product = x * y;
+    DiscreteRandomVariable scaled = sum * 0.5;
+    DiscreteRandomVariable twice = scaled + x;
+
+    CHECK(sum.get_allocator().resource() == arena);
+    CHECK(twice.get_allocator().resource() == arena);
+    CHECK(sum.atoms() == expectedSum.atoms());
+    CHECK(product.atoms() == expectedProduct.atoms());
+    CHECK(twice.atoms().size() > sum.atoms().size());
+    CHECK(sum.quantile(0.5) == expectedSum.quantile(0.5));
+    CHECK(sum.cdf(100.0) == expectedSum.cdf(100.0));
+    CHECK(product.variance() == expectedProduct.variance());
+}
+
+}
+
+int main() {
+    DiscreteRandomVariable a = irregular(40, 0.0);
+    DiscreteRandomVariable b = irregular(30, 0.25);
+    DiscreteRandomVariable expectedSum = a + b;
+    DiscreteRandomVariable expectedProduct = a * b;
+    DiscreteRandomVariable smallA = irregular(4, 0.0);
+    DiscreteRandomVariable smallB = irregular(3, 0.5);
+    DiscreteRandomVariable expectedSmallSum = smallA + smallB;
+    std::vector<std::byte> buffer(8 << 20);
+
+    CallCounter defaultCounter(std::pmr::new_delete_resource());
+    std::pmr::memory_resource* previous = std::pmr::set_default_resource(&defaultCounter);
+
+    std::size_t upstreamCalls = 0;
+    for (int i = 0; i < 20; ++i) {
+        CallCounter upstream(std::pmr::null_memory_resource());
+        try {
+            std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), &upstream);
+            request(a, b, &arena, expectedSum, expectedProduct);
+        } catch (const std::bad_alloc&) {
+            CHECK(!"arena exhausted");
+        }
+        upstreamCalls += upstream.allocations;
+    }
+    CHECK(upstreamCalls == 0);
+
+    // До kInlineAtoms атомов операторам не нужна память и без арены
+    for (int i = 0; i < 20; ++i) {
+        DiscreteRandomVariable sum = smallA + smallB;
+        DiscreteRandomVariable product = smallA * smallB;
+        CHECK(sum.atoms() == expectedSmallSum.atoms());
+        CHECK(product.atoms().size() <= DiscreteRandomVariable::kInlineAtoms);
+    }
+
+    std::pmr::set_default_resource(previous);
+    CHECK(defaultCounter.allocations == 0);
+    CHECK(defaultCounter.deallocations == 0);
+    return test_support::finish();
+}
@@ -0,0 +1,134 @@
+#include "../include/compressed_format.h"
+#include "../include/random_variable.h"
+#include "test_support.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Сжатый формат: точное восстановление атомов (в том числе особых значений и
+// нескольких блоков), степень сжатия решетки и отказ на испорченных данных
+
+namespace {
+
+using Atoms = std::vector<std::pair<double, double>>;
+
+DiscreteRandomVariable lattice(std::size_t atoms) {
+    Atoms dist(atoms);
+    for (std::size_t i = 0; i < atoms; ++i) {
+        dist[i] = {0.25 * static_cast<double>(i) - 100.0, 1.0 / static_cast<double>(atoms)};
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+DiscreteRandomVariable randomLaw(std::size_t atoms, unsigned seed) {
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> value(-1e6, 1e6);
+    std::uniform_real_distribution<double> weight(0.1, 1.0);
+    Atoms dist(atoms);
+    for (auto& atom : dist) {
+        atom = {value(generator), weight(generator)};
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+void save(const DiscreteRandomVariable& rv, const std::string& path, bool compressed) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (compressed) {
+        rv.serializeCompressed(file);
+    } else {
+        rv.serialize(file);
+    }
+}
+
+DiscreteRandomVariable load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    DiscreteRandomVariable rv;
+    rv.deserialize(file);
+    return rv;
+}
+
+std::streamoff fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file.tellg();
+}
+
+// Блок напрямую: повторы вероятностей, отрицательные значения, нули, денормализованные числа
+void testBlock() {
+    Atoms atoms = {{-1e308, 0.1}, {-1.0, 0.1}, {-0.0, 0.2}, {std::numeric_limits<double>::denorm_min(), 0.2},
+                   {1.0, 1e-300}, {1.0 + 1e-15, 0.3}, {3.0, 0.3}, {1e308, 0.1}};
+    std::vector<unsigned char> encoded;
+    compressed_format::encodeBlock(atoms.data(), atoms.size(), encoded);
+    Atoms decoded(atoms.size());
+    CHECK(compressed_format::decodeBlock(encoded.data(), encoded.size(), decoded.data(), decoded.size()) == atoms.size());
+    for (std::size_t i = 0; i < atoms.size(); ++i) {
+        CHECK(std::signbit(decoded[i].first) == std::signbit(atoms[i].first));
+        CHECK(decoded[i] == atoms[i]);
+    }
+
+    // Поврежденный блок не читается за пределы буфера
+    for (std::size_t size = 0; size < encoded.size(); ++size) {
+        try {
+            compressed_format::decodeBlock(encoded.data(), size, decoded.data(), decoded.size());
+        } catch (const std::runtime_error&) {
+        }
+    }
+}
+
+void testRoundTrip(const DiscreteRandomVariable& rv, const std::string& path) {
+    save(rv, path, true);
+    CHECK(load(path).atoms() == rv.atoms());
+}
+
+void testCompressionRatio(const std::string& path) {
+    DiscreteRandomVariable rv = lattice(100000);
+    save(rv, path, false);
+    std::streamoff plainSize = fileSize(path);
+    save(rv, path, true);
+    CHECK(fileSize(path) * 3 < plainSize);
+}
+
+void testCorruption(const DiscreteRandomVariable& rv, const std::string& path) {
+    save(rv, path, true);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-3, std::ios::end);
+        file.put('\x5A');
+    }
+    CHECK_THROWS(load(path), std::runtime_error);
+}
+
+void testBitCounts() {
+    std::mt19937_64 generator(9);
+    for (int i = 0; i < 1000; ++i) {
+        std::uint64_t x = generator() >> (i % 64);
+        if (x == 0) continue;
+        int leading = 0;
+        while (!(x & (1ull << (63 - leading)))) ++leading;
+        int trailing = 0;
+        while (!(x & (1ull << trailing))) ++trailing;
+        CHECK(binary_format::countLeadingZeros(x) == leading);
+        CHECK(binary_format::countTrailingZeros(x) == trailing);
+    }
+}
+
+}
+
+int main() {
+    std::string path = test_support::temporaryPath("compressed.bin");
+
+    testBlock();
+    testBitCounts();
+    testRoundTrip(DiscreteRandomVariable({{42.0, 1.0}}), path);
+    testRoundTrip(lattice(1000), path);
+    testRoundTrip(randomLaw(200000, 2), path); // несколько блоков
+    testCompressionRatio(path);
+    testCorruption(randomLaw(1000, 4), path);
+
+    std::remove(path.c_str());
+    return test_support::finish();
+}
@@ -0,0 +1,94 @@
+#include "../include/metrics.h"
+#include "test_support.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Матрица расстояний и k ближайших соседей - против попарного подсчета
+// и полного перебора на каталоге из 150 небольших распределений
+
+namespace {
+
+DiscreteRandomVariable randomLaw(std::mt19937_64& generator) {
+    std::uniform_int_distribution<int> atoms(1, 20);
+    std::uniform_int_distribution<int> value(0, 60);
+    std::uniform_real_distribution<double> weight(0.1, 1.0);
+    std::vector<std::pair<double, double>> dist;
+    int n = atoms(generator);
+    for (int i = 0; i < n; ++i) {
+        double x = 0.5 * value(generator);
+        if (std::none_of(dist.begin(), dist.end(), [x](const auto& atom) { return atom.first == x; })) {
+            dist.push_back({x, weight(generator)});
+        }
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+void testDistanceMatrix(const std::vector<DiscreteRandomVariable>& catalog) {
+    using metrics::Metric;
+    for (Metric metric : {Metric::TotalVariation, Metric::KolmogorovSmirnov, Metric::Wasserstein}) {
+        std::size_t n = catalog.size();
+        std::vector<double> matrix = metrics::distanceMatrix(metric, catalog);
+        CHECK(matrix.size() == n * n);
+        for (std::size_t i = 0; i < n; ++i) {
+            CHECK(matrix[i * n + i] == 0.0);
+            for (std::size_t j = 0; j < n; ++j) {
+                CHECK(matrix[i * n + j] == matrix[j * n + i]);
+                CHECK_NEAR(matrix[i * n + j], metrics::distance(metric, catalog[i], catalog[j]), 1e-12);
+            }
+        }
+
+        std::vector<DiscreteRandomVariable> rows(catalog.begin(), catalog.begin() + 7);
+        std::vector<double> rectangular = metrics::distanceMatrix(metric, rows, catalog);
+        CHECK(rectangular.size() == rows.size() * n);
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                CHECK_NEAR(rectangular[i * n + j], matrix[i * n + j], 1e-12);
+            }
+        }
+    }
+}
+
+// Соседи по возрастанию расстояния, при равенстве - по индексу
+void testNearestNeighbors(const std::vector<DiscreteRandomVariable>& catalog) {
+    using metrics::Metric;
+    const std::size_t k = 5;
+    std::size_t n = catalog.size();
+    for (Metric metric : {Metric::TotalVariation, Metric::KolmogorovSmirnov, Metric::Wasserstein}) {
+        std::vector<double> matrix = metrics::distanceMatrix(metric, catalog);
+        auto neighbors = metrics::nearestNeighbors(metric, catalog, k);
+        CHECK(neighbors.size() == n);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::vector<std::size_t> order;
+            for (std::size_t j = 0; j < n; ++j) {
+                if (j != i) order.push_back(j);
+            }
+            std::stable_sort(order.begin(), order.end(),
+                [&](std::size_t a, std::size_t b) { return matrix[i * n + a] < matrix[i * n + b]; });
+            CHECK(neighbors[i].size() == k);
+            for (std::size_t r = 0; r < k && r < neighbors[i].size(); ++r) {
+                CHECK_NEAR(neighbors[i][r].distance, matrix[i * n + order[r]], 1e-12);
+            }
+        }
+
+        // Запросы вне каталога: ближайший к элементу каталога - он сам
+        std::vector<DiscreteRandomVariable> queries(catalog.begin(), catalog.begin() + 3);
+        auto external = metrics::nearestNeighbors(metric, queries, catalog, k);
+        for (std::size_t q = 0; q < queries.size(); ++q) {
+            CHECK(external[q].front().distance == 0.0);
+        }
+    }
+}
+
+}
+
+int main() {
+    std::mt19937_64 generator(3);
+    std::vector<DiscreteRandomVariable> catalog;
+    for (int i = 0; i < 150; ++i) {
+        catalog.push_back(randomLaw(generator));
+    }
+    testDistanceMatrix(catalog);
+    testNearestNeighbors(catalog);
+    return test_support::finish();
+}
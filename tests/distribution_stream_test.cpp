@@ -0,0 +1,138 @@
+#include "../include/distribution_stream.h"
+#include "../include/random_variable.h"
+#include "test_support.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Потоковые чтение и запись блоками: те же атомы и статистики, что у
+// DiscreteRandomVariable, и отказ на файле с испорченным хвостом
+
+namespace {
+
+DiscreteRandomVariable randomLaw(std::size_t atoms, unsigned seed) {
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> value(-100.0, 100.0);
+    std::uniform_real_distribution<double> weight(0.1, 1.0);
+    std::vector<std::pair<double, double>> dist(atoms);
+    for (auto& atom : dist) {
+        atom = {value(generator), weight(generator)};
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+std::vector<std::pair<double, double>> readAll(const std::string& path, std::size_t chunkAtoms) {
+    DistributionReader reader(path, chunkAtoms);
+    std::vector<std::pair<double, double>> atoms;
+    for (AtomSpan chunk = reader.next(); !chunk.empty(); chunk = reader.next()) {
+        CHECK(chunk.size() <= chunkAtoms);
+        atoms.insert(atoms.end(), chunk.begin(), chunk.end());
+    }
+    return atoms;
+}
+
+void testChunkedRoundTrip(const DiscreteRandomVariable& rv, const std::string& path) {
+    // Размер блока не делит число атомов
+    {
+        DistributionWriter writer(path, 7);
+        writer.write(rv.atoms());
+    }
+    auto atoms = readAll(path, 13);
+    CHECK(atoms.size() == rv.atoms().size());
+    CHECK(AtomSpan(atoms) == rv.atoms());
+
+    // Файл потокового писателя читается и обычным deserialize
+    std::ifstream file(path, std::ios::binary);
+    DiscreteRandomVariable copy;
+    copy.deserialize(file);
+    CHECK(copy.atoms() == rv.atoms());
+}
+
+void testStatistics(const DiscreteRandomVariable& rv, const std::string& path) {
+    for (bool compressed : {false, true}) {
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (compressed) {
+                rv.serializeCompressed(file);
+            } else {
+                rv.serialize(file);
+            }
+        }
+        MomentAccumulator moments = streamMoments(path);
+        CHECK(moments.count() == rv.atoms().size());
+        CHECK_NEAR(moments.expectation(), rv.expectation(), 1e-12);
+        CHECK_NEAR(moments.variance(), rv.variance(), 1e-9);
+
+        std::vector<double> points = {-200.0, -50.0, 0.0, 12.5, 99.0, 200.0};
+        std::vector<double> cdf = streamCDF(path, points);
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            CHECK_NEAR(cdf[i], rv.cdf(points[i]), 1e-12);
+        }
+        std::vector<double> levels = {0.9, 0.0, 0.25, 0.5, 1.0};
+        std::vector<double> quantiles = streamQuantiles(path, levels);
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            CHECK(quantiles[i] == rv.quantile(levels[i]));
+        }
+    }
+}
+
+void testPrune(const std::string& path, const std::string& output) {
+    DiscreteRandomVariable rv({{1, 0.001}, {2, 0.5}, {3, 0.002}, {4, 0.497}});
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        rv.serialize(file);
+    }
+    CHECK(streamPrune(path, output, 0.01) == 2);
+    auto atoms = readAll(output, 1);
+    CHECK(atoms.size() == 2);
+    CHECK(atoms[0].first == 2.0 && atoms[1].first == 4.0);
+    CHECK_NEAR(atoms[0].second + atoms[1].second, 1.0, 1e-15);
+    CHECK_THROWS(streamPrune(path, output, 0.9), std::invalid_argument);
+}
+
+// Байт в последнем атоме изменен (файл длиннее блока чтения): все потоковые функции,
+// включая квантили, найденные в первом блоке, сообщают об ошибке CRC
+void testCorruptedTail(const DiscreteRandomVariable& rv, const std::string& path) {
+    {
+        DistributionWriter writer(path, 64);
+        writer.write(rv.atoms());
+    }
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-3, std::ios::end);
+        file.put('\x5A');
+    }
+    CHECK_THROWS(readAll(path, 64), std::runtime_error);
+    CHECK_THROWS(streamMoments(path), std::runtime_error);
+    CHECK_THROWS(streamCDF(path, {0.0}), std::runtime_error);
+    CHECK_THROWS(streamQuantiles(path, {0.0, 0.01}), std::runtime_error);
+}
+
+void testWriterErrors(const std::string& path) {
+    DistributionWriter writer(path);
+    writer.write(1.0, 0.5);
+    CHECK_THROWS(writer.write(1.0, 0.5), std::invalid_argument);
+    CHECK_THROWS(writer.write(2.0, -0.5), std::invalid_argument);
+    writer.close();
+    CHECK_THROWS(writer.write(3.0, 0.5), std::runtime_error);
+}
+
+}
+
+int main() {
+    std::string path = test_support::temporaryPath("stream.bin");
+    std::string output = test_support::temporaryPath("stream-pruned.bin");
+
+    testChunkedRoundTrip(randomLaw(1000, 1), path);
+    testStatistics(randomLaw(300000, 2), path);
+    testPrune(path, output);
+    testCorruptedTail(randomLaw(3 * kDefaultChunkAtoms, 3), path);
+    testWriterErrors(path);
+
+    std::remove(path.c_str());
+    std::remove(output.c_str());
+    return test_support::finish();
+}
@@ -0,0 +1,113 @@
+#include "../include/distribution_view.h"
+#include "../include/random_variable.h"
+#include "test_support.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Отображение в память: те же ответы, что у DiscreteRandomVariable, без копии атомов,
+// отказ для файлов, которые нельзя отобразить
+
+namespace {
+
+DiscreteRandomVariable randomLaw(std::size_t atoms, unsigned seed) {
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> value(-1e6, 1e6);
+    std::uniform_real_distribution<double> weight(0.1, 1.0);
+    std::vector<std::pair<double, double>> dist(atoms);
+    for (auto& atom : dist) {
+        atom = {value(generator), weight(generator)};
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+void save(const DiscreteRandomVariable& rv, const std::string& path, bool compressed = false) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (compressed) {
+        rv.serializeCompressed(file);
+    } else {
+        rv.serialize(file);
+    }
+}
+
+void testQueries(const DiscreteRandomVariable& rv, const std::string& path) {
+    save(rv, path);
+    DistributionView view(path);
+    CHECK(view.verify());
+    CHECK(view.size() == rv.atoms().size());
+    CHECK(view.atoms() == rv.atoms());
+    // Моменты не требуют префиксных сумм
+    CHECK(view.expectation() == rv.expectation());
+    CHECK(view.variance() == rv.variance());
+    CHECK(view.atoms().cumulativeProbabilities() == nullptr);
+
+    std::mt19937_64 generator(7);
+    std::uniform_real_distribution<double> point(-1.1e6, 1.1e6);
+    std::uniform_real_distribution<double> level(0.0, 1.0);
+    for (int i = 0; i < 2000; ++i) {
+        double x = point(generator);
+        double p = level(generator);
+        CHECK(view.cdf(x) == rv.cdf(x));
+        CHECK(view.quantile(p) == rv.quantile(p));
+    }
+    for (double p : {0.0, 1.0}) {
+        CHECK(view.quantile(p) == rv.quantile(p));
+    }
+    CHECK(view.getCDF() == rv.getCDF());
+    CHECK(view.toRandomVariable().atoms() == rv.atoms());
+
+    // Перемещение сохраняет построенный индекс
+    DistributionView moved(std::move(view));
+    CHECK(moved.cdf(0.0) == rv.cdf(0.0));
+}
+
+// Первые запросы из нескольких потоков одновременно строят индекс один раз
+void testConcurrentFirstQuery(const DiscreteRandomVariable& rv, const std::string& path) {
+    save(rv, path);
+    DistributionView view(path);
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+    for (std::size_t t = 0; t < mismatches.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 100; ++i) {
+                double p = (i + 0.5) / 100.0;
+                if (view.quantile(p) != rv.quantile(p)) ++mismatches[t];
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (int count : mismatches) CHECK(count == 0);
+}
+
+void testRejected(const DiscreteRandomVariable& rv, const std::string& path) {
+    save(rv, path, true);
+    CHECK_THROWS(DistributionView view(path), std::runtime_error);
+
+    // Файл обрезан: атомов меньше, чем в заголовке
+    save(rv, path);
+    std::ifstream whole(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(whole)), std::istreambuf_iterator<char>());
+    whole.close();
+    std::ofstream truncated(path, std::ios::binary | std::ios::trunc);
+    truncated.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 8));
+    truncated.close();
+    CHECK_THROWS(DistributionView view(path), std::runtime_error);
+}
+
+}
+
+int main() {
+    std::string path = test_support::temporaryPath("view.bin");
+
+    testQueries(DiscreteRandomVariable({{3.0, 1.0}}), path);
+    testQueries(randomLaw(50000, 3), path);
+    testConcurrentFirstQuery(randomLaw(20000, 5), path);
+    testRejected(randomLaw(1000, 4), path);
+
+    std::remove(path.c_str());
+    return test_support::finish();
+}
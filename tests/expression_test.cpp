@@ -0,0 +1,115 @@
+#include "../include/expression.h"
+#include "test_support.h"
+#include <stdexcept>
+#include <string>
+
+// Разбор скриптов (ошибки с местом, свертка чисел с проверкой конечности)
+// и общий граф: одинаковые подвыражения - один узел и одно вычисление
+
+namespace {
+
+DiscreteRandomVariable die() {
+    return DiscreteRandomVariable({{1, 1.0 / 6}, {2, 1.0 / 6}, {3, 1.0 / 6}, {4, 1.0 / 6}, {5, 1.0 / 6}, {6, 1.0 / 6}});
+}
+
+expression::Evaluator withDice() {
+    expression::Evaluator evaluator;
+    evaluator.bind("X", die());
+    evaluator.bind("Y", DiscreteRandomVariable({{0, 0.5}, {10, 0.5}}));
+    return evaluator;
+}
+
+// Сообщение об ошибке разбора содержит место
+bool failsAt(const std::string& script, const std::string& where) {
+    expression::Evaluator evaluator = withDice();
+    try {
+        evaluator.run(script);
+    } catch (const std::invalid_argument& error) {
+        return std::string(error.what()).find(where) != std::string::npos;
+    }
+    return false;
+}
+
+void testParseErrors() {
+    CHECK(failsAt("Z = X +", "line 1, column 8"));
+    CHECK(failsAt("Z = (X", "Expected ')'"));
+    CHECK(failsAt("Z = Q", "Unknown variable 'Q'"));
+    CHECK(failsAt("\nZ = X $ 2", "line 2, column 7"));
+    CHECK(failsAt("Z = 1e400 * X", "Invalid number"));
+    CHECK(failsAt("report quantile(X, 1.5)", "Quantile level"));
+    CHECK(failsAt("report median(X)", "Expected report function"));
+    CHECK(failsAt("report cdf(X, Y)", "Expected a number"));
+
+    // Свернутые числа проверяются так же, как результат операции над числами
+    CHECK(failsAt("Z = 1e200 * 1e200", "Constant is not finite"));
+    CHECK(failsAt("Z = 1e200 * (1e200 * X)", "Constant is not finite"));
+    CHECK(failsAt("Z = (X * 1e200) * 1e200", "Constant is not finite"));
+    CHECK(failsAt("Z = 1e308 + (1e308 + X)", "Constant is not finite"));
+    CHECK(failsAt("Z = (X - 1e308) - 1e308", "Constant is not finite"));
+
+    // Скрипт с ошибкой не меняет ни имена, ни кеш
+    expression::Evaluator evaluator = withDice();
+    std::size_t cached = evaluator.cachedResults();
+    CHECK_THROWS(evaluator.run("Z = X + Y\nW = Z * Q"), std::invalid_argument);
+    CHECK(evaluator.variable("Z") == nullptr);
+    CHECK(evaluator.cachedResults() == cached);
+}
+
+void testFolding() {
+    expression::Evaluator evaluator = withDice();
+    std::size_t bound = evaluator.cachedResults();
+    evaluator.run("A = 2 * (3 * X)\nB = X + 1 + 2 - 3\nC = -(-X)\nD = 0 * X + 5\nE = (2 + 3) * 4");
+
+    // 2*(3*X) - один масштаб 6, промежуточный 3*X не вычисляется
+    CHECK(evaluator.variable("A")->atoms() == (die() * 6.0).atoms());
+    CHECK(evaluator.cachedResults() == bound + 3); // A, D, E; B и C - сам X
+    CHECK(evaluator.variable("B") == evaluator.variable("X"));
+    CHECK(evaluator.variable("C") == evaluator.variable("X"));
+    CHECK(evaluator.variable("D")->atoms() == DiscreteRandomVariable({{5.0, 1.0}}).atoms());
+    CHECK(evaluator.variable("E")->atoms() == DiscreteRandomVariable({{20.0, 1.0}}).atoms());
+
+    std::vector<expression::ReportItem> report = evaluator.run("report expectation(X + X), variance(X + X), atoms(2 * X)");
+    CHECK(report.size() == 3);
+    CHECK(report[0].text == "expectation(X + X)");
+    CHECK_NEAR(report[0].values[0].second, 7.0, 1e-14); // независимые копии, а не 2*X
+    CHECK_NEAR(report[1].values[0].second, 35.0 / 6, 1e-13);
+    CHECK(report[2].values[0].second == 6.0);
+}
+
+void testSharedSubexpressions() {
+    expression::Evaluator evaluator = withDice();
+    std::size_t bound = evaluator.cachedResults();
+
+    evaluator.run("S = X + Y; T = Y + X; P = X * Y");
+    CHECK(evaluator.variable("S") == evaluator.variable("T")); // один узел
+    CHECK(evaluator.cachedResults() == bound + 2);
+
+    // Повторное выражение в новом вызове берется из кеша
+    evaluator.run("U = (Y * X) + (Y + X)");
+    CHECK(evaluator.cachedResults() == bound + 3);
+    auto shared = evaluator.variable("S");
+    evaluator.run("report moments(X + Y)");
+    CHECK(evaluator.variable("S") == shared);
+    CHECK(evaluator.cachedResults() == bound + 3);
+
+    // Новая привязка - новый лист: прежние выражения не меняются
+    evaluator.bind("X", DiscreteRandomVariable({{100.0, 1.0}}));
+    evaluator.run("V = X + Y");
+    CHECK(evaluator.variable("V") != shared);
+    CHECK(evaluator.variable("S") == shared);
+
+    // После clearCache значения пересчитываются и совпадают
+    evaluator.clearCache();
+    CHECK(evaluator.cachedResults() == bound + 1);
+    evaluator.run("S2 = S");
+    CHECK(evaluator.variable("S2")->atoms() == shared->atoms());
+}
+
+}
+
+int main() {
+    testParseErrors();
+    testFolding();
+    testSharedSubexpressions();
+    return test_support::finish();
+}
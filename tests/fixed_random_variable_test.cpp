@@ -0,0 +1,77 @@
+#include "../include/fixed_random_variable.h"
+#include "test_support.h"
+#include <stdexcept>
+
+// Основные проверки выполняются компилятором (static_assert); сборка этого же
+// файла с PTMS_FIXED_REJECT_CASE обязана завершиться ошибкой компиляции
+
+namespace {
+
+constexpr bool near(double actual, double expected) {
+    return fixed_detail::absolute(actual - expected) <= 1e-12;
+}
+
+constexpr FixedDiscreteRandomVariable die({{1.0, 1.0 / 6}, {2.0, 1.0 / 6}, {3.0, 1.0 / 6},
+                                           {4.0, 1.0 / 6}, {5.0, 1.0 / 6}, {6.0, 1.0 / 6}});
+
+static_assert(die.capacity() == 6 && die.size() == 6, "die has six atoms");
+static_assert(near(die.expectation(), 3.5), "E of a die is 7/2");
+static_assert(near(die.variance(), 35.0 / 12), "D of a die is 35/12");
+static_assert(near(die.skewness(), 0.0), "a die is symmetric");
+static_assert(near(die.cdf(3.0), 0.5) && die.quantile(0.5) == 3.0, "median of a die");
+
+// Размер результата свертки известен при компиляции: N * M, совпадения сливаются
+constexpr auto twoDice = die + die;
+static_assert(decltype(twoDice)::capacity() == 36, "sum capacity is N * M");
+static_assert(twoDice.size() == 11, "sums 2..12");
+static_assert(twoDice.value(0) == 2.0 && twoDice.value(10) == 12.0, "sum is sorted");
+static_assert(near(twoDice.probability(5), 6.0 / 36), "P(sum = 7) = 1/6");
+static_assert(near(twoDice.expectation(), 7.0), "E of two dice");
+static_assert(near(twoDice.variance(), 35.0 / 6), "D of two dice");
+
+constexpr auto product = die * die;
+static_assert(decltype(product)::capacity() == 36 && product.size() == 18, "distinct products of 1..6");
+
+// Линейные преобразования
+constexpr auto reflected = die * -2.0 + 1.0;
+static_assert(reflected.value(0) == -11.0 && reflected.value(5) == -1.0, "negative scale reverses order");
+static_assert(near(reflected.expectation(), -6.0) && near(reflected.variance(), 35.0 / 3), "E, D of -2X + 1");
+
+// Ненормированные вероятности нормируются
+constexpr FixedDiscreteRandomVariable weights({{0.0, 1.0}, {1.0, 3.0}});
+static_assert(near(weights.probability(1), 0.75), "weights are normalized");
+
+#ifdef PTMS_FIXED_REJECT_CASE
+// Отрицательная вероятность в константном выражении - ошибка компиляции
+constexpr FixedDiscreteRandomVariable rejected({{0.0, -0.5}, {1.0, 1.5}});
+#endif
+
+void testRejection() {
+    // Во время выполнения та же проверка бросает исключение
+    double negative = -0.5;
+    CHECK_THROWS((FixedDiscreteRandomVariable<2>({{0.0, negative}, {1.0, 1.5}})), std::invalid_argument);
+    double same = 1.0;
+    CHECK_THROWS((FixedDiscreteRandomVariable<2>({{same, 0.5}, {1.0, 0.5}})), std::invalid_argument);
+    CHECK_THROWS(die.quantile(1.5), std::invalid_argument);
+}
+
+void testConversion() {
+    DiscreteRandomVariable dynamicDie = die.toRandomVariable();
+    DiscreteRandomVariable dynamicSum = dynamicDie + dynamicDie;
+    CHECK(dynamicSum.atoms().size() == twoDice.size());
+    for (std::size_t i = 0; i < twoDice.size(); ++i) {
+        CHECK(dynamicSum.atoms()[i].first == twoDice.value(i));
+        CHECK_NEAR(dynamicSum.atoms()[i].second, twoDice.probability(i), 1e-15);
+    }
+    CHECK_NEAR(dynamicDie.expectation(), die.expectation(), 1e-15);
+    CHECK_NEAR(dynamicDie.variance(), die.variance(), 1e-15);
+    CHECK(twoDice.toRandomVariable().quantile(0.5) == twoDice.quantile(0.5));
+}
+
+}
+
+int main() {
+    testRejection();
+    testConversion();
+    return test_support::finish();
+}
@@ -0,0 +1,166 @@
+#include "../include/instrumentation.h"
+#include "../include/random_variable.h"
+#include "json_reader.h"
+#include "test_support.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+// Счетчики после известных операций, вид снимка JSON, reset() и потоки,
+// завершившиеся до снимка. Без PTMS_ENABLE_INSTRUMENTATION операции ядра
+// не учитываются, а record() по-прежнему работает; тот же тест в сборке
+// с инструментированием запускает ctest-тест instrumentation_enabled_test.
+
+using instrumentation::Probe;
+
+namespace {
+
+const instrumentation::ProbeStats& stats(const std::array<instrumentation::ProbeStats, instrumentation::kProbeCount>& all,
+                                         Probe probe) {
+    return all[static_cast<std::size_t>(probe)];
+}
+
+DiscreteRandomVariable die() {
+    return DiscreteRandomVariable({{1, 1.0 / 6}, {2, 1.0 / 6}, {3, 1.0 / 6}, {4, 1.0 / 6}, {5, 1.0 / 6}, {6, 1.0 / 6}});
+}
+
+void testRecord() {
+    instrumentation::reset();
+    instrumentation::record(Probe::Quantile, 10, 0);
+    instrumentation::record(Probe::Quantile, 5, 3);
+    instrumentation::record(Probe::Quantile, 1, 1000);
+    const auto& quantile = stats(instrumentation::snapshot(), Probe::Quantile);
+    CHECK(quantile.calls == 3);
+    CHECK(quantile.items == 16);
+    CHECK(quantile.totalNanoseconds == 1003);
+    // Корзина k - задержки в [2^(k-1), 2^k) нс
+    CHECK(quantile.latency[0] == 1);
+    CHECK(quantile.latency[2] == 1);
+    CHECK(quantile.latency[10] == 1);
+    CHECK(quantile.latency[1] == 0);
+}
+
+void testOperations() {
+    DiscreteRandomVariable d = die();
+    instrumentation::reset();
+    DiscreteRandomVariable sum = d + d;
+    DiscreteRandomVariable product = d * d;
+    DiscreteRandomVariable scaled = d * 2.0;
+    double probability = d.cdf(3.0);
+    double median = d.quantile(0.5);
+    CHECK(sum.getDistribution().size() == 11);
+    CHECK(scaled.getDistribution().size() == 6);
+    CHECK_NEAR(probability, 0.5, 1e-15);
+    CHECK(median == 3.0);
+
+    auto all = instrumentation::snapshot();
+    if (!instrumentation::enabled()) {
+        for (std::size_t p = 0; p < instrumentation::kProbeCount; ++p) {
+            CHECK(all[p].calls == 0);
+        }
+        return;
+    }
+    CHECK(stats(all, Probe::Sum).calls == 1);
+    CHECK(stats(all, Probe::Sum).items == 36);
+    CHECK(stats(all, Probe::Product).calls == 1);
+    CHECK(stats(all, Probe::Product).items == 36);
+    CHECK(stats(all, Probe::Scale).calls == 1);
+    CHECK(stats(all, Probe::Scale).items == 6);
+    CHECK(stats(all, Probe::Cdf).calls == 1);
+    CHECK(stats(all, Probe::Quantile).calls == 1);
+    // Каждый результат проверяется один раз
+    CHECK(stats(all, Probe::Validate).calls == 3);
+    CHECK(stats(all, Probe::Validate).items == sum.getDistribution().size() +
+                                                    product.getDistribution().size() + 6);
+    // Атомы результатов выделяются через ресурс по умолчанию
+    CHECK(stats(all, Probe::Allocate).calls > 0);
+    CHECK(stats(all, Probe::Allocate).items >= 6 * sizeof(std::pair<double, double>));
+}
+
+// Поля снимка: probes в порядке Probe, у каждого calls/items/totalNanoseconds и
+// непустые корзины задержек по возрастанию границы
+void testSnapshotJSON() {
+    instrumentation::reset();
+    instrumentation::record(Probe::Moments, 4, 100);
+    instrumentation::record(Probe::Moments, 4, 5000);
+
+    json_reader::Value root = json_reader::parse(instrumentation::snapshotJSON());
+    CHECK(root["enabled"].type == json_reader::Value::Type::Boolean);
+    CHECK(root["enabled"].boolean == instrumentation::enabled());
+    const json_reader::Value& probes = root["probes"];
+    CHECK(probes.object.size() == instrumentation::kProbeCount);
+    auto all = instrumentation::snapshot();
+    for (std::size_t p = 0; p < probes.object.size() && p < instrumentation::kProbeCount; ++p) {
+        const auto& field = probes.object[p];
+        CHECK(field.first == instrumentation::probeName(static_cast<Probe>(p)));
+        const json_reader::Value& probe = field.second;
+        CHECK(probe["calls"].number == all[p].calls);
+        CHECK(probe["items"].number == all[p].items);
+        CHECK(probe["totalNanoseconds"].type == json_reader::Value::Type::Number);
+        double counted = 0;
+        double previousBound = 0;
+        for (const auto& bucket : probe["latency"].array) {
+            CHECK(bucket["count"].number > 0);
+            counted += bucket["count"].number;
+            if (bucket["lessThanNanoseconds"].type == json_reader::Value::Type::Number) {
+                CHECK(bucket["lessThanNanoseconds"].number > previousBound);
+                previousBound = bucket["lessThanNanoseconds"].number;
+            }
+        }
+        CHECK(counted == all[p].calls);
+    }
+
+    const json_reader::Value& moments = probes["moments"];
+    CHECK(moments["calls"].number == 2);
+    CHECK(moments["items"].number == 8);
+    CHECK(moments["totalNanoseconds"].number == 5100);
+    CHECK(moments["latency"].array.size() == 2);
+    CHECK(moments["latency"].array[0]["lessThanNanoseconds"].number == 128);
+    CHECK(moments["latency"].array[1]["lessThanNanoseconds"].number == 8192);
+}
+
+void testReset() {
+    instrumentation::record(Probe::Serialize, 3, 10);
+    instrumentation::reset();
+    for (const auto& probe : instrumentation::snapshot()) {
+        CHECK(probe.calls == 0);
+        CHECK(probe.items == 0);
+        CHECK(probe.totalNanoseconds == 0);
+        for (std::uint64_t bucket : probe.latency) CHECK(bucket == 0);
+    }
+    json_reader::Value root = json_reader::parse(instrumentation::snapshotJSON());
+    for (const auto& field : root["probes"].object) {
+        CHECK(field.second["calls"].number == 0);
+        CHECK(field.second["latency"].array.empty());
+    }
+}
+
+// Слот завершившегося потока остается в сумме и переходит к следующему потоку
+void testExitedThreads() {
+    instrumentation::reset();
+    auto work = []() {
+        for (int i = 0; i < 100; ++i) instrumentation::record(Probe::Deserialize, 7, 10);
+    };
+    std::thread first(work);
+    first.join();
+    CHECK(stats(instrumentation::snapshot(), Probe::Deserialize).calls == 100);
+    CHECK(stats(instrumentation::snapshot(), Probe::Deserialize).items == 700);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) threads.emplace_back(work);
+    for (auto& thread : threads) thread.join();
+    work();
+    CHECK(stats(instrumentation::snapshot(), Probe::Deserialize).calls == 600);
+    CHECK(stats(instrumentation::snapshot(), Probe::Deserialize).items == 4200);
+}
+
+}
+
+int main() {
+    testRecord();
+    testOperations();
+    testSnapshotJSON();
+    testReset();
+    testExitedThreads();
+    return test_support::finish();
+}
@@ -0,0 +1,180 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Разбор JSON для проверки вывода в тестах (снимок счетчиков, файл трассировки).
+// Строгий: любая синтаксическая ошибка - исключение. Поля объекта хранятся
+// в порядке записи; escape-последовательности \uXXXX не раскодируются.
+namespace json_reader {
+
+struct Value {
+    enum class Type { Null, Boolean, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<Value> array;
+    std::vector<std::pair<std::string, Value>> object;
+
+    bool has(const std::string& key) const {
+        for (const auto& field : object) {
+            if (field.first == key) return true;
+        }
+        return false;
+    }
+
+    const Value& operator[](const std::string& key) const {
+        for (const auto& field : object) {
+            if (field.first == key) return field.second;
+        }
+        throw std::runtime_error("Missing JSON field: " + key);
+    }
+};
+
+class Parser {
+private:
+    const std::string& text;
+    std::size_t pos = 0;
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("JSON error at " + std::to_string(pos) + ": " + what);
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t')) {
+            ++pos;
+        }
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) fail(std::string("expected '") + c + "'");
+    }
+
+    void keyword(const char* word) {
+        for (; *word; ++word, ++pos) {
+            if (pos >= text.size() || text[pos] != *word) fail("unknown literal");
+        }
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string result;
+        while (pos < text.size() && text[pos] != '"') {
+            if (static_cast<unsigned char>(text[pos]) < 0x20) fail("control character in string");
+            if (text[pos] == '\\') {
+                if (++pos >= text.size()) break;
+                switch (text[pos]) {
+                    case '"': case '\\': case '/': result += text[pos]; break;
+                    case 'n': result += '\n'; break;
+                    case 't': result += '\t'; break;
+                    case 'r': result += '\r'; break;
+                    case 'b': result += '\b'; break;
+                    case 'f': result += '\f'; break;
+                    case 'u': result += "\\u"; break;
+                    default: fail("bad escape");
+                }
+            } else {
+                result += text[pos];
+            }
+            ++pos;
+        }
+        if (pos >= text.size()) fail("unterminated string");
+        ++pos;
+        return result;
+    }
+
+    double parseNumber() {
+        std::size_t begin = pos;
+        if (pos < text.size() && text[pos] == '-') ++pos;
+        auto digits = [this]() {
+            std::size_t first = pos;
+            while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') ++pos;
+            if (pos == first) fail("expected digit");
+        };
+        digits();
+        if (pos < text.size() && text[pos] == '.') {
+            ++pos;
+            digits();
+        }
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+            if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) ++pos;
+            digits();
+        }
+        return std::strtod(text.substr(begin, pos - begin).c_str(), nullptr);
+    }
+
+public:
+    explicit Parser(const std::string& text) : text(text) {}
+
+    Value parseValue() {
+        Value value;
+        skipSpace();
+        if (pos >= text.size()) fail("unexpected end");
+        char c = text[pos];
+        if (c == '{') {
+            ++pos;
+            value.type = Value::Type::Object;
+            if (consume('}')) return value;
+            do {
+                skipSpace();
+                std::string key = parseString();
+                expect(':');
+                value.object.push_back({key, parseValue()});
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            ++pos;
+            value.type = Value::Type::Array;
+            if (consume(']')) return value;
+            do {
+                value.array.push_back(parseValue());
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            value.type = Value::Type::String;
+            value.string = parseString();
+        } else if (c == 't' || c == 'f') {
+            value.type = Value::Type::Boolean;
+            value.boolean = c == 't';
+            keyword(value.boolean ? "true" : "false");
+        } else if (c == 'n') {
+            keyword("null");
+        } else {
+            value.type = Value::Type::Number;
+            value.number = parseNumber();
+        }
+        return value;
+    }
+
+    // Документ целиком: после значения допустимы только пробелы
+    Value parseDocument() {
+        Value value = parseValue();
+        skipSpace();
+        if (pos != text.size()) fail("trailing characters");
+        return value;
+    }
+};
+
+inline Value parse(const std::string& text) {
+    return Parser(text).parseDocument();
+}
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include "../include/metrics.h"
+#include "test_support.h"
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+// Меры и расстояния на известных значениях; на длинных общих решетках
+// (пакетный путь с логарифмом lane_math) - против прямого суммирования
+
+namespace {
+
+DiscreteRandomVariable coin(double a, double b) {
+    return DiscreteRandomVariable({{a, 0.5}, {b, 0.5}});
+}
+
+// Решетка step * i; часть вероятностей нулевая
+DiscreteRandomVariable lattice(int atoms, int step, double zeroShare, unsigned seed) {
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<std::pair<double, double>> dist;
+    for (int i = 0; i < atoms; ++i) {
+        dist.push_back({static_cast<double>(i * step), uniform(generator) < zeroShare ? 0.0 : uniform(generator) + 1e-3});
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+// p log(p / q), 0 log 0 = 0
+double relativeTerm(double p, double q) {
+    return p == 0.0 ? 0.0 : p * std::log(p / q);
+}
+
+template <typename Term>
+double sumOverSupports(const DiscreteRandomVariable& a, const DiscreteRandomVariable& b, Term term) {
+    AtomSpan left = a.atoms(), right = b.atoms();
+    double sum = 0.0;
+    std::size_t i = 0, j = 0;
+    while (i < left.size() || j < right.size()) {
+        if (j == right.size() || (i < left.size() && left[i].first < right[j].first)) {
+            sum += term(left[i++].second, 0.0);
+        } else if (i == left.size() || right[j].first < left[i].first) {
+            sum += term(0.0, right[j++].second);
+        } else {
+            sum += term(left[i++].second, right[j++].second);
+        }
+    }
+    return sum;
+}
+
+void checkRelative(double actual, double expected) {
+    CHECK(std::abs(actual - expected) <= 1e-13 * std::max(1.0, std::abs(expected)));
+}
+
+void testKnownValues() {
+    DiscreteRandomVariable uniform({{1, 0.25}, {2, 0.25}, {3, 0.25}, {4, 0.25}});
+    CHECK_NEAR(metrics::entropy(uniform), std::log(4.0), 1e-15);
+    CHECK_NEAR(metrics::entropy(DiscreteRandomVariable({{7, 1.0}})), 0.0, 1e-15);
+
+    DiscreteRandomVariable p({{0, 0.5}, {1, 0.5}});
+    DiscreteRandomVariable q({{0, 0.25}, {1, 0.75}});
+    CHECK_NEAR(metrics::klDivergence(p, q), 0.5 * std::log(2.0) + 0.5 * std::log(2.0 / 3.0), 1e-15);
+    CHECK_NEAR(metrics::klDivergence(p, p), 0.0, 1e-15);
+    CHECK(metrics::klDivergence(p, DiscreteRandomVariable({{0, 1.0}})) == std::numeric_limits<double>::infinity());
+    CHECK_NEAR(metrics::totalVariationDistance(p, q), 0.25, 1e-15);
+    CHECK_NEAR(metrics::kolmogorovSmirnovDistance(p, q), 0.25, 1e-15);
+    CHECK_NEAR(metrics::wassersteinDistance(p, q), 0.25, 1e-15);
+
+    // Непересекающиеся носители: JS = log 2, TV = 1
+    DiscreteRandomVariable left = coin(0, 1);
+    DiscreteRandomVariable right = coin(10, 11);
+    CHECK_NEAR(metrics::jensenShannonDivergence(left, right), std::log(2.0), 1e-15);
+    CHECK_NEAR(metrics::totalVariationDistance(left, right), 1.0, 1e-15);
+    CHECK_NEAR(metrics::kolmogorovSmirnovDistance(left, right), 1.0, 1e-15);
+    // Сдвиг на 10: W1 = 10
+    CHECK_NEAR(metrics::wassersteinDistance(left, right), 10.0, 1e-12);
+    CHECK_NEAR(metrics::jensenShannonDivergence(p, q), metrics::jensenShannonDivergence(q, p), 1e-15);
+}
+
+void testAlignedRuns() {
+    // a и b - одна решетка (сплошной участок), c - каждая вторая точка,
+    // d - с нулевыми вероятностями внутри участка (пересчет дорожек)
+    DiscreteRandomVariable a = lattice(5003, 1, 0.0, 1);
+    DiscreteRandomVariable b = lattice(5003, 1, 0.0, 2);
+    DiscreteRandomVariable c = lattice(2500, 2, 0.0, 3);
+    DiscreteRandomVariable d = lattice(5003, 1, 0.2, 4);
+
+    for (const DiscreteRandomVariable* rv : {&a, &c, &d}) {
+        double expected = 0.0;
+        for (const auto& atom : rv->atoms()) {
+            if (atom.second > 0.0) expected -= atom.second * std::log(atom.second);
+        }
+        checkRelative(metrics::entropy(*rv), expected);
+    }
+
+    const DiscreteRandomVariable* pairs[][2] = {{&a, &b}, {&a, &c}, {&c, &a}, {&d, &a}, {&a, &d}, {&d, &d}};
+    for (auto& pair : pairs) {
+        const DiscreteRandomVariable& p = *pair[0];
+        const DiscreteRandomVariable& q = *pair[1];
+        double kl = sumOverSupports(p, q, [](double pv, double qv) {
+            return pv > 0.0 && qv == 0.0 ? std::numeric_limits<double>::infinity() : relativeTerm(pv, qv);
+        });
+        double js = sumOverSupports(p, q, [](double pv, double qv) {
+            double m = 0.5 * (pv + qv);
+            return 0.5 * (relativeTerm(pv, m) + relativeTerm(qv, m));
+        });
+        double tv = 0.5 * sumOverSupports(p, q, [](double pv, double qv) { return std::abs(pv - qv); });
+
+        double actualKl = metrics::klDivergence(p, q);
+        if (std::isinf(kl)) {
+            CHECK(actualKl == kl);
+        } else {
+            checkRelative(actualKl, kl);
+        }
+        checkRelative(metrics::jensenShannonDivergence(p, q), js);
+        checkRelative(metrics::totalVariationDistance(p, q), tv);
+    }
+    CHECK(metrics::klDivergence(a, d) == std::numeric_limits<double>::infinity());
+    CHECK_NEAR(metrics::klDivergence(a, a), 0.0, 1e-15);
+}
+
+}
+
+int main() {
+    testKnownValues();
+    testAlignedRuns();
+    return test_support::finish();
+}
@@ -0,0 +1,89 @@
+#include "../include/moment_accumulator.h"
+#include "../include/random_variable.h"
+#include "test_support.h"
+#include <random>
+#include <vector>
+
+// Онлайн-накопитель моментов: известные значения, объединение шардов (merge)
+// и атомы как взвешенные наблюдения
+
+namespace {
+
+DiscreteRandomVariable randomLaw(std::size_t atoms, unsigned seed) {
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> value(-5.0, 20.0);
+    std::uniform_real_distribution<double> weight(0.1, 1.0);
+    std::vector<std::pair<double, double>> dist(atoms);
+    for (auto& atom : dist) {
+        atom = {value(generator), weight(generator)};
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+// Относительная погрешность с нижней границей масштаба
+bool close(double actual, double expected) {
+    return std::abs(actual - expected) <= 1e-9 * std::max(1.0, std::abs(expected));
+}
+
+void testKnownValues() {
+    // Грани кости: E = 3.5, D = 35/12, эксцесс -222/175
+    MomentAccumulator die;
+    for (int face = 1; face <= 6; ++face) die.add(face);
+    CHECK(die.count() == 6);
+    CHECK_NEAR(die.expectation(), 3.5, 1e-15);
+    CHECK_NEAR(die.variance(), 35.0 / 12, 1e-14);
+    CHECK_NEAR(die.skewness(), 0.0, 1e-15);
+    CHECK_NEAR(die.kurtosis(), -222.0 / 175, 1e-14);
+
+    MomentAccumulator constant;
+    constant.add(std::vector<double>(10, 4.0));
+    CHECK(constant.expectation() == 4.0);
+    CHECK(constant.variance() == 0.0);
+    CHECK(constant.skewness() == 0.0);
+    CHECK(constant.kurtosis() == 0.0);
+}
+
+void testMerge() {
+    std::mt19937_64 generator(11);
+    std::normal_distribution<double> normal(10.0, 3.0);
+    std::vector<double> samples(100000);
+    for (double& x : samples) x = normal(generator);
+
+    MomentAccumulator whole;
+    whole.add(samples);
+
+    // Шарды разного размера (в том числе пустой), объединенные merge, дают те же статистики
+    MomentAccumulator merged;
+    merged.merge(MomentAccumulator());
+    std::size_t bounds[] = {0, 1, 777, 50000, 99999, samples.size()};
+    for (std::size_t i = 0; i + 1 < std::size(bounds); ++i) {
+        MomentAccumulator shard;
+        for (std::size_t k = bounds[i]; k < bounds[i + 1]; ++k) shard.add(samples[k]);
+        merged.merge(shard);
+    }
+    CHECK(merged.count() == samples.size());
+    CHECK_NEAR(merged.expectation(), whole.expectation(), 1e-12);
+    CHECK_NEAR(merged.variance(), whole.variance(), 1e-9);
+    CHECK_NEAR(merged.skewness(), whole.skewness(), 1e-9);
+    CHECK_NEAR(merged.kurtosis(), whole.kurtosis(), 1e-9);
+}
+
+void testWeightedAtoms() {
+    // Атомы как взвешенные наблюдения - определения DiscreteRandomVariable
+    DiscreteRandomVariable rv = randomLaw(1000, 12);
+    MomentAccumulator atoms;
+    atoms.add(rv.atoms());
+    CHECK(close(atoms.expectation(), rv.expectation()));
+    CHECK(close(atoms.variance(), rv.variance()));
+    CHECK(close(atoms.skewness(), rv.skewness()));
+    CHECK(close(atoms.kurtosis(), rv.kurtosis()));
+}
+
+}
+
+int main() {
+    testKnownValues();
+    testMerge();
+    testWeightedAtoms();
+    return test_support::finish();
+}
@@ -0,0 +1,77 @@
+#include "../include/moment_algebra.h"
+#include "../include/random_variable.h"
+#include "test_support.h"
+#include <random>
+#include <vector>
+
+// Моменты суммы и произведения без построения атомов - против известных
+// значений и моментов свертки
+
+namespace {
+
+DiscreteRandomVariable die() {
+    return DiscreteRandomVariable({{1, 1.0 / 6}, {2, 1.0 / 6}, {3, 1.0 / 6}, {4, 1.0 / 6}, {5, 1.0 / 6}, {6, 1.0 / 6}});
+}
+
+DiscreteRandomVariable randomLaw(std::size_t atoms, unsigned seed) {
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> value(-5.0, 20.0);
+    std::uniform_real_distribution<double> weight(0.1, 1.0);
+    std::vector<std::pair<double, double>> dist(atoms);
+    for (auto& atom : dist) {
+        atom = {value(generator), weight(generator)};
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+// Относительная погрешность с нижней границей масштаба
+void checkMoments(const DistributionMoments& actual, const DistributionMoments& expected) {
+    auto close = [](double a, double b) { return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b)); };
+    CHECK(close(actual.expectation, expected.expectation));
+    CHECK(close(actual.variance, expected.variance));
+    CHECK(close(actual.skewness, expected.skewness));
+    CHECK(close(actual.kurtosis, expected.kurtosis));
+}
+
+void testKnownValues() {
+    // Сумма двух костей: E = 7, D = 35/6, симметрична
+    DistributionMoments sum = momentsOfSum(die().atoms(), die().atoms());
+    CHECK_NEAR(sum.expectation, 7.0, 1e-14);
+    CHECK_NEAR(sum.variance, 35.0 / 6, 1e-14);
+    CHECK_NEAR(sum.skewness, 0.0, 1e-14);
+    CHECK_NEAR(momentsOfSumIid(die().atoms(), 10).variance, 350.0 / 12, 1e-12);
+
+    // Произведение двух костей: E = 49/4, E[X^2] = (91/6)^2
+    DistributionMoments product = momentsOfProduct(die().atoms(), die().atoms());
+    CHECK_NEAR(product.expectation, 49.0 / 4, 1e-13);
+    CHECK_NEAR(product.variance, (91.0 / 6) * (91.0 / 6) - (49.0 / 4) * (49.0 / 4), 1e-12);
+
+    // Сдвиг на константу (вырожденная величина) меняет только среднее
+    DistributionMoments shifted = momentsOfSum(die().atoms(), DiscreteRandomVariable({{10.0, 1.0}}).atoms());
+    checkMoments(shifted, {13.5, 35.0 / 12, 0.0, die().kurtosis()});
+}
+
+void testAlgebra() {
+    DiscreteRandomVariable a = randomLaw(60, 1);
+    DiscreteRandomVariable b = randomLaw(45, 2);
+    DiscreteRandomVariable c = randomLaw(30, 3);
+
+    checkMoments(momentsOfSum(a.atoms(), b.atoms()), (a + b).atoms().moments());
+    checkMoments(momentsOfProduct(a.atoms(), b.atoms()), (a * b).atoms().moments());
+    checkMoments(momentsOfSum({a.atoms(), b.atoms(), c.atoms()}), (a + b + c).atoms().moments());
+    checkMoments(momentsOfProduct({a.atoms(), b.atoms(), c.atoms()}), (a * b * c).atoms().moments());
+    checkMoments(momentsOfSumIid(c.atoms(), 3), (c + c + c).atoms().moments());
+
+    // Перегрузки по известным моментам совпадают с перегрузками по атомам
+    checkMoments(momentsOfSum(a.atoms().moments(), b.atoms().moments()), momentsOfSum(a.atoms(), b.atoms()));
+    checkMoments(momentsOfProduct(a.atoms().moments(), b.atoms().moments()), momentsOfProduct(a.atoms(), b.atoms()));
+    checkMoments(momentsOfSumIid(c.atoms().moments(), 3), momentsOfSumIid(c.atoms(), 3));
+}
+
+}
+
+int main() {
+    testKnownValues();
+    testAlgebra();
+    return test_support::finish();
+}
@@ -0,0 +1,135 @@
+#include "../include/parallel.h"
+#include "test_support.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// parallelFor: каждый индекс ровно один раз, пул переиспользуется между
+// вызовами, исключение доходит до вызывающего и не ломает пул, вложенные
+// вызовы не блокируются. ctest задает PTMS_THREADS=4, чтобы пул работал
+// и на машине с одним процессором.
+
+namespace {
+
+void testCoverage() {
+    for (std::size_t count : {1, 2, 3, 7, 64, 1000, 100003}) {
+        for (std::size_t minChunk : {0, 1, 5, 1000}) {
+            std::vector<int> visits(count, 0);
+            std::mutex mutex;
+            std::vector<std::pair<std::size_t, std::size_t>> ranges;
+            parallelFor(count, minChunk, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) ++visits[i];
+                std::lock_guard<std::mutex> lock(mutex);
+                ranges.push_back({begin, end});
+            });
+            CHECK(std::all_of(visits.begin(), visits.end(), [](int v) { return v == 1; }));
+            // Диапазоны непрерывны, не короче minChunk (кроме единственного) и их не больше потоков
+            CHECK(ranges.size() <= hardwareThreads());
+            if (ranges.size() > 1) {
+                for (const auto& range : ranges) CHECK(range.second - range.first >= minChunk);
+            }
+        }
+    }
+    bool called = false;
+    parallelFor(0, 1, [&](std::size_t, std::size_t) { called = true; });
+    CHECK(!called);
+}
+
+// Малый объем - в вызывающем потоке, одним диапазоном
+void testSmallInline() {
+    std::thread::id caller = std::this_thread::get_id();
+    int calls = 0;
+    bool sameThread = false;
+    parallelFor(10, 100, [&](std::size_t begin, std::size_t end) {
+        ++calls;
+        sameThread = std::this_thread::get_id() == caller && begin == 0 && end == 10;
+    });
+    CHECK(calls == 1);
+    CHECK(sameThread);
+}
+
+// Многократные вызовы обслуживает один и тот же пул: потоков не больше hardwareThreads()
+void testReuse() {
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<std::size_t> total{0};
+    for (int call = 0; call < 500; ++call) {
+        parallelFor(4096, 1, [&](std::size_t begin, std::size_t end) {
+            total += end - begin;
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        });
+    }
+    CHECK(total == 500u * 4096u);
+    CHECK(threads.size() <= hardwareThreads());
+}
+
+void testExceptions() {
+    for (int attempt = 0; attempt < 50; ++attempt) {
+        std::atomic<std::size_t> done{0};
+        bool caught = false;
+        try {
+            parallelFor(1000, 1, [&](std::size_t begin, std::size_t end) {
+                if (begin == 0) throw std::runtime_error("first range");
+                done += end - begin;
+            });
+        } catch (const std::runtime_error& e) {
+            caught = std::string(e.what()) == "first range";
+        }
+        CHECK(caught);
+        // Остальные диапазоны выполнены до возврата: тело больше не вызывается
+        std::size_t after = done.load();
+        CHECK(after <= 1000);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        CHECK(done.load() == after);
+    }
+
+    // Исключения из всех диапазонов: пробрасывается одно
+    CHECK_THROWS(parallelFor(100, 1, [](std::size_t, std::size_t) { throw std::logic_error("every range"); }),
+                 std::logic_error);
+
+    // Пул исправен после исключений
+    std::atomic<std::size_t> total{0};
+    parallelFor(10000, 1, [&](std::size_t begin, std::size_t end) { total += end - begin; });
+    CHECK(total == 10000);
+}
+
+// Вложенные вызовы из тела и из нескольких внешних потоков сразу
+void testNested() {
+    std::atomic<std::size_t> total{0};
+    parallelFor(16, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            parallelFor(1000, 10, [&](std::size_t b, std::size_t e) { total += e - b; });
+        }
+    });
+    CHECK(total == 16000);
+
+    std::atomic<std::size_t> concurrent{0};
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 3; ++t) {
+        callers.emplace_back([&concurrent]() {
+            for (int call = 0; call < 100; ++call) {
+                parallelFor(256, 1, [&](std::size_t b, std::size_t e) { concurrent += e - b; });
+            }
+        });
+    }
+    for (auto& caller : callers) caller.join();
+    CHECK(concurrent == 3u * 100u * 256u);
+}
+
+}
+
+int main() {
+    testCoverage();
+    testSmallInline();
+    testReuse();
+    testExceptions();
+    testNested();
+    return test_support::finish();
+}
@@ -0,0 +1,191 @@
+#include "../include/binary_format.h"
+#include "../include/plot_image.h"
+#include "test_support.h"
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// PNG без внешних библиотек: файл разбирается обратно (чанки, CRC, поток zlib
+// с фиксированными кодами Хаффмана, Adler-32, фильтр Up) и сравнивается с пикселями
+
+namespace {
+
+std::uint32_t bigEndian(const unsigned char* p) {
+    return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | p[3];
+}
+
+class BitReader {
+private:
+    const unsigned char* data;
+    std::size_t size;
+    std::size_t position = 0; // в битах
+
+public:
+    BitReader(const unsigned char* data, std::size_t size) : data(data), size(size) {}
+
+    std::uint32_t get(int count) {
+        std::uint32_t value = 0;
+        for (int i = 0; i < count; ++i, ++position) {
+            if (position / 8 >= size) throw std::runtime_error("Truncated deflate stream");
+            value |= std::uint32_t((data[position / 8] >> (position % 8)) & 1) << i;
+        }
+        return value;
+    }
+
+    // Код Хаффмана читается старшими битами вперед
+    std::uint32_t getReversed(int count) {
+        std::uint32_t value = 0;
+        for (int i = 0; i < count; ++i) value = (value << 1) | get(1);
+        return value;
+    }
+
+    std::size_t bytesUsed() const { return (position + 7) / 8; }
+};
+
+// Символ литерала/длины по фиксированным кодам (RFC 1951, 3.2.6)
+int fixedSymbol(BitReader& bits) {
+    std::uint32_t code = bits.getReversed(7);
+    if (code <= 0x17) return static_cast<int>(256 + code);
+    code = (code << 1) | bits.get(1);
+    if (code >= 0x30 && code <= 0xBF) return static_cast<int>(code - 0x30);
+    if (code >= 0xC0 && code <= 0xC7) return static_cast<int>(280 + code - 0xC0);
+    code = (code << 1) | bits.get(1);
+    return static_cast<int>(144 + code - 0x190);
+}
+
+// Распаковка zlib; принимаются только блоки с фиксированными кодами
+std::vector<unsigned char> inflate(const unsigned char* data, std::size_t size) {
+    static const int lengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                       31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const int lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const int distanceBase[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                         193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+
+    if (size < 6 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0) {
+        throw std::runtime_error("Invalid zlib header");
+    }
+    BitReader bits(data + 2, size - 6);
+    std::vector<unsigned char> out;
+    bool last = false;
+    while (!last) {
+        last = bits.get(1) == 1;
+        if (bits.get(2) != 1) throw std::runtime_error("Unexpected block type");
+        for (;;) {
+            int symbol = fixedSymbol(bits);
+            if (symbol < 256) {
+                out.push_back(static_cast<unsigned char>(symbol));
+                continue;
+            }
+            if (symbol == 256) break;
+            int k = symbol - 257;
+            if (k >= 29) throw std::runtime_error("Invalid length symbol");
+            std::size_t length = lengthBase[k] + bits.get(lengthExtra[k]);
+            std::uint32_t d = bits.getReversed(5);
+            if (d >= 30) throw std::runtime_error("Invalid distance symbol");
+            int extra = d < 4 ? 0 : static_cast<int>(d / 2 - 1);
+            std::size_t distance = distanceBase[d] + bits.get(extra);
+            if (distance > out.size()) throw std::runtime_error("Distance before the start");
+            for (std::size_t i = 0; i < length; ++i) out.push_back(out[out.size() - distance]);
+        }
+    }
+
+    // Adler-32 - сразу после последнего байта блоков
+    std::uint32_t a = 1, b = 0;
+    for (unsigned char byte : out) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    if (2 + bits.bytesUsed() + 4 != size || bigEndian(data + size - 4) != ((b << 16) | a)) {
+        throw std::runtime_error("Adler-32 mismatch");
+    }
+    return out;
+}
+
+// Разбор PNG, записанного writePNG: RGB, 8 бит, фильтры None/Up
+RgbImage decodePNG(const std::string& file) {
+    const auto* p = reinterpret_cast<const unsigned char*>(file.data());
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (file.size() < 8 || !std::equal(signature, signature + 8, p)) throw std::runtime_error("No PNG signature");
+
+    RgbImage image = {0, 0, {}};
+    std::vector<unsigned char> compressed;
+    std::size_t offset = 8;
+    bool ended = false;
+    while (!ended) {
+        if (offset + 12 > file.size()) throw std::runtime_error("Truncated chunk");
+        std::uint32_t length = bigEndian(p + offset);
+        std::string type(file, offset + 4, 4);
+        const unsigned char* body = p + offset + 8;
+        if (offset + 12 + length > file.size()) throw std::runtime_error("Truncated chunk");
+        if (binary_format::crc32(p + offset + 4, length + 4) != bigEndian(body + length)) {
+            throw std::runtime_error("Chunk CRC mismatch: " + type);
+        }
+        if (type == "IHDR") {
+            image.width = static_cast<int>(bigEndian(body));
+            image.height = static_cast<int>(bigEndian(body + 4));
+            if (body[8] != 8 || body[9] != 2) throw std::runtime_error("Unexpected pixel format");
+        } else if (type == "IDAT") {
+            compressed.insert(compressed.end(), body, body + length);
+        } else if (type == "IEND") {
+            ended = true;
+        }
+        offset += 12 + length;
+    }
+
+    std::vector<unsigned char> filtered = inflate(compressed.data(), compressed.size());
+    std::size_t stride = static_cast<std::size_t>(image.width) * 3;
+    if (filtered.size() != (stride + 1) * image.height) throw std::runtime_error("Unexpected image data size");
+    image.pixels.resize(stride * image.height);
+    for (int y = 0; y < image.height; ++y) {
+        const unsigned char* row = filtered.data() + y * (stride + 1);
+        unsigned char* target = image.pixels.data() + y * stride;
+        for (std::size_t i = 0; i < stride; ++i) {
+            unsigned char above = y > 0 && row[0] == 2 ? target[i - stride] : 0;
+            if (row[0] != 0 && row[0] != 2) throw std::runtime_error("Unexpected filter");
+            target[i] = static_cast<unsigned char>(row[i + 1] + above);
+        }
+    }
+    return image;
+}
+
+void checkRoundTrip(const RgbImage& image) {
+    std::ostringstream out;
+    plot_image::writePNG(out, image);
+    RgbImage decoded = decodePNG(out.str());
+    CHECK(decoded.width == image.width);
+    CHECK(decoded.height == image.height);
+    CHECK(decoded.pixels == image.pixels);
+}
+
+}
+
+int main() {
+    DiscreteRandomVariable rv({{1, 0.1}, {2, 0.2}, {4, 0.3}, {8, 0.4}});
+    for (int view = 0; view < 3; ++view) {
+        RgbImage image = plot_image::render(rv, view, 320, 240);
+        checkRoundTrip(image);
+
+        // Однотонный фон сжимается сериями
+        std::ostringstream out;
+        plot_image::writePNG(out, image);
+        CHECK(out.str().size() * 20 < image.pixels.size());
+    }
+
+    // Шум (одни литералы), серии любой длины и изображение в один пиксель
+    std::mt19937 generator(5);
+    RgbImage noise = {37, 11, std::vector<unsigned char>(37 * 11 * 3)};
+    for (auto& byte : noise.pixels) byte = static_cast<unsigned char>(generator());
+    checkRoundTrip(noise);
+
+    RgbImage runs = {1000, 3, std::vector<unsigned char>(1000 * 3 * 3, 0)};
+    for (std::size_t i = 0; i < runs.pixels.size(); i += 1 + generator() % 700) runs.pixels[i] = 255;
+    checkRoundTrip(runs);
+    checkRoundTrip({1, 1, {10, 20, 30}});
+
+    CHECK_THROWS(plot_image::render(rv, 3, 10, 10), std::invalid_argument);
+    return test_support::finish();
+}
@@ -0,0 +1,154 @@
+#include "../include/query_client.h"
+#include "../include/query_server.h"
+#include "test_support.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// QueryClient против QueryServer в том же процессе: загрузка, кеш операций,
+// ошибки, пути Load вне каталога данных, права сокета, простаивающие соединения и остановка по запросу Shutdown
+
+using query_protocol::Operation;
+
+namespace {
+
+DiscreteRandomVariable die() {
+    return DiscreteRandomVariable({{1, 1.0 / 6}, {2, 1.0 / 6}, {3, 1.0 / 6}, {4, 1.0 / 6}, {5, 1.0 / 6}, {6, 1.0 / 6}});
+}
+
+void testLoadAndQueries(const std::string& socket) {
+    QueryClient client(socket);
+    CHECK(client.load("D", "die.bin") == 6);
+    CHECK(client.get("D").atoms() == die().atoms());
+
+    DistributionMoments moments = client.moments("D");
+    CHECK_NEAR(moments.expectation, 3.5, 1e-12);
+    CHECK_NEAR(moments.variance, 35.0 / 12, 1e-12);
+
+    std::vector<double> cdf = client.cdf("D", {0.0, 3.0, 6.0});
+    CHECK(cdf.size() == 3);
+    CHECK_NEAR(cdf[0], 0.0, 1e-12);
+    CHECK_NEAR(cdf[1], 0.5, 1e-12);
+    CHECK_NEAR(cdf[2], 1.0, 1e-12);
+    CHECK(client.quantile("D", {0.5}) == std::vector<double>{3.0});
+}
+
+void testApplyCache(const std::string& socket) {
+    QueryClient first(socket);
+    QueryClient second(socket);
+    bool hit = true;
+    CHECK(first.apply(Operation::Sum, "S", "D", "D", &hit) == 11);
+    CHECK(!hit);
+    // Тот же запрос другого клиента берется из кеша
+    CHECK(second.apply(Operation::Sum, "T", "D", "D", &hit) == 11);
+    CHECK(hit);
+    CHECK(second.apply(Operation::Scale, "U", "D", 2.0, &hit) == 6);
+    CHECK(!hit);
+    CHECK(first.get("T").atoms() == (die() + die()).atoms());
+
+    query_protocol::ServerStats stats = first.stats();
+    CHECK(stats.cacheHits == 1);
+    CHECK(stats.cacheMisses == 2);
+}
+
+void testErrors(const std::string& socket) {
+    QueryClient client(socket);
+    CHECK_THROWS(client.moments("missing"), std::runtime_error);
+    CHECK_THROWS(client.load("X", "missing.bin"), std::runtime_error);
+    CHECK_THROWS(client.quantile("D", {1.5}), std::runtime_error);
+    // Ошибка запроса не закрывает соединение
+    CHECK(client.get("D").atoms().size() == 6);
+    client.drop("U");
+    CHECK_THROWS(client.drop("U"), std::runtime_error);
+}
+
+// Load читает только файлы внутри каталога данных
+void testLoadPaths(const std::string& socket, const std::string& dataPath) {
+    QueryClient client(socket);
+    CHECK_THROWS(client.load("X", dataPath), std::runtime_error);
+    CHECK_THROWS(client.load("X", ""), std::runtime_error);
+    CHECK_THROWS(client.load("X", ".."), std::runtime_error);
+    CHECK_THROWS(client.load("X", "../die.bin"), std::runtime_error);
+    CHECK_THROWS(client.load("X", "sub/../die.bin"), std::runtime_error);
+    CHECK_THROWS(client.load("X", "sub/.."), std::runtime_error);
+    CHECK(client.load("X", "./die.bin") == 6);
+    CHECK(client.load("Y", "..die.bin..") == 6);
+    client.drop("X");
+    client.drop("Y");
+}
+
+// Кадр в несколько мегабайт принимается по частям
+void testLargeMessages(const std::string& socket) {
+    std::vector<std::pair<double, double>> atoms(200000);
+    for (std::size_t i = 0; i < atoms.size(); ++i) {
+        atoms[i] = {static_cast<double>(i), 1.0 / atoms.size()};
+    }
+    DiscreteRandomVariable rv(atoms);
+    QueryClient client(socket);
+    CHECK(client.put("L", rv) == atoms.size());
+    CHECK(client.get("L").atoms() == rv.atoms());
+    client.drop("L");
+}
+
+// Соединений без запросов больше, чем потоков: новые клиенты все равно обслуживаются
+void testIdleConnections(const std::string& socket, std::size_t threads) {
+    std::vector<std::unique_ptr<QueryClient>> idle;
+    for (std::size_t i = 0; i < threads + 3; ++i) {
+        idle.push_back(std::make_unique<QueryClient>(socket));
+    }
+    QueryClient client(socket);
+    CHECK(client.moments("D").expectation == 3.5);
+    CHECK(idle.back()->stats().variables >= 1);
+}
+
+}
+
+int main() {
+    std::string base = "/tmp/ptms-query-server-test-" + std::to_string(::getpid());
+    std::string socket = base + ".sock";
+    std::string dataDirectory = base + ".data";
+    std::string dataPath = dataDirectory + "/die.bin";
+    std::string dottedPath = dataDirectory + "/..die.bin..";
+    ::mkdir(dataDirectory.c_str(), 0700);
+    for (const std::string& path : {dataPath, dottedPath}) {
+        std::ofstream file(path, std::ios::binary);
+        die().serialize(file);
+    }
+
+    const std::size_t threads = 2;
+    auto server = std::make_unique<QueryServer>(socket, threads, 1 << 20, dataDirectory);
+    struct stat status;
+    CHECK(::stat(socket.c_str(), &status) == 0 && (status.st_mode & 0777) == 0600);
+    std::thread runner([&server]() { server->run(); });
+
+    try {
+        testLoadAndQueries(socket);
+        testLoadPaths(socket, dataPath);
+        testApplyCache(socket);
+        testErrors(socket);
+        testLargeMessages(socket);
+        testIdleConnections(socket, threads);
+
+        QueryClient client(socket);
+        client.shutdown();
+    } catch (const std::exception& e) {
+        std::cerr << "unexpected exception: " << e.what() << std::endl;
+        ++test_support::failures;
+        server->stop();
+    }
+    runner.join();
+    // run() вернулся после Shutdown; уничтоженный сервер удаляет файл сокета
+    server.reset();
+    CHECK_THROWS(QueryClient client(socket), std::runtime_error);
+
+    std::remove(dataPath.c_str());
+    std::remove(dottedPath.c_str());
+    std::remove(dataDirectory.c_str());
+    return test_support::finish();
+}
@@ -0,0 +1,113 @@
+#include "../include/random_variable_batch.h"
+#include "test_support.h"
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// Пакетные ядра (группы распределений по дорожкам) против скалярных проходов
+// по одному распределению: результаты должны совпадать бит в бит
+
+namespace {
+
+DiscreteRandomVariable randomLaw(std::mt19937_64& generator, std::size_t atoms) {
+    std::uniform_real_distribution<double> value(-50.0, 50.0);
+    std::uniform_real_distribution<double> weight(0.01, 1.0);
+    std::vector<std::pair<double, double>> dist(atoms);
+    for (auto& atom : dist) {
+        atom = {value(generator), weight(generator)};
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+// Число распределений не кратно ширине группы, длины - от 1 до 60 атомов
+RandomVariableBatch randomBatch(std::size_t distributions, unsigned seed) {
+    std::mt19937_64 generator(seed);
+    std::uniform_int_distribution<std::size_t> atoms(1, 60);
+    RandomVariableBatch batch;
+    for (std::size_t i = 0; i < distributions; ++i) {
+        batch.add(randomLaw(generator, atoms(generator)));
+    }
+    return batch;
+}
+
+bool same(double a, double b) {
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+// Проход без префиксных сумм - тот же порядок сложения, что у DiscreteRandomVariable
+AtomSpan scalarSpan(const DiscreteRandomVariable& rv) {
+    return AtomSpan(rv.atoms().data(), rv.atoms().size());
+}
+
+void testStatistics(const RandomVariableBatch& batch) {
+    std::vector<DistributionMoments> moments = batch.moments();
+    std::vector<double> cdf = batch.cdf(3.25);
+    std::vector<double> points(batch.size());
+    for (std::size_t i = 0; i < points.size(); ++i) points[i] = -60.0 + 0.37 * static_cast<double>(i % 300);
+    std::vector<double> cdfAt = batch.cdf(points);
+    std::vector<double> median = batch.quantile(0.5);
+    std::vector<double> top = batch.quantile(1.0);
+    std::vector<double> bottom = batch.quantile(0.0);
+
+    CHECK(moments.size() == batch.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        DiscreteRandomVariable rv = batch.get(i);
+        AtomSpan span = scalarSpan(rv);
+        DistributionMoments expected = span.moments();
+        CHECK(same(moments[i].expectation, expected.expectation));
+        CHECK(same(moments[i].variance, expected.variance));
+        CHECK(same(moments[i].skewness, expected.skewness));
+        CHECK(same(moments[i].kurtosis, expected.kurtosis));
+        CHECK(cdf[i] == span.cdf(3.25));
+        CHECK(cdfAt[i] == span.cdf(points[i]));
+        CHECK(median[i] == span.quantile(0.5));
+        CHECK(top[i] == span.quantile(1.0));
+        CHECK(bottom[i] == span.quantile(0.0));
+    }
+}
+
+void testPairwiseSum() {
+    RandomVariableBatch a = randomBatch(301, 3);
+    RandomVariableBatch b = randomBatch(301, 4);
+    RandomVariableBatch sum = a.pairwiseSum(b);
+    CHECK(sum.size() == a.size());
+    for (std::size_t i = 0; i < sum.size(); ++i) {
+        CHECK(sum.get(i).atoms() == (a.get(i) + b.get(i)).atoms());
+    }
+    CHECK_THROWS(a.pairwiseSum(randomBatch(5, 5)), std::invalid_argument);
+}
+
+// Ошибочное распределение не остается в пакете
+void testValidation() {
+    RandomVariableBatch batch;
+    std::vector<std::pair<double, double>> unsorted = {{3.0, 2.0}, {1.0, 1.0}, {2.0, 1.0}};
+    CHECK(batch.add(AtomSpan(unsorted)) == 0);
+    CHECK(batch.get(0).atoms() == DiscreteRandomVariable({{1.0, 0.25}, {2.0, 0.25}, {3.0, 0.5}}).atoms());
+
+    std::vector<std::pair<double, double>> duplicate = {{1.0, 0.5}, {1.0, 0.5}};
+    std::vector<std::pair<double, double>> negative = {{1.0, 1.5}, {2.0, -0.5}};
+    CHECK_THROWS(batch.add(AtomSpan(duplicate)), std::invalid_argument);
+    CHECK_THROWS(batch.add(AtomSpan(negative)), std::invalid_argument);
+    CHECK_THROWS(batch.add(AtomSpan()), std::invalid_argument);
+    CHECK(batch.size() == 1);
+    CHECK(batch.totalAtoms() == 3);
+    CHECK_THROWS(batch.quantile(1.5), std::invalid_argument);
+    CHECK_THROWS(batch.cdf(std::vector<double>(2)), std::invalid_argument);
+}
+
+}
+
+int main() {
+    testStatistics(randomBatch(1, 1));
+    testStatistics(randomBatch(5003, 2)); // несколько потоков и неполная последняя группа
+
+    // Вырожденные распределения: нулевая дисперсия
+    RandomVariableBatch points;
+    for (int i = 0; i < 11; ++i) points.add(DiscreteRandomVariable({{static_cast<double>(i), 1.0}}));
+    testStatistics(points);
+
+    testPairwiseSum();
+    testValidation();
+    return test_support::finish();
+}
@@ -0,0 +1,110 @@
+#include "../include/random_variable.h"
+#include "../include/report.h"
+#include "test_support.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+
+// ptms-cli report на маленьком каталоге: разделы в порядке входных файлов,
+// разделы ошибок для нечитаемых файлов, итог в конце и код возврата.
+// Путь к ptms-cli передает ctest первым аргументом.
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+// Код возврата команды оболочки (-1, если она не завершилась сама)
+int run(const std::string& command) {
+    int status = std::system(command.c_str());
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+std::string heading(const std::string& path) {
+    return "<section><h2>" + path + "</h2>";
+}
+
+void testLibrary() {
+    std::string header = report::htmlHeader("P&L <draft>");
+    CHECK(header.find("<title>P&amp;L &lt;draft&gt;</title>") != std::string::npos);
+
+    std::string section;
+    report::appendSection(section, "a\"b", DiscreteRandomVariable({{1, 0.5}, {3, 0.5}}), 120, 90);
+    CHECK(section.rfind("<section><h2>a&quot;b</h2>", 0) == 0);
+    CHECK(section.find("<td>2</td><td>2</td><td>1</td>") != std::string::npos); // атомы, E[X], Var[X]
+    std::size_t plots = 0;
+    for (std::size_t at = section.find("<svg"); at != std::string::npos; at = section.find("<svg", at + 1)) ++plots;
+    CHECK(plots == 3);
+
+    std::string error;
+    report::appendErrorSection(error, "x", "bad <file>");
+    CHECK(error == "<section><h2>x</h2><p class=\"error\">bad &lt;file&gt;</p></section>\n");
+    CHECK(report::htmlFooter(1, 0).find("<p>1 distribution</p>") != std::string::npos);
+    CHECK(report::htmlFooter(4, 2).find("<p>4 distributions, 2 failed to load</p>") != std::string::npos);
+}
+
+void testCommand(const std::string& cli) {
+    std::string base = test_support::temporaryPath("report");
+    std::vector<std::string> paths;
+    for (int i = 0; i < 6; ++i) {
+        paths.push_back(base + "-" + std::to_string(i) + ".bin");
+        std::ofstream file(paths.back(), std::ios::binary);
+        if (i == 2 || i == 4) {
+            file << "not a distribution";
+        } else {
+            DiscreteRandomVariable({{0, 0.5}, {static_cast<double>(i + 1), 0.5}}).serialize(file);
+        }
+    }
+    std::string output = base + ".html";
+    std::string files;
+    for (const auto& path : paths) files += " " + path;
+
+    CHECK(run(cli + " report --title Catalog --output " + output + files) == 1);
+    std::string html = readFile(output);
+    CHECK(html.find("<title>Catalog</title>") != std::string::npos);
+    std::size_t previous = 0;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        std::size_t at = html.find(heading(paths[i]));
+        CHECK(at != std::string::npos && at > previous);
+        previous = at;
+        std::size_t next = html.find("</section>", at);
+        bool isError = html.compare(at + heading(paths[i]).size(), 17, "<p class=\"error\">") == 0;
+        CHECK(isError == (i == 2 || i == 4));
+        CHECK(next != std::string::npos);
+    }
+    std::size_t footer = html.find("<footer><p>6 distributions, 2 failed to load</p></footer>");
+    CHECK(footer != std::string::npos && footer > previous);
+
+    // Без ошибок - код 0 и итог без неудач
+    CHECK(run(cli + " report --output " + output + " " + paths[0] + " " + paths[1]) == 0);
+    html = readFile(output);
+    CHECK(html.find(heading(paths[0])) < html.find(heading(paths[1])));
+    CHECK(html.find("class=\"error\"") == std::string::npos);
+    CHECK(html.find("<footer><p>2 distributions</p></footer>") != std::string::npos);
+
+    // Неизвестная опция - ошибка использования
+    CHECK(run(cli + " report --bogus " + paths[0] + " 2>/dev/null") == 2);
+
+    for (const auto& path : paths) std::remove(path.c_str());
+    std::remove(output.c_str());
+}
+
+}
+
+int main(int argc, char** argv) {
+    testLibrary();
+    if (argc < 2) {
+        std::cerr << "usage: report_test path/to/ptms-cli" << std::endl;
+        return 1;
+    }
+    testCommand(argv[1]);
+    return test_support::finish();
+}
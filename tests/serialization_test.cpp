@@ -0,0 +1,109 @@
+#include "../include/random_variable.h"
+#include "test_support.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Двоичный формат: точное восстановление атомов и отказ на испорченных файлах
+
+namespace {
+
+DiscreteRandomVariable randomLaw(std::size_t atoms, unsigned seed) {
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> value(-1e6, 1e6);
+    std::uniform_real_distribution<double> weight(0.1, 1.0);
+    std::vector<std::pair<double, double>> dist(atoms);
+    for (auto& atom : dist) {
+        atom = {value(generator), weight(generator)};
+    }
+    return DiscreteRandomVariable(dist);
+}
+
+template <typename Variable>
+void save(const Variable& rv, const std::string& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    rv.serialize(file);
+}
+
+template <typename Variable = DiscreteRandomVariable>
+Variable load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    Variable rv;
+    rv.deserialize(file);
+    return rv;
+}
+
+std::string readBytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void writeBytes(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+void testRoundTrip(const DiscreteRandomVariable& rv, const std::string& path) {
+    save(rv, path);
+    CHECK(load(path).atoms() == rv.atoms());
+}
+
+// Целые значения - нагрузка версии 3 с полями int64 и float64
+void testTypedRoundTrip(const std::string& path) {
+    using IntegerVariable = BasicDiscreteRandomVariable<std::int64_t, double>;
+    IntegerVariable rv({{-3, 0.25}, {0, 0.25}, {(std::int64_t(1) << 60) + 1, 0.5}});
+    save(rv, path);
+    CHECK(load<IntegerVariable>(path).atoms() == rv.atoms());
+
+    // Целые значения без дробной части читаются и из файла float64
+    save(DiscreteRandomVariable({{1.0, 0.5}, {2.0, 0.5}}), path);
+    CHECK(load<IntegerVariable>(path).atoms() == IntegerVariable({{1, 0.5}, {2, 0.5}}).atoms());
+    save(DiscreteRandomVariable({{1.5, 0.5}, {2.0, 0.5}}), path);
+    CHECK_THROWS(load<IntegerVariable>(path), std::runtime_error);
+
+    // Неизвестный код типа вероятностей (байт 29 заголовка) отклоняется
+    save(rv, path);
+    std::string bytes = readBytes(path);
+    bytes[29] = 2;
+    writeBytes(path, bytes);
+    CHECK_THROWS(load<IntegerVariable>(path), std::runtime_error);
+}
+
+void testCorruption(const DiscreteRandomVariable& rv, const std::string& path) {
+    save(rv, path);
+    std::string bytes = readBytes(path);
+
+    // Любой измененный байт данных ловит CRC
+    for (std::size_t offset : {bytes.size() / 2, bytes.size() - 3}) {
+        std::string damaged = bytes;
+        damaged[offset] ^= 0x5A;
+        writeBytes(path, damaged);
+        CHECK_THROWS(load(path), std::runtime_error);
+    }
+
+    // Обрезанный файл и чужой заголовок
+    writeBytes(path, bytes.substr(0, bytes.size() / 2));
+    CHECK_THROWS(load(path), std::runtime_error);
+    writeBytes(path, "not a distribution file");
+    CHECK_THROWS(load(path), std::runtime_error);
+}
+
+}
+
+int main() {
+    std::string path = test_support::temporaryPath("serialization.bin");
+
+    testRoundTrip(DiscreteRandomVariable({{42.0, 1.0}}), path);
+    testRoundTrip(DiscreteRandomVariable({{-0.0, 0.1}, {1e-300, 0.2}, {1e300, 0.7}}), path);
+    testRoundTrip(randomLaw(5000, 1), path);
+    testRoundTrip(randomLaw(200000, 2), path);
+    testTypedRoundTrip(path);
+    testCorruption(randomLaw(1000, 4), path);
+
+    std::remove(path.c_str());
+    return test_support::finish();
+}
@@ -0,0 +1,164 @@
+#include "../include/random_variable.h"
+#include "../include/small_vector.h"
+#include "test_support.h"
+#include <cstddef>
+#include <memory_resource>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// Переход SmallVector из встроенного буфера в выделенную память (15/16/17
+// элементов при N = 16), копирование и перемещение через эту границу, ресурс
+// памяти у копий и операторы величин с числом атомов около kInlineAtoms
+
+namespace {
+
+const std::size_t kInline = 16;
+using Vector = SmallVector<int, kInline>;
+
+class CallCounter : public std::pmr::memory_resource {
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+};
+
+Vector sequence(std::size_t n, std::pmr::memory_resource* resource) {
+    Vector v(resource);
+    for (std::size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+    return v;
+}
+
+bool isSequence(const Vector& v, std::size_t n) {
+    if (v.size() != n) return false;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (v[i] != static_cast<int>(i)) return false;
+    }
+    return true;
+}
+
+void testBoundary() {
+    for (std::size_t n : {kInline - 1, kInline, kInline + 1}) {
+        CallCounter counter;
+        {
+            Vector v = sequence(n, &counter);
+            CHECK(isSequence(v, n));
+            CHECK(v.isInlineStorage() == (n <= kInline));
+            CHECK(counter.allocations == (n <= kInline ? 0u : 1u));
+            CHECK(v.back() == static_cast<int>(n - 1));
+
+            // Элемент самого вектора при переполнении буфера
+            v.push_back(v[0]);
+            CHECK(v.size() == n + 1 && v.back() == 0);
+            CHECK(!v.isInlineStorage() || n + 1 <= kInline);
+
+            Vector resized(&counter);
+            resized.resize(n, 7);
+            CHECK(resized.size() == n && resized[n - 1] == 7);
+            std::vector<int> source(n, 3);
+            resized.assign(source.begin(), source.end());
+            CHECK(std::accumulate(resized.begin(), resized.end(), 0) == static_cast<int>(3 * n));
+            resized.clear();
+            CHECK(resized.empty());
+        }
+        CHECK(counter.allocations == counter.deallocations);
+    }
+}
+
+// Копия - ресурс по умолчанию, копирующее присваивание - ресурс получателя,
+// перемещение - ресурс источника; перемещение между разными ресурсами копирует
+void testCopyAndMove() {
+    for (std::size_t n : {kInline - 1, kInline, kInline + 1}) {
+        CallCounter first, second;
+        {
+            Vector source = sequence(n, &first);
+            std::size_t firstAllocations = first.allocations;
+
+            Vector copy(source);
+            CHECK(isSequence(copy, n));
+            CHECK(copy.get_allocator().resource() == std::pmr::get_default_resource());
+
+            Vector withResource(source, &second);
+            CHECK(isSequence(withResource, n));
+            CHECK(withResource.get_allocator().resource() == &second);
+
+            Vector assigned = sequence(kInline + 5, &second); // в выделенной памяти
+            assigned = source;
+            CHECK(isSequence(assigned, n));
+            CHECK(assigned.get_allocator().resource() == &second);
+
+            Vector moved(std::move(source));
+            CHECK(isSequence(moved, n));
+            CHECK(source.empty());
+            CHECK(moved.get_allocator().resource() == &first);
+            CHECK(first.allocations == firstAllocations); // буфер передан, не скопирован
+            source.push_back(42); // перемещенный вектор снова пригоден
+            CHECK(source.size() == 1 && source[0] == 42);
+
+            Vector other(&second);
+            other = std::move(moved); // разные ресурсы: копия в память получателя
+            CHECK(isSequence(other, n));
+            CHECK(other.get_allocator().resource() == &second);
+
+            Vector sameResource(&first);
+            sameResource = sequence(n, &first);
+            CHECK(isSequence(sameResource, n));
+
+            Vector crossResource(sequence(n, &first), &second);
+            CHECK(isSequence(crossResource, n));
+            CHECK(crossResource.get_allocator().resource() == &second);
+        }
+        CHECK(first.allocations == first.deallocations);
+        CHECK(second.allocations == second.deallocations);
+    }
+}
+
+// Величины с числом атомов около kInlineAtoms: операторы и доступ не зависят от хранения
+void testRandomVariables() {
+    const std::size_t inlineAtoms = DiscreteRandomVariable::kInlineAtoms;
+    for (std::size_t n : {inlineAtoms - 1, inlineAtoms, inlineAtoms + 1}) {
+        std::vector<std::pair<double, double>> dist(n);
+        for (std::size_t i = 0; i < n; ++i) dist[i] = {static_cast<double>(i), 1.0 / static_cast<double>(n)};
+        DiscreteRandomVariable rv(dist);
+        AtomSpan reference(dist);
+
+        CHECK(rv.atoms() == reference);
+        CHECK(rv.expectation() == reference.expectation());
+        CHECK(rv.cdf(static_cast<double>(n) / 2) == reference.cdf(static_cast<double>(n) / 2));
+        CHECK(rv.quantile(0.5) == reference.quantile(0.5));
+        CHECK(rv.getValues().size() == n);
+        CHECK(rv.getCDF().back().second == rv.cumulativeProbabilities()[n - 1]);
+
+        DiscreteRandomVariable copy = rv;
+        DiscreteRandomVariable moved = std::move(copy);
+        CHECK(moved.atoms() == rv.atoms());
+        CHECK(moved.cdf(3.0) == rv.cdf(3.0));
+
+        // Сумма решеток: 2n - 1 атомов, по другую сторону границы
+        DiscreteRandomVariable sum = rv + rv;
+        CHECK(sum.atoms().size() == 2 * n - 1);
+        CHECK_NEAR(sum.expectation(), 2 * rv.expectation(), 1e-12);
+        DiscreteRandomVariable scaled = rv * 2.0;
+        CHECK(scaled.atoms().size() == n);
+        CHECK((rv * DiscreteRandomVariable({{1.0, 1.0}})).atoms() == rv.atoms());
+    }
+}
+
+}
+
+int main() {
+    testBoundary();
+    testCopyAndMove();
+    testRandomVariables();
+    return test_support::finish();
+}
@@ -0,0 +1,56 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// Минимальные проверки для тестов без внешних библиотек: неудачная проверка
+// печатает место и выражение, а main возвращает число неудач через finish()
+namespace test_support {
+
+inline int failures = 0;
+
+inline void fail(const char* file, int line, const char* expression) {
+    std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+    ++failures;
+}
+
+// Путь временного файла теста
+inline std::string temporaryPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("ptms-test-" + name)).string();
+}
+
+inline int finish() {
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) ::test_support::fail(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        if (!(std::abs((actual) - (expected)) <= (tolerance))) \
+            ::test_support::fail(__FILE__, __LINE__, #actual " == " #expected); \
+    } while (0)
+
+#define CHECK_THROWS(expression, Exception) \
+    do { \
+        bool thrown = false; \
+        try { \
+            expression; \
+        } catch (const Exception&) { \
+            thrown = true; \
+        } \
+        if (!thrown) ::test_support::fail(__FILE__, __LINE__, #expression " throws " #Exception); \
+    } while (0)
+
+#endif
@@ -0,0 +1,87 @@
+#include "../include/text_format.h"
+#include "test_support.h"
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Разбор и запись CSV: заголовок, комментарии, разделители, ошибки и точный
+// обратимый вывод чисел, в том числе при параллельном разборе больших буферов
+
+namespace {
+
+using Atoms = std::vector<std::pair<double, double>>;
+
+Atoms parse(const std::string& text, char delimiter = ',') {
+    return text_format::parseCSV(text.data(), text.size(), delimiter);
+}
+
+void testParsing() {
+    CHECK((parse("1,0.5\n2,0.5\n") == Atoms{{1, 0.5}, {2, 0.5}}));
+    // Заголовок, комментарии, пустые строки, пробелы и CRLF
+    CHECK((parse("value,probability\r\n# comment\n\n  -1.5 , 0.25\r\n3e2,\t0.75") ==
+           Atoms{{-1.5, 0.25}, {300, 0.75}}));
+    CHECK((parse("# only comments\n# value,probability\nvalue;p\n1;1\n", ';') == Atoms{{1, 1}}));
+    CHECK(parse("").empty());
+    CHECK(parse("value,probability\n").empty());
+}
+
+void testErrors() {
+    CHECK_THROWS(parse("1,0.5\n2;0.5\n"), std::invalid_argument);
+    CHECK_THROWS(parse("1,0.5\n2,abc\n"), std::invalid_argument);
+    CHECK_THROWS(parse("1,0.5 0.1\n"), std::invalid_argument);
+    CHECK_THROWS(parse("1\n"), std::invalid_argument);
+    // Номер строки в сообщении
+    try {
+        parse("value,probability\n1,0.5\n\nx,0.5\n");
+        CHECK(false);
+    } catch (const std::invalid_argument& e) {
+        CHECK(std::string(e.what()).find("line 4") != std::string::npos);
+    }
+}
+
+void testNumberFormatting() {
+    std::string out;
+    text_format::appendNumber(out, 0.1);
+    CHECK(out == "0.1");
+    out.clear();
+    text_format::appendNumber(out, -2.5e-300);
+    CHECK(out == "-2.5e-300");
+    out.clear();
+    text_format::appendNumber(out, 1.0 / 3.0);
+    CHECK(std::stod(out) == 1.0 / 3.0);
+}
+
+// Запись и чтение обратимы бит в бит; большой буфер разбирается по кускам
+void testRoundTrip() {
+    std::mt19937_64 generator(7);
+    std::uniform_real_distribution<double> value(-1e9, 1e9);
+    Atoms atoms(300000);
+    double total = 0.0;
+    for (std::size_t i = 0; i < atoms.size(); ++i) {
+        atoms[i] = {static_cast<double>(i) + value(generator) * 1e-10, value(generator) + 1e9 + 1.0};
+        total += atoms[i].second;
+    }
+    for (auto& atom : atoms) atom.second /= total;
+    DiscreteRandomVariable rv(atoms);
+
+    std::string text = text_format::formatCSV(rv.atoms());
+    CHECK(text.size() > (1u << 20));
+    CHECK(parse(text) == atoms);
+
+    std::string path = test_support::temporaryPath("text_format.csv");
+    text_format::writeCSV(path, rv.atoms(), ';');
+    CHECK(text_format::readCSV(path, ';').atoms() == rv.atoms());
+    std::remove(path.c_str());
+}
+
+}
+
+int main() {
+    testParsing();
+    testErrors();
+    testNumberFormatting();
+    testRoundTrip();
+    return test_support::finish();
+}
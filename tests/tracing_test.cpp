@@ -0,0 +1,119 @@
+#include "../include/tracing.h"
+#include "json_reader.h"
+#include "test_support.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Файл трассировки - корректный JSON; каждая область из нескольких потоков
+// либо записана, либо учтена в droppedEvents; новая запись после stop()
+// не содержит событий прошлой
+
+namespace {
+
+json_reader::Value readTrace(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    return json_reader::parse(text.str());
+}
+
+// Число событий с данным именем; у всех событий - поля полного события
+std::size_t countEvents(const json_reader::Value& trace, const std::string& name) {
+    std::size_t count = 0;
+    for (const auto& event : trace["traceEvents"].array) {
+        CHECK(event["ph"].string == "X");
+        CHECK(event["cat"].string == "test");
+        CHECK(event["ts"].number >= 0);
+        CHECK(event["dur"].number >= 0);
+        if (event["name"].string == name) ++count;
+    }
+    return count;
+}
+
+void testThreads() {
+    const std::string path = test_support::temporaryPath("tracing-threads.json");
+    const int kThreads = 4;
+    const int kScopes = 50000; // больше кольца потока: часть событий может быть отброшена
+    tracing::start(path);
+    CHECK(tracing::active());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < kScopes; ++i) {
+                tracing::Scope scope("work", "test");
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    tracing::stop();
+    CHECK(!tracing::active());
+    std::uint64_t dropped = tracing::droppedEvents();
+
+    json_reader::Value trace = readTrace(path);
+    std::size_t written = countEvents(trace, "work");
+    CHECK(written == trace["traceEvents"].array.size());
+    CHECK(written + dropped == static_cast<std::size_t>(kThreads) * kScopes);
+    CHECK(trace["otherData"]["droppedEvents"].number == dropped);
+    CHECK(trace["displayTimeUnit"].string == "ms");
+
+    std::set<double> threadIds;
+    for (const auto& event : trace["traceEvents"].array) threadIds.insert(event["tid"].number);
+    CHECK(threadIds.size() <= static_cast<std::size_t>(kThreads));
+    CHECK(threadIds.size() >= 1);
+    std::remove(path.c_str());
+}
+
+// Область, начатая в прошлой записи, и области между записями не попадают в новую
+void testRestart() {
+    const std::string first = test_support::temporaryPath("tracing-first.json");
+    const std::string second = test_support::temporaryPath("tracing-second.json");
+
+    tracing::start(first);
+    CHECK_THROWS(tracing::start(second), std::runtime_error);
+    auto straddling = std::make_unique<tracing::Scope>("straddling", "test");
+    for (int i = 0; i < 10; ++i) tracing::Scope scope("first", "test");
+    tracing::stop();
+    tracing::stop(); // повторная остановка ничего не делает
+
+    for (int i = 0; i < 10; ++i) tracing::Scope scope("between", "test");
+
+    tracing::start(second);
+    straddling.reset();
+    std::thread worker([]() {
+        for (int i = 0; i < 5; ++i) tracing::Scope scope("second", "test");
+    });
+    worker.join();
+    tracing::stop();
+
+    json_reader::Value firstTrace = readTrace(first);
+    CHECK(firstTrace["traceEvents"].array.size() == 10);
+    CHECK(countEvents(firstTrace, "first") == 10);
+    json_reader::Value secondTrace = readTrace(second);
+    CHECK(secondTrace["traceEvents"].array.size() == 5);
+    CHECK(countEvents(secondTrace, "second") == 5);
+    CHECK(secondTrace["otherData"]["droppedEvents"].number == 0);
+
+    std::remove(first.c_str());
+    std::remove(second.c_str());
+}
+
+void testErrors() {
+    CHECK_THROWS(tracing::start("/nonexistent-directory/trace.json"), std::runtime_error);
+    CHECK(!tracing::active());
+}
+
+}
+
+int main() {
+    testThreads();
+    testRestart();
+    testErrors();
+    return test_support::finish();
+}
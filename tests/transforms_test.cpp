@@ -0,0 +1,119 @@
+#include "../include/random_variable.h"
+#include "../include/transforms.h"
+#include "test_support.h"
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <vector>
+
+// Пакетные ядра сверяются с поточечными суммами через std::exp/std::cos/std::pow,
+// включая точки, которые ядра передают libm (переполнение, NaN, z <= 0, большие фазы)
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+bool close(double actual, double expected, double tolerance) {
+    if (std::isnan(expected)) return std::isnan(actual);
+    if (std::isinf(expected)) return actual == expected;
+    return std::abs(actual - expected) <= tolerance * std::max(1.0, std::abs(expected));
+}
+
+template <typename Term>
+double reference(const DiscreteRandomVariable& rv, Term term) {
+    double sum = 0.0;
+    for (const auto& atom : rv.atoms()) sum += term(atom.first) * atom.second;
+    return sum;
+}
+
+// Решетка 0..n-1 и величина с дробными и отрицательными значениями
+DiscreteRandomVariable lattice(int n) {
+    std::vector<std::pair<double, double>> dist;
+    for (int i = 0; i < n; ++i) dist.push_back({static_cast<double>(i), 1.0 + i % 7});
+    return DiscreteRandomVariable(dist);
+}
+
+DiscreteRandomVariable scattered() {
+    std::vector<std::pair<double, double>> dist;
+    for (int i = 0; i < 3000; ++i) dist.push_back({-20.0 + i * 0.0137, 1.0 + i % 5});
+    return DiscreteRandomVariable(dist);
+}
+
+void testPgf() {
+    DiscreteRandomVariable rv = lattice(300);
+    // 21 точка: неполный последний пакет; 0, отрицательные z и бесконечность - через pow
+    std::vector<double> points = {0.0, -0.5, -1.0, 1.0, 0.25, 0.5, 0.75, 0.9, 1.01, 1.1, 1.5,
+                                  2.0, 3.0, 1e-3, 0.999999, 1e300, kNaN, 1.2, 0.3, 0.6, 1.9};
+    for (unsigned order : {0u, 1u, 3u}) {
+        std::vector<double> values = transforms::pgfDerivative(rv.atoms(), points, order);
+        CHECK(values.size() == points.size());
+        for (std::size_t j = 0; j < points.size(); ++j) {
+            double z = points[j];
+            double expected = reference(rv, [&](double x) {
+                double factor = 1.0;
+                for (unsigned i = 0; i < order; ++i) factor *= x - i;
+                return factor == 0.0 ? 0.0 : factor * std::pow(z, x - order);
+            });
+            CHECK(close(values[j], expected, 1e-14));
+        }
+    }
+    CHECK(transforms::pgf(rv.atoms(), {1.0})[0] == reference(rv, [](double) { return 1.0; }));
+}
+
+void testMgf() {
+    DiscreteRandomVariable rv = scattered();
+    std::vector<double> points = {0.0, 1e-9, -0.3, 0.7, 1.0, -1.0, 2.5, -5.0, 10.0, 30.0, 40.0, kNaN, -40.0};
+    for (unsigned order : {0u, 2u}) {
+        std::vector<double> values = transforms::mgfDerivative(rv.atoms(), points, order);
+        for (std::size_t j = 0; j < points.size(); ++j) {
+            double t = points[j];
+            double expected = reference(rv, [&](double x) { return std::pow(x, order) * std::exp(t * x); });
+            CHECK(close(values[j], expected, 1e-14));
+        }
+    }
+    // Моменты при t = 0
+    CHECK_NEAR(transforms::mgfDerivative(rv.atoms(), {0.0}, 1)[0], rv.expectation(), 1e-12);
+}
+
+void testCharacteristicFunction() {
+    DiscreteRandomVariable rv = scattered();
+    // Фазы t x выше 1e5 (t = 1e4) ядро передает std::cos/std::sin
+    std::vector<double> points = {0.0, 0.1, -0.1, 1.0, 3.14159, 10.0, -77.7, 1000.0, 1e4, kNaN};
+    for (unsigned order : {0u, 1u, 2u}) {
+        std::vector<std::complex<double>> values = transforms::characteristicFunctionDerivative(rv.atoms(), points, order);
+        for (std::size_t j = 0; j < points.size(); ++j) {
+            double t = points[j];
+            std::complex<double> i(0.0, 1.0);
+            double re = reference(rv, [&](double x) { return std::pow(x, order) * std::cos(t * x); });
+            double im = reference(rv, [&](double x) { return std::pow(x, order) * std::sin(t * x); });
+            std::complex<double> expected = std::pow(i, static_cast<int>(order)) * std::complex<double>(re, im);
+            // Сумма знакопеременная: допуск от суммы модулей слагаемых
+            double scale = reference(rv, [&](double x) { return std::pow(std::abs(x), order); });
+            CHECK(close(values[j].real() / scale, expected.real() / scale, 1e-14));
+            CHECK(close(values[j].imag() / scale, expected.imag() / scale, 1e-14));
+        }
+    }
+    std::complex<double> atZero = transforms::characteristicFunction(rv.atoms(), {0.0})[0];
+    CHECK(atZero == std::complex<double>(reference(rv, [](double) { return 1.0; }), 0.0));
+}
+
+// Большая сетка делится между потоками; результат совпадает с последовательным
+void testParallelGrid() {
+    DiscreteRandomVariable rv = scattered();
+    std::vector<double> points;
+    for (int j = 0; j < 1001; ++j) points.push_back(-1.0 + j * 0.002);
+    std::vector<double> values = transforms::mgf(rv.atoms(), points);
+    for (std::size_t j = 0; j < points.size(); j += 97) {
+        CHECK(values[j] == transforms::mgf(rv.atoms(), {points[j]})[0]);
+    }
+}
+
+}
+
+int main() {
+    testPgf();
+    testMgf();
+    testCharacteristicFunction();
+    testParallelGrid();
+    return test_support::finish();
+}